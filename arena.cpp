@@ -0,0 +1,100 @@
+﻿#include "arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+
+// ======= Public ==========
+MonotonicArena::MonotonicArena(TelemetryMemory subsystem, size_t initialBytes)
+	: _subsystem(subsystem)
+{
+	_capacity = std::max<size_t>(initialBytes, 256);
+	_block = AllocateBlock(_capacity);
+}
+
+MonotonicArena::~MonotonicArena()
+{
+	Reset();
+	FreeBlock(_block, _capacity);
+}
+
+void* MonotonicArena::Allocate(size_t bytes, size_t alignment)
+{
+	// Fast path: bump inside the main block
+	// 速い道：メインブロックの中でポインタを進める
+	uintptr_t base = reinterpret_cast<uintptr_t>(_block);
+	size_t aligned = ((base + _offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1)) - base;
+	if (_overflow == nullptr && aligned + bytes <= _capacity)
+	{
+		_offset = aligned + bytes;
+		return _block + aligned;
+	}
+
+	// Spill: bump inside the newest overflow block, or start one at least as big as the main block
+	// 溢れ：一番新しい溢れブロックで進める、なければメインブロック以上の大きさで作る
+	uintptr_t cursor = (reinterpret_cast<uintptr_t>(_overflowCursor) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	if (_overflow == nullptr || cursor + bytes > reinterpret_cast<uintptr_t>(_overflowEnd))
+	{
+		size_t size = std::max(_capacity, sizeof(OverflowBlock) + bytes + alignment);
+		OverflowBlock* block = reinterpret_cast<OverflowBlock*>(AllocateBlock(size));
+		block->next = _overflow;
+		block->size = size;
+		_overflow = block;
+		_overflowEnd = reinterpret_cast<char*>(block) + size;
+		cursor = (reinterpret_cast<uintptr_t>(block + 1) + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	}
+	_overflowCursor = reinterpret_cast<char*>(cursor + bytes);
+	_overflowBytes += bytes + alignment;
+	return reinterpret_cast<void*>(cursor);
+}
+
+void MonotonicArena::Reset(void)
+{
+	if (_overflow != nullptr)
+	{
+		// The last round didn't fit, give the main block room for all of it so this only happens once
+		// 前のラウンドが入らなかった、次から入るようにメインブロックを大きくする
+		size_t highWater = GetUsedBytes();
+		while (_overflow != nullptr)
+		{
+			OverflowBlock* next = _overflow->next;
+			FreeBlock(reinterpret_cast<char*>(_overflow), _overflow->size);
+			_overflow = next;
+		}
+		FreeBlock(_block, _capacity);
+		_capacity = highWater + highWater / 4;
+		_block = AllocateBlock(_capacity);
+
+		_overflowCursor = nullptr;
+		_overflowEnd = nullptr;
+		_overflowBytes = 0;
+	}
+	_offset = 0;
+}
+
+size_t MonotonicArena::GetUsedBytes(void) const
+{
+	return _offset + _overflowBytes;
+}
+
+size_t MonotonicArena::GetCapacity(void) const
+{
+	return _capacity;
+}
+// =======================================
+
+
+// ====== Private ======
+char* MonotonicArena::AllocateBlock(size_t bytes)
+{
+	char* block = static_cast<char*>(::operator new(bytes));
+	Telemetry::GetInstance().RecordAllocation(_subsystem, bytes);
+	return block;
+}
+
+void MonotonicArena::FreeBlock(char* block, size_t bytes)
+{
+	Telemetry::GetInstance().RecordFree(_subsystem, bytes);
+	::operator delete(block);
+}
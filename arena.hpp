@@ -0,0 +1,114 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "telemetry.hpp"
+
+/*
+	Monotonic (bump) arena
+	Allocate moves a pointer forward, nothing is freed on its own and Reset rewinds the pointer in O(1).
+	Maze keeps one per query (FindPath scratch) and Canvas one per frame (render temporaries), so once
+	the first round has sized the block, later queries and frames never touch the heap.
+	A round that doesn't fit spills into extra blocks, the next Reset frees them and grows the main block
+	to the high-water mark, blocks are counted under the arena's Telemetry subsystem
+	モノトニック（バンプ）アリーナ
+	Allocateはポインタを進めるだけ、Resetでポインタを戻す（O(1)）。最初のラウンドでブロックの大きさが決まったら
+	その後のクエリとフレームはヒープを使わない。入らなかったラウンドは追加ブロックに溢れて、次のResetでまとめる
+*/
+
+class MonotonicArena
+{
+public:
+	explicit MonotonicArena(TelemetryMemory subsystem, size_t initialBytes = 64 * 1024);
+	~MonotonicArena(void);
+
+	MonotonicArena(const MonotonicArena&) = delete;
+	MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+	// alignment must be a power of two, never returns nullptr
+	// alignmentは２のべき乗、nullptrは返さない
+	void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+	// Uninitialized storage for count T, only for trivially destructible T (nothing is destroyed)
+	// T count個分の初期化されていない領域、デストラクタは呼ばない
+	template <typename T>
+	T* AllocateArray(size_t count)
+	{
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+	}
+
+	// Everything handed out since the last Reset becomes invalid
+	// 前のResetから渡した全ての領域が無効になる
+	void Reset(void);
+
+	// Bytes the current round has used across every block, what the next Reset grows the main block to
+	// 今のラウンドが全てのブロックで使ったバイト、次のResetでメインブロックをこれに合わせる
+	size_t GetUsedBytes(void) const;
+	size_t GetCapacity(void) const;
+
+private:
+	typedef struct OverflowBlock
+	{
+		OverflowBlock* next;
+		size_t size;
+	};
+
+	char* AllocateBlock(size_t bytes);
+	void FreeBlock(char* block, size_t bytes);
+
+	TelemetryMemory _subsystem;
+
+	char* _block = nullptr;
+	size_t _capacity = 0;
+	size_t _offset = 0;
+
+	// Spill blocks of the current round, the header sits at the front of each block
+	// 今のラウンドの溢れブロック、ヘッダーはブロックの先頭
+	OverflowBlock* _overflow = nullptr;
+	char* _overflowCursor = nullptr;
+	char* _overflowEnd = nullptr;
+	size_t _overflowBytes = 0;
+};
+
+// std::allocator over a MonotonicArena, deallocate does nothing (the arena's Reset frees everything)
+// A vector that grows leaves its old buffers behind until the Reset, reserve up front where possible
+// MonotonicArenaのstd::allocator、deallocateは何もしない（Resetでまとめて解放）
+template <typename T>
+class ArenaAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = ArenaAllocator<U>;
+	};
+
+	explicit ArenaAllocator(MonotonicArena& arena) noexcept
+		: _arena(&arena)
+	{}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+		: _arena(other.GetArena())
+	{}
+
+	T* allocate(size_t count)
+	{
+		return _arena->AllocateArray<T>(count);
+	}
+
+	void deallocate(T*, size_t) noexcept {}
+
+	MonotonicArena* GetArena(void) const noexcept { return _arena; }
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U>& other) const noexcept { return _arena == other.GetArena(); }
+
+private:
+	MonotonicArena* _arena;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
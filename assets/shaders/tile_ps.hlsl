@@ -1,17 +1,17 @@
-struct PSInput
-{
-    float4 position : SV_Position;
-    float3 color : COLOR0;
-};
-
-struct PSOutput
-{
-    float4 color : SV_Target0;
-};
-
-PSOutput main(PSInput input)
-{
-    PSOutput output = (PSOutput) 0;
-    output.color = float4(input.color, 1.0);
-    return output;
+struct PSInput
+{
+    float4 position : SV_Position;
+    float3 color : COLOR0;
+};
+
+struct PSOutput
+{
+    float4 color : SV_Target0;
+};
+
+PSOutput main(PSInput input)
+{
+    PSOutput output = (PSOutput) 0;
+    output.color = float4(input.color, 1.0);
+    return output;
 }
\ No newline at end of file
@@ -1,19 +1,19 @@
-struct VSInput
-{
-    float3 position : POSITION;
-    float3 color : COLOR0;
-};
-
-struct VSOutput
-{
-    float4 position : SV_Position;
-    float3 color : COLOR0;
-};
-
-VSOutput main(VSInput input)
-{
-    VSOutput output = (VSOutput) 0;
-    output.position = float4(input.position, 1.0);
-    output.color = input.color;
-    return output;
+struct VSInput
+{
+    float3 position : POSITION;
+    float3 color : COLOR0;
+};
+
+struct VSOutput
+{
+    float4 position : SV_Position;
+    float3 color : COLOR0;
+};
+
+VSOutput main(VSInput input)
+{
+    VSOutput output = (VSOutput) 0;
+    output.position = float4(input.position, 1.0);
+    output.color = input.color;
+    return output;
 }
\ No newline at end of file
@@ -1,274 +1,818 @@
-﻿#include "canvas.hpp"
-#include "errorchecker.hpp"
-#include "maze.hpp"
-#include "tile.hpp"
-
-// = DirectX =
-#include <d3dcompiler.h>
-// ===============
-
-// = SDL =
-#include <SDL_config_windows.h>
-#include <SDL_syswm.h>
-// ============
-
-#include <iostream>
-#include <vector>
-#include <cassert>
-
-// ========== Public ==========
-Canvas::Canvas(std::string& title, int scrnW, int scrnH, bool* isRunning)
-{
-	ErrorChecker errChecker = {};
-	
-	// = Special SDL check =
-	// = 特別なSDL確認 =
-	if (!errChecker.CheckSDLInitResult(SDL_Init(SDL_INIT_EVERYTHING))) return;
-
-	_title = title;
-	_isRunning = isRunning;
-	_scrnW = scrnW;
-	_scrnH = scrnH;
-
-	// ====== SDL ======
-
-	// SDL window (画面）context
-	if (!errChecker.CheckSDLResult(_window = SDL_CreateWindow(
-		_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-		scrnW, scrnH, NULL), 
-		ErrorCheckSDLWindow)) return;
-	// ===========================
-
-	// ====== D3D11 ======
-
-	// Init DirectX device and swap chain
-	// DirectX COM Object device と swap chain を イニシャライズ
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&_dxgiFactory)), ErrorCheckFactory1)) return;
-
-	constexpr D3D_FEATURE_LEVEL d3dFeatureLevel = D3D_FEATURE_LEVEL::D3D_FEATURE_LEVEL_11_0;
-	HRESULT HR_d3dFeatureLevel = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, 
-		0, &d3dFeatureLevel, 1, D3D11_SDK_VERSION, &_device, nullptr, &_deviceContext);
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(HR_d3dFeatureLevel, ErrorCheckDeviceAndDeviceContext)) return;
-
-	D3D11_RASTERIZER_DESC rastDescSolid = {};
-	rastDescSolid.FillMode = D3D11_FILL_SOLID;
-	rastDescSolid.CullMode = D3D11_CULL_NONE;
-	rastDescSolid.FrontCounterClockwise = FALSE;
-	rastDescSolid.DepthClipEnable = TRUE;
-	rastDescSolid.ScissorEnable = FALSE;
-	rastDescSolid.MultisampleEnable = FALSE;
-	rastDescSolid.AntialiasedLineEnable = FALSE;
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRasterizerState(&rastDescSolid, &_rasterizerStateSolid), ErrorCheckRasterizerState)) return;
-
-	D3D11_RASTERIZER_DESC rastDescWired = {};
-	rastDescWired.FillMode = D3D11_FILL_WIREFRAME;
-	rastDescWired.CullMode = D3D11_CULL_NONE;
-	rastDescWired.FrontCounterClockwise = FALSE;
-	rastDescWired.DepthClipEnable = TRUE;
-	rastDescWired.ScissorEnable = FALSE;
-	rastDescWired.MultisampleEnable = FALSE;
-	rastDescWired.AntialiasedLineEnable = FALSE;
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRasterizerState(&rastDescWired, &_rasterizerStateWireframe), ErrorCheckRasterizerState)) return;
-
-	_rasterizerState = _rasterizerStateSolid;
-
-	DXGI_SWAP_CHAIN_DESC1 scDesc = {};
-	scDesc.Width = scrnW;
-	scDesc.Height = scrnH;
-	scDesc.Format = DXGI_FORMAT::DXGI_FORMAT_B8G8R8A8_UNORM;
-	scDesc.SampleDesc.Count = 1;
-	scDesc.SampleDesc.Quality = 0;
-	scDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	scDesc.BufferCount = 2;
-	scDesc.SwapEffect = DXGI_SWAP_EFFECT::DXGI_SWAP_EFFECT_FLIP_DISCARD;
-	scDesc.Scaling = DXGI_SCALING::DXGI_SCALING_STRETCH;
-	scDesc.Flags = {};
-	DXGI_SWAP_CHAIN_FULLSCREEN_DESC scFullscrnDesc = {};
-	scFullscrnDesc.Windowed = true;
-
-	// Gets the HWND from SDL
-	// SDL から HWND タイプを取得する
-	SDL_SysWMinfo info;
-	SDL_VERSION(&info.version);
-	SDL_GetWindowWMInfo(_window, &info);
-	SDL_assert(info.subsystem == SDL_SYSWM_WINDOWS);
-	assert(IsWindow(info.info.win.window));
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_dxgiFactory->CreateSwapChainForHwnd(_device.Get(), info.info.win.window,
-		&scDesc, nullptr, nullptr, &_swapChain), ErrorCheckSwapChain)) return;
-	
-	CreateSwapChainResources();
-
-	// == Generate Maze ==
-	// == メイズを生じる ==
-	_isWaitingForMaze = true;
-	GenerateNewMazeSet();
-	//====================
-
-	std::cout << "\n\nCanvas Initialization SUCCESS\n\n";
-}
-
-Canvas::~Canvas() 
-{
-	_deviceContext->Flush();
-	DestroySwapChainResources();
-	_dxgiFactory.Reset();
-	_swapChain.Reset();
-	_deviceContext.Reset();
-	_device.Reset();
-	*_isRunning = false;
-}
-
-void Canvas::Loop(void) 
-{
-	ProcessInput();
-	UpdateVariables();
-	RenderGraphics();
-}
-
-ID3D11Device* Canvas::GetDevice(void)
-{
-	return _device.Get();
-}
-
-ID3D11DeviceContext* Canvas::GetDeviceContext(void)
-{
-	return _deviceContext.Get();
-}
-
-int Canvas::GetScreenWidth(void) const 
-{
-	return _scrnW;
-}
-
-int Canvas::GetScreenHeight(void) const 
-{
-	return _scrnH;
-}
-
-// ==================================================
-
-
-// ========== Private ==========
-void Canvas::GenerateNewMazeSet(void) 
-{
-	if (!_isWaitingForMaze) 
-	{
-		std::cout << "Illegal call of Maze generation, aborting Maze generation\n";
-		return;
-	}
-	Maze& maze = Maze::GetInstance();
-	maze.InitMaze(20, 20, _scrnW, _scrnH);
-	maze.GenerateMaze(this);
-	std::cout << "Maze created with " << maze.GetMaze()->size() << " cells\n";
-	maze.FindPath(0, 0, 400, 400);
-	maze.GeneratePath(this);
-	_isWaitingForMaze = false;
-}
-
-void Canvas::ProcessInput(void) 
-{
-	SDL_Event event;
-
-	while (SDL_PollEvent(&event)) 
-	{
-		switch (event.type)
-		{
-			case SDL_QUIT:
-			{
-				*_isRunning = false;
-			}break;
-
-			case SDL_KEYDOWN:
-			{
-				if (event.key.keysym.sym == SDLK_ESCAPE)
-				{
-					*_isRunning = false;
-				}
-				if (event.key.keysym.sym == SDLK_1)
-				{
-					_rasterizerState = (_rasterizerState == _rasterizerStateSolid) ?
-						_rasterizerStateWireframe : _rasterizerStateSolid;
-				}
-			}break;
-		}
-	}
-
-	// Handle maze regeneration using key states instead of events
-	const Uint8* keyState = SDL_GetKeyboardState(NULL);
-	if (keyState[SDL_SCANCODE_F] && !_isWaitingForMaze) 
-	{
-		_isWaitingForMaze = true;
-
-		// Force a render frame - Clear screen
-		// １つレンダリングフレームを強いる - 画面をクリア
-		constexpr float clearColor[] = { 0.5f, 0.5f, 0.5f, 1.0f };
-		_deviceContext->ClearRenderTargetView(_renderTarget.Get(), clearColor);
-		_swapChain->Present(1, 0);
-
-		GenerateNewMazeSet();
-	}
-}
-
-void Canvas::UpdateVariables(void) 
-{
-	// No code
-}
-
-void Canvas::RenderGraphics(void) 
-{
-	if (*_isRunning) 
-	{
-		D3D11_VIEWPORT viewport = {};
-		viewport.TopLeftX = 0;
-		viewport.TopLeftY = 0;
-		viewport.Width = static_cast<float>(_scrnW);
-		viewport.Height = static_cast<float>(_scrnH);
-		viewport.MinDepth = 0.0f;
-		viewport.MaxDepth = 1.0f;
-
-		// Device Context
-		// Sets all relevant COM Objects
-		// 関連する全てのCOM Objectを設定する
-		constexpr float clearColor[] = { 0.5f, 0.5f, 0.5f, 1.0f };
-
-		_deviceContext->ClearRenderTargetView(_renderTarget.Get(), clearColor);
-		_deviceContext->RSSetState(_rasterizerState.Get());
-		_deviceContext->RSSetViewports(1, &viewport);
-		_deviceContext->OMSetRenderTargets(1, _renderTarget.GetAddressOf(), nullptr);
-
-		// Get Maze instance and its tiles
-		// メイズのタイルごと
-		Maze& maze = Maze::GetInstance();
-		if (maze.GetIsDrawn()) 
-		{
-			std::vector<Tile>& tiles = maze.GetTiles();
-			for (auto& tile : tiles)
-			{
-				tile.Render(this);
-			}
-		}
-
-		// Present the swap chain
-		// 表示
-		_swapChain->Present(1, 0);
-	}
-}
-
-// = DirectX =
-bool Canvas::CreateSwapChainResources(void) 
-{
-	ErrorChecker errChecker = {};
-
-	ComPtr<ID3D11Texture2D> backBuffer = nullptr;
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)), ErrorCheckBackBuffer)) return false;
-	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRenderTargetView(backBuffer.Get(), nullptr, &_renderTarget),
-		ErrorCheckRenderTargetView)) return false;
-
-	return true;
-}
-
-void Canvas::DestroySwapChainResources(void) 
-{
-	_renderTarget.Reset();
-}
+﻿#include "canvas.hpp"
+#include "errorchecker.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+
+// = DirectX =
+#include <d3dcompiler.h>
+// ===============
+
+// = SDL =
+#include <SDL_config_windows.h>
+#include <SDL_syswm.h>
+// ============
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+// Window titles are formatted into the frame arena
+// ウィンドウのタイトルはフレームのアリーナに書く
+static constexpr size_t kTitleLength = 256;
+
+// Arrow keys pan by screen pixels, Page Up / Down and the wheel zoom
+// 矢印キーは画面のピクセルでパン、Page Up / Downとホイールでズーム
+static constexpr float kPanPixelsPerSecond = 600.0f;
+static constexpr float kZoomPerSecond = 4.0f;
+static constexpr float kZoomPerWheelStep = 1.25f;
+
+// The sliced-generation overlay catches up with the newly generated rows every this many slices
+// スライス生成のオーバーレイはこのスライス数ごとに新しく作られた行に追いつく
+static constexpr int kSlicedPyramidSlices = 16;
+
+// ========== Public ==========
+Canvas::Canvas(std::string& title, int scrnW, int scrnH, bool* isRunning, int mazeCells)
+{
+	ErrorChecker errChecker = {};
+	
+	// = Special SDL check =
+	// = 特別なSDL確認 =
+	if (!errChecker.CheckSDLInitResult(SDL_Init(SDL_INIT_EVERYTHING))) return;
+
+	_title = title;
+	_isRunning = isRunning;
+	_scrnW = scrnW;
+	_scrnH = scrnH;
+	_mazeCells = std::max(mazeCells, 2);
+	_camera.SetScreenSize(scrnW, scrnH);
+	_previousCamera = _camera;
+
+	// ====== SDL ======
+
+	// SDL window (画面）context
+	if (!errChecker.CheckSDLResult(_window = SDL_CreateWindow(
+		_title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+		scrnW, scrnH, NULL), 
+		ErrorCheckSDLWindow)) return;
+	// ===========================
+
+	// ====== D3D11 ======
+
+	// Init DirectX device and swap chain
+	// DirectX COM Object device と swap chain を イニシャライズ
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(CreateDXGIFactory1(IID_PPV_ARGS(&_dxgiFactory)), ErrorCheckFactory1)) return;
+
+	constexpr D3D_FEATURE_LEVEL d3dFeatureLevel = D3D_FEATURE_LEVEL::D3D_FEATURE_LEVEL_11_0;
+	HRESULT HR_d3dFeatureLevel = D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE::D3D_DRIVER_TYPE_HARDWARE, nullptr, 
+		0, &d3dFeatureLevel, 1, D3D11_SDK_VERSION, &_device, nullptr, &_deviceContext);
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(HR_d3dFeatureLevel, ErrorCheckDeviceAndDeviceContext)) return;
+
+	D3D11_RASTERIZER_DESC rastDescSolid = {};
+	rastDescSolid.FillMode = D3D11_FILL_SOLID;
+	rastDescSolid.CullMode = D3D11_CULL_NONE;
+	rastDescSolid.FrontCounterClockwise = FALSE;
+	rastDescSolid.DepthClipEnable = TRUE;
+	rastDescSolid.ScissorEnable = FALSE;
+	rastDescSolid.MultisampleEnable = FALSE;
+	rastDescSolid.AntialiasedLineEnable = FALSE;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRasterizerState(&rastDescSolid, &_rasterizerStateSolid), ErrorCheckRasterizerState)) return;
+
+	D3D11_RASTERIZER_DESC rastDescWired = {};
+	rastDescWired.FillMode = D3D11_FILL_WIREFRAME;
+	rastDescWired.CullMode = D3D11_CULL_NONE;
+	rastDescWired.FrontCounterClockwise = FALSE;
+	rastDescWired.DepthClipEnable = TRUE;
+	rastDescWired.ScissorEnable = FALSE;
+	rastDescWired.MultisampleEnable = FALSE;
+	rastDescWired.AntialiasedLineEnable = FALSE;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRasterizerState(&rastDescWired, &_rasterizerStateWireframe), ErrorCheckRasterizerState)) return;
+
+	_rasterizerState = _rasterizerStateSolid;
+
+	DXGI_SWAP_CHAIN_DESC1 scDesc = {};
+	scDesc.Width = scrnW;
+	scDesc.Height = scrnH;
+	scDesc.Format = DXGI_FORMAT::DXGI_FORMAT_B8G8R8A8_UNORM;
+	scDesc.SampleDesc.Count = 1;
+	scDesc.SampleDesc.Quality = 0;
+	scDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+	scDesc.BufferCount = 2;
+	scDesc.SwapEffect = DXGI_SWAP_EFFECT::DXGI_SWAP_EFFECT_FLIP_DISCARD;
+	scDesc.Scaling = DXGI_SCALING::DXGI_SCALING_STRETCH;
+	scDesc.Flags = {};
+	DXGI_SWAP_CHAIN_FULLSCREEN_DESC scFullscrnDesc = {};
+	scFullscrnDesc.Windowed = true;
+
+	// Gets the HWND from SDL
+	// SDL から HWND タイプを取得する
+	SDL_SysWMinfo info;
+	SDL_VERSION(&info.version);
+	SDL_GetWindowWMInfo(_window, &info);
+	SDL_assert(info.subsystem == SDL_SYSWM_WINDOWS);
+	assert(IsWindow(info.info.win.window));
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_dxgiFactory->CreateSwapChainForHwnd(_device.Get(), info.info.win.window,
+		&scDesc, nullptr, nullptr, &_swapChain), ErrorCheckSwapChain)) return;
+	
+	CreateSwapChainResources();
+	if (!_tileBatch.Initialize(this)) return;
+
+	// == Generate Maze ==
+	// == メイズを生じる ==
+	_isWaitingForMaze = false;
+	RequestNewMazeSet();
+	//====================
+
+	// == Frame loop ==
+	// == フレームループ ==
+	_frameLoop.SetUpdate([this](double stepSeconds) { UpdateFrame(stepSeconds); });
+	_frameLoop.SetRender([this](double alpha) { RenderFrame(alpha); });
+	_frameLoop.SetPresent([this](bool isVsync) { PresentGraphics(isVsync); });
+	//====================
+
+	std::cout << "\n\nCanvas Initialization SUCCESS\n\n";
+}
+
+Canvas::~Canvas() 
+{
+	// The maze job still uses the device while building tiles
+	// メイズのジョブがまだデバイスを使っているかもしれない
+	_jobs.Wait(_mazeJob);
+
+	_deviceContext->Flush();
+	DestroySwapChainResources();
+	_dxgiFactory.Reset();
+	_swapChain.Reset();
+	_deviceContext.Reset();
+	_device.Reset();
+	*_isRunning = false;
+}
+
+void Canvas::Loop(void) 
+{
+	// Last pass's temporaries are dead by now
+	// 前の一時データはもう使わない
+	_frameArena.Reset();
+
+	// As many fixed updates as the elapsed time holds, then a render if one is due
+	// 経過時間に入るだけ固定の更新をして、描画の時間なら描画する
+	_frameLoop.Step(Profiler::Now());
+
+	// Nothing due for a while (capped render rate without vsync), give the core back instead of spinning
+	// Sleeps are only about a millisecond accurate, so wake up one early
+	// しばらく何もない時はスピンせずに寝る、スリープの精度は１ミリ秒くらいなので１ミリ秒早く起きる
+	int64_t idleNs = _frameLoop.GetIdleNs(Profiler::Now());
+	if (idleNs > 2000000) std::this_thread::sleep_for(std::chrono::nanoseconds(idleNs - 1000000));
+}
+
+ID3D11Device* Canvas::GetDevice(void)
+{
+	return _device.Get();
+}
+
+ID3D11DeviceContext* Canvas::GetDeviceContext(void)
+{
+	return _deviceContext.Get();
+}
+
+int Canvas::GetScreenWidth(void) const 
+{
+	return _scrnW;
+}
+
+int Canvas::GetScreenHeight(void) const 
+{
+	return _scrnH;
+}
+
+void Canvas::SetFrameLoopConfig(const FrameLoopConfig& config, bool isUncapped)
+{
+	_frameLoop.SetConfig(config);
+	_frameLoop.SetIsUncapped(isUncapped);
+	std::cout << "Frame loop: " << config.updateHz << " updates/s, render ";
+	if (isUncapped) std::cout << "uncapped (benchmark)\n";
+	else if (config.renderHz > 0.0) std::cout << config.renderHz << " frames/s" << (config.isVsync ? " with vsync\n" : "\n");
+	else std::cout << (config.isVsync ? "at the display rate\n" : "every pass without vsync\n");
+}
+
+const FrameLoop& Canvas::GetFrameLoop(void) const
+{
+	return _frameLoop;
+}
+
+double Canvas::GetUpdateRate(void) const
+{
+	return _frameLoop.GetUpdateRate();
+}
+
+double Canvas::GetRenderRate(void) const
+{
+	return _frameLoop.GetRenderRate();
+}
+
+void Canvas::StartRecording(const std::string& filename, unsigned int seed)
+{
+	SessionHeader header;
+	header.seed = seed;
+	header.screenWidth = _scrnW;
+	header.screenHeight = _scrnH;
+	header.simulationAgents = _simulationAgents;
+	header.sliceBudgetMicroseconds = _sliceBudgetMicroseconds;
+	header.mazeCells = _mazeCells;
+
+	_session.Clear();
+	_session.SetHeader(header);
+	_sessionFile = filename;
+	_sessionMode = SessionModeRecord;
+	_sessionStart = std::chrono::steady_clock::now();
+	_frameIndex = 0;
+	std::cout << "Session: recording to " << filename << " (seed " << seed << ")\n";
+}
+
+void Canvas::StartReplay(const SessionLog& session)
+{
+	const SessionHeader& header = session.GetHeader();
+	if (header.screenWidth != _scrnW || header.screenHeight != _scrnH)
+	{
+		std::cerr << "Session: recorded at " << header.screenWidth << "x" << header.screenHeight
+			<< ", replaying at " << _scrnW << "x" << _scrnH << ", results may differ\n";
+	}
+	if (header.mazeCells != _mazeCells)
+	{
+		std::cerr << "Session: recorded with " << header.mazeCells << " maze cells, replaying with " << _mazeCells << ", results may differ\n";
+	}
+	_simulationAgents = header.simulationAgents;
+	_sliceBudgetMicroseconds = header.sliceBudgetMicroseconds;
+
+	_session = session;
+	_session.Rewind();
+	_sessionMode = SessionModeReplay;
+	_sessionStart = std::chrono::steady_clock::now();
+	_frameIndex = 0;
+	std::cout << "Session: replaying " << _session.GetEvents().size() << " events (seed " << header.seed << ")\n";
+}
+
+void Canvas::EndSession(void)
+{
+	uint64_t digest = ComputeSessionDigest();
+	if (_sessionMode == SessionModeRecord)
+	{
+		_session.SetDigest(digest);
+		if (_session.Save(_sessionFile))
+		{
+			std::cout << "Session: recorded " << _frameIndex << " frames, " << _session.GetEvents().size() << " events ("
+				<< _session.GetEncodedBytes() << " bytes) to " << _sessionFile << ", digest " << std::hex << digest << std::dec << "\n";
+		}
+	}
+	else if (_sessionMode == SessionModeReplay)
+	{
+		if (!_session.IsFinished())
+		{
+			std::cout << "Session: replay stopped at frame " << _frameIndex << " before the end of the recording\n";
+		}
+		else if (digest == _session.GetDigest())
+		{
+			std::cout << "Session: replay matches the recording after " << _frameIndex << " frames, digest " << std::hex << digest << std::dec << "\n";
+		}
+		else
+		{
+			std::cout << "Session: REPLAY MISMATCH after " << _frameIndex << " frames, digest " << std::hex << digest
+				<< ", recorded " << _session.GetDigest() << std::dec << "\n";
+		}
+	}
+	_sessionMode = SessionModeLive;
+}
+
+// ==================================================
+
+
+// ========== Private ==========
+void Canvas::RequestNewMazeSet(void) 
+{
+	if (_isWaitingForMaze) 
+	{
+		std::cout << "Illegal call of Maze generation, aborting Maze generation\n";
+		return;
+	}
+	_isWaitingForMaze = true;
+	_isMazeReady = false;
+
+	// MSVC keeps rand() state per thread, so hand the job its own seed
+	// MSVCのrand()はスレッドごとなので、ジョブにシードを渡す
+	unsigned int seed = static_cast<unsigned int>(rand());
+	_mazeJob = _jobs.Submit([this, seed]() { GenerateNewMazeSet(seed); });
+}
+
+void Canvas::GenerateNewMazeSet(unsigned int seed) 
+{
+	// Runs as a job, only touches _backMaze and the (free-threaded) device
+	// ジョブとして実行する、_backMazeとデバイスだけを使う
+	PROFILE_SCOPE("GenerateNewMazeSet");
+	_backMaze.InitMaze(_mazeCells, _mazeCells, _scrnW, _scrnH);
+	_backMaze.GenerateMazeParallel(_jobs, seed);
+	std::cout << "Maze created with " << _backMaze.GetMaze()->size() << " cells\n";
+
+	// Middle column, two thirds down (400, 400 on the default 20x20 maze at 800x600)
+	// 真ん中の列、上から３分の２（デフォルトの20x20、800x600では400, 400）
+	_backMaze.FindPath(0, 0, _backMaze.GetMazeWidth() / 2, _backMaze.GetMazeHeight() * 2 / 3);
+	_backPyramid.Build(_jobs, _backMaze);
+	_backMaze.SetIsDrawn(true);
+	_isMazeReady.store(true, std::memory_order_release);
+}
+
+void Canvas::SwapMazeSet(void) 
+{
+	if (!_isWaitingForMaze) return;
+	if (_sessionMode == SessionModeReplay)
+	{
+		// Swap on the recorded frame, waiting for the worker if it is slower this time
+		// 記録したフレームで交換する、ワーカーが今回遅ければ待つ
+		SessionEvent recorded;
+		if (!NextReplayEvent(SessionEventMazeSwap, recorded)) return;
+		_jobs.Wait(_mazeJob);
+	}
+	else if (!_isMazeReady.load(std::memory_order_acquire)) return;
+	RecordEvent(SessionEventMazeSwap);
+
+	_mazeJob.reset();
+	Maze& maze = Maze::GetInstance();
+	maze.Swap(_backMaze);
+	_pyramid.Swap(_backPyramid);
+	_slicedPyramid.Clear();
+	_isWaitingForMaze = false;
+
+	// A grid of another size starts zoomed out to fit, the same size keeps the view
+	// 別のサイズのグリッドは全体を表示する、同じサイズなら表示はそのまま
+	if (_camera.GetGridWidth() != maze.GetGridWidth() || _camera.GetGridHeight() != maze.GetGridHeight())
+	{
+		_camera.Fit(maze.GetGridWidth(), maze.GetGridHeight());
+		_previousCamera = _camera;
+	}
+
+	// Agents stood on the old grid
+	// エージェントは古いグリッドに立っていた
+	if (_isSimulating) _simulation.Reset(maze, _simulationAgents, static_cast<unsigned int>(rand()));
+	SDL_SetWindowTitle(_window, _title.c_str());
+}
+
+void Canvas::RequestSlicedMazeSet(void) 
+{
+	if (_isWaitingForMaze) 
+	{
+		std::cout << "Illegal call of Maze generation, aborting Maze generation\n";
+		return;
+	}
+	_isWaitingForMaze = true;
+	_isMazeReady = false;
+
+	_backMaze.InitMaze(_mazeCells, _mazeCells, _scrnW, _scrnH);
+	_mazeTask = _backMaze.GenerateMazeSliced(64);
+	_mazeTaskStage = MazeTaskStageGenerate;
+	_slicedPyramid.Clear();
+	_slicedRows = 0;
+	_slicesSincePyramid = 0;
+}
+
+void Canvas::ResumeSlicedMazeSet(void) 
+{
+	if (_mazeTaskStage == MazeTaskStageNone) return;
+	PROFILE_SCOPE("ResumeSlicedMazeSet");
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point deadline = Clock::now() + std::chrono::microseconds(_sliceBudgetMicroseconds);
+
+	// A replay runs exactly as many resumes as fitted into this frame when recording
+	// 再生は記録時にこのフレームに入った数だけ再開する
+	int recordedSlices = -1;
+	if (_sessionMode == SessionModeReplay)
+	{
+		SessionEvent recorded;
+		recordedSlices = NextReplayEvent(SessionEventSlices, recorded) ? recorded.value : 0;
+	}
+
+	// Resume slice by slice until the frame budget is used up
+	// フレームの予算がなくなるまでスライスごとに再開する
+	int slices = 0;
+	bool isFinished = false;
+	while (!isFinished && ((recordedSlices >= 0) ? slices < recordedSlices : Clock::now() < deadline)) 
+	{
+		slices++;
+		if (_mazeTask.Resume())
+		{
+			if (_mazeTaskStage == MazeTaskStageGenerate && ++_slicesSincePyramid >= kSlicedPyramidSlices) UpdateSlicedPyramid();
+			continue;
+		}
+
+		// Current stage is done, move on to the next one
+		// 今のステージが終わった、次へ進む
+		switch (_mazeTaskStage)
+		{
+			case MazeTaskStageGenerate:
+			{
+				// The walls are done, show them over the current maze while the path is being solved
+				// 壁ができた、パスを解いている間は今のメイズの上に表示する
+				_slicedPyramid.Build(_jobs, _backMaze);
+				_mazeTask = _backMaze.FindPathSliced(0, 0, _backMaze.GetMazeWidth() / 2, _backMaze.GetMazeHeight() * 2 / 3, 64);
+				_mazeTaskStage = MazeTaskStageSolve;
+			}break;
+
+			default:
+			{
+				// Solved, the pyramid is one parallel pass instead of a tile per cell
+				// 解けた、ピラミッドはセルごとのタイルではなく１回の並列パス
+				_backPyramid.Build(_jobs, _backMaze);
+				_backMaze.SetIsDrawn(true);
+				_mazeTask = {};
+				_mazeTaskStage = MazeTaskStageNone;
+				_isMazeReady.store(true, std::memory_order_release);
+				isFinished = true;
+			}break;
+		}
+	}
+	if (slices > 0) RecordEvent(SessionEventSlices, slices);
+	if (isFinished) return;
+
+	// Progress in the title bar
+	// 進捗をタイトルバーに表示する
+	char* progress = _frameArena.AllocateArray<char>(kTitleLength);
+	snprintf(progress, kTitleLength, "%s - cells %d / expanded %d of %d", _title.c_str(),
+		_backMaze.GetGeneratedCells(), _backMaze.GetExpandedNodes(), _backMaze.GetCellCount());
+	SDL_SetWindowTitle(_window, progress);
+}
+
+void Canvas::UpdateSlicedPyramid(void)
+{
+	// Rows are generated top to bottom, so only the ones since the last update (and the partly generated
+	// last one) change. Once every cell exists the backtracker carves anywhere, so the whole grid is redone
+	// 行は上から作られるので、前回から増えた行（と途中の最後の行）だけが変わる
+	// 全てのセルができた後はバックトラッカーがどこでも掘るので、グリッド全体を作り直す
+	_slicesSincePyramid = 0;
+	int gridWidth = _backMaze.GetGridWidth();
+	int gridHeight = _backMaze.GetGridHeight();
+	if (gridWidth <= 0) return;
+	int cellCount = _backMaze.GetCellCount();
+	if (cellCount >= gridWidth * gridHeight)
+	{
+		_slicedPyramid.UpdateRows(_jobs, _backMaze, 0, gridHeight);
+		return;
+	}
+	int generatedRows = cellCount / gridWidth;
+	_slicedPyramid.UpdateRows(_jobs, _backMaze, _slicedRows, generatedRows + 1);
+	_slicedRows = generatedRows;
+}
+
+void Canvas::ProcessInput(void) 
+{
+	SDL_Event event;
+
+	while (SDL_PollEvent(&event)) 
+	{
+		// The camera only changes what is drawn, so it isn't logged and still moves in a replay
+		// カメラは描くものしか変えないので記録せず、再生中も動かせる
+		if (HandleViewEvent(event)) continue;
+
+		// A replay ignores live input, closing the window still stops it
+		// 再生中はライブの入力を無視する、ウィンドウを閉じたら止まる
+		if (_sessionMode == SessionModeReplay && event.type != SDL_QUIT) continue;
+
+		switch (event.type)
+		{
+			case SDL_QUIT:
+			{
+				RecordEvent(SessionEventQuit);
+				*_isRunning = false;
+			}break;
+
+			case SDL_KEYDOWN:
+			{
+				RecordEvent(SessionEventKeyDown, event.key.keysym.sym);
+				HandleKeyDown(event.key.keysym.sym);
+			}break;
+		}
+	}
+
+	if (_sessionMode == SessionModeReplay)
+	{
+		// The recorded input of this frame, in the order it was handled
+		// このフレームで記録した入力、処理した順に
+		SessionEvent recorded;
+		while (_session.Peek(recorded) && recorded.frame == _frameIndex &&
+			(recorded.type == SessionEventKeyDown || recorded.type == SessionEventKeyHeld || recorded.type == SessionEventQuit))
+		{
+			_session.Next(_frameIndex, recorded);
+			if (recorded.type == SessionEventKeyDown) HandleKeyDown(static_cast<SDL_Keycode>(recorded.value));
+			else if (recorded.type == SessionEventKeyHeld) HandleKeyHeld(static_cast<SDL_Scancode>(recorded.value));
+			else *_isRunning = false;
+		}
+		return;
+	}
+
+	// Handle maze regeneration using key states instead of events
+	const Uint8* keyState = SDL_GetKeyboardState(NULL);
+	if (keyState[SDL_SCANCODE_F] && !_isWaitingForMaze) 
+	{
+		RecordEvent(SessionEventKeyHeld, SDL_SCANCODE_F);
+		HandleKeyHeld(SDL_SCANCODE_F);
+	}
+	if (keyState[SDL_SCANCODE_G] && !_isWaitingForMaze) 
+	{
+		RecordEvent(SessionEventKeyHeld, SDL_SCANCODE_G);
+		HandleKeyHeld(SDL_SCANCODE_G);
+	}
+}
+
+void Canvas::HandleKeyDown(SDL_Keycode key) 
+{
+	if (key == SDLK_ESCAPE)
+	{
+		*_isRunning = false;
+	}
+	if (key == SDLK_1)
+	{
+		_rasterizerState = (_rasterizerState == _rasterizerStateSolid) ?
+			_rasterizerStateWireframe : _rasterizerStateSolid;
+	}
+	if (key == SDLK_p)
+	{
+		Profiler::GetInstance().ExportChromeTrace("profile_trace.json");
+	}
+	if (key == SDLK_t)
+	{
+		Telemetry::GetInstance().Dump(std::cout);
+	}
+	if (key == SDLK_s)
+	{
+		ToggleSimulation();
+	}
+	if (key == SDLK_c)
+	{
+		_simulation.SetIsCooperative(!_simulation.GetIsCooperative());
+		std::cout << "Cooperative pathfinding " << (_simulation.GetIsCooperative() ? "on" : "off") << "\n";
+	}
+}
+
+void Canvas::HandleKeyHeld(SDL_Scancode scancode) 
+{
+	if (scancode == SDL_SCANCODE_F) 
+	{
+		// The old maze keeps rendering until the new one is swapped in
+		// 新しいメイズが交換されるまで古いメイズを表示し続ける
+		RequestNewMazeSet();
+	}
+	if (scancode == SDL_SCANCODE_G) 
+	{
+		RequestSlicedMazeSet();
+	}
+}
+
+void Canvas::UpdateFrame(double stepSeconds) 
+{
+	// Updates still queued in this Step after a quit are dropped
+	// 終了した後、このStepに残った更新は捨てる
+	if (!*_isRunning) return;
+	PROFILE_SCOPE("Update");
+
+	_previousCamera = _camera;
+	{
+		PROFILE_SCOPE("ProcessInput");
+		ProcessInput();
+		UpdateCamera(stepSeconds);
+	}
+	{
+		PROFILE_SCOPE("UpdateVariables");
+		UpdateVariables(stepSeconds);
+	}
+
+	if (_sessionMode == SessionModeReplay)
+	{
+		// Anything left over from this update means the replay took a different turn than the recording
+		// この更新の残りがあれば、再生が記録と違う道を通った
+		SessionEvent pending;
+		if (_session.Peek(pending) && pending.frame <= _frameIndex)
+		{
+			std::cerr << "Session: replay out of sync at frame " << _frameIndex << ", "
+				<< SessionLog::GetEventName(pending.type) << " was not consumed\n";
+			*_isRunning = false;
+		}
+		else if (_session.IsFinished())
+		{
+			*_isRunning = false;
+		}
+	}
+	_frameIndex++;
+}
+
+void Canvas::UpdateVariables(double stepSeconds) 
+{
+	// Time-sliced generation, then swap in a finished maze set at the update boundary
+	// タイムスライス生成、そして更新の境目に完成したメイズを交換する
+	ResumeSlicedMazeSet();
+	SwapMazeSet();
+
+	// The step is fixed, it is still logged in whole microseconds so a replay at another update rate
+	// advances the simulation by exactly the recorded amount
+	// ステップは固定だが、別の更新レートで再生しても記録した分だけ進めるようにマイクロ秒で記録する
+	int32_t frameMicroseconds = static_cast<int32_t>(stepSeconds * 1000000.0 + 0.5);
+	SessionEvent recorded;
+	if (_sessionMode == SessionModeReplay && NextReplayEvent(SessionEventFrame, recorded)) frameMicroseconds = recorded.value;
+	RecordEvent(SessionEventFrame, frameMicroseconds);
+	if (_isSimulating) _simulation.Advance(_jobs, frameMicroseconds / 1000000.0);
+}
+
+void Canvas::ToggleSimulation(void) 
+{
+	_isSimulating = !_isSimulating;
+	if (_isSimulating) _simulation.Reset(Maze::GetInstance(), _simulationAgents, static_cast<unsigned int>(rand()));
+	std::cout << "Agent simulation " << (_isSimulating ? "on" : "off") << "\n";
+}
+
+void Canvas::UpdateFrameStats(void) 
+{
+	// Measured rates and rolling p50/p99 frame times in the title bar, every 30 rendered frames
+	// 測ったレートと移動p50/p99フレーム時間をタイトルバーに表示する、30フレームごと
+	Profiler& profiler = Profiler::GetInstance();
+	if (_mazeTaskStage != MazeTaskStageNone || profiler.GetFrameCount() % 30 != 0) return;
+
+	char* title = _frameArena.AllocateArray<char>(kTitleLength);
+	int length = snprintf(title, kTitleLength, "%s - %.0f updates/s, %.0f frames/s - frame p50 %.2f ms / p99 %.2f ms - level %d, %zu quads",
+		_title.c_str(), _frameLoop.GetUpdateRate(), _frameLoop.GetRenderRate(),
+		profiler.GetFrameTimePercentile(50.0f), profiler.GetFrameTimePercentile(99.0f), _viewLevel, _viewVertices.size() / kTileVertexCount);
+
+	if (_isSimulating && length > 0 && length < static_cast<int>(kTitleLength))
+	{
+		snprintf(title + length, kTitleLength - length, " - %d agents%s, tick %lld, %lld steps, %lld repaths",
+			_simulation.GetAgentCount(), _simulation.GetIsCooperative() ? " (cooperative)" : "",
+			_simulation.GetTickCount(), _simulation.GetAgentSteps(), _simulation.GetRepathCount());
+	}
+	SDL_SetWindowTitle(_window, title);
+}
+
+void Canvas::RenderFrame(double alpha) 
+{
+	Profiler::GetInstance().MarkFrame();
+	PROFILE_SCOPE("Frame");
+	{
+		PROFILE_SCOPE("RenderGraphics");
+		RenderGraphics(alpha);
+	}
+	UpdateFrameStats();
+}
+
+void Canvas::RenderGraphics(double alpha) 
+{
+	if (*_isRunning) 
+	{
+		D3D11_VIEWPORT viewport = {};
+		viewport.TopLeftX = 0;
+		viewport.TopLeftY = 0;
+		viewport.Width = static_cast<float>(_scrnW);
+		viewport.Height = static_cast<float>(_scrnH);
+		viewport.MinDepth = 0.0f;
+		viewport.MaxDepth = 1.0f;
+
+		// Device Context
+		// Sets all relevant COM Objects
+		// 関連する全てのCOM Objectを設定する
+		constexpr float clearColor[] = { 0.5f, 0.5f, 0.5f, 1.0f };
+
+		_deviceContext->ClearRenderTargetView(_renderTarget.Get(), clearColor);
+		_deviceContext->RSSetState(_rasterizerState.Get());
+		_deviceContext->RSSetViewports(1, &viewport);
+		_deviceContext->OMSetRenderTargets(1, _renderTarget.GetAddressOf(), nullptr);
+
+		// Only the samples on screen, at the camera between the last two updates, in one draw
+		// 最後の２つの更新の間のカメラで、画面に入るサンプルだけを１回で描く
+		Maze& maze = Maze::GetInstance();
+		if (maze.GetIsDrawn()) 
+		{
+			PROFILE_SCOPE("DrawTiles");
+			MazeCamera camera = MazeCamera::Lerp(_previousCamera, _camera, alpha);
+			_viewLevel = BuildVisibleVertices(_jobs, camera, _pyramid, _viewVertices);
+			_tileBatch.Render(this, _viewVertices);
+
+			// Sliced generation in progress, its last finished stage on top
+			// スライス生成の途中、最後に終わったステージを上に描く
+			if (!_slicedPyramid.IsEmpty())
+			{
+				BuildVisibleVertices(_jobs, camera, _slicedPyramid, _slicedVertices);
+				_tileBatch.Render(this, _slicedVertices);
+			}
+		}
+	}
+}
+
+void Canvas::PresentGraphics(bool isVsync) 
+{
+	// Present the swap chain, a vsync'd present waits for the display and paces the render rate
+	// 表示、vsyncありはディスプレイを待つので描画レートを決める
+	if (!*_isRunning) return;
+	PROFILE_SCOPE("Present");
+	_swapChain->Present(isVsync ? 1 : 0, 0);
+}
+
+// = View =
+bool Canvas::HandleViewEvent(const SDL_Event& event)
+{
+	switch (event.type)
+	{
+		case SDL_MOUSEWHEEL:
+		{
+			// Zoom around the cursor
+			// カーソルを中心にズームする
+			int mouseX = 0;
+			int mouseY = 0;
+			SDL_GetMouseState(&mouseX, &mouseY);
+			_camera.Zoom(std::pow(kZoomPerWheelStep, static_cast<float>(event.wheel.y)), static_cast<float>(mouseX), static_cast<float>(mouseY));
+		}return true;
+
+		case SDL_MOUSEMOTION:
+		{
+			// Drag with the left button to pan
+			// 左ボタンでドラッグしてパンする
+			if ((event.motion.state & SDL_BUTTON_LMASK) == 0) return false;
+			_camera.Pan(static_cast<float>(-event.motion.xrel), static_cast<float>(-event.motion.yrel));
+		}return true;
+	}
+	return false;
+}
+
+void Canvas::UpdateCamera(double stepSeconds)
+{
+	// Held keys move the camera by the fixed step, Home fits the whole maze again
+	// 押しているキーは固定ステップで動かす、Homeでメイズ全体に戻す
+	const Uint8* keyState = SDL_GetKeyboardState(NULL);
+	float pan = kPanPixelsPerSecond * static_cast<float>(stepSeconds);
+	float dx = static_cast<float>(keyState[SDL_SCANCODE_RIGHT] - keyState[SDL_SCANCODE_LEFT]) * pan;
+	float dy = static_cast<float>(keyState[SDL_SCANCODE_DOWN] - keyState[SDL_SCANCODE_UP]) * pan;
+	if (dx != 0.0f || dy != 0.0f) _camera.Pan(dx, dy);
+
+	int zoom = keyState[SDL_SCANCODE_PAGEUP] - keyState[SDL_SCANCODE_PAGEDOWN];
+	if (zoom != 0)
+	{
+		_camera.Zoom(std::pow(kZoomPerSecond, zoom * static_cast<float>(stepSeconds)), _scrnW * 0.5f, _scrnH * 0.5f);
+	}
+	if (keyState[SDL_SCANCODE_HOME]) _camera.Fit(_camera.GetGridWidth(), _camera.GetGridHeight());
+}
+
+// = Session =
+void Canvas::RecordEvent(SessionEventType type, int32_t value)
+{
+	if (_sessionMode != SessionModeRecord) return;
+	long long timeMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _sessionStart).count();
+	_session.Append(_frameIndex, timeMicroseconds, type, value);
+}
+
+bool Canvas::NextReplayEvent(SessionEventType type, SessionEvent& event)
+{
+	SessionEvent pending;
+	if (!_session.Peek(pending) || pending.frame != _frameIndex || pending.type != type) return false;
+	return _session.Next(_frameIndex, event);
+}
+
+uint64_t Canvas::ComputeSessionDigest(void) const
+{
+	// FNV-1a over the shown maze, its path and the simulation counters
+	// 表示中のメイズ、パス、シミュレーションのカウンターのFNV-1a
+	uint64_t hash = 0xCBF29CE484222325ull;
+	auto mix = [&hash](long long value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= static_cast<unsigned char>(value >> (i * 8));
+			hash *= 0x100000001B3ull;
+		}
+	};
+
+	Maze& maze = Maze::GetInstance();
+	for (const GridIndex& cell : *maze.GetMaze()) mix(cell.cost);
+	for (const GridIndex& cell : *maze.GetPath()) mix(static_cast<long long>(cell.y) * maze.GetGridWidth() + cell.x);
+	mix(_isSimulating);
+	mix(_simulation.GetTickCount());
+	mix(_simulation.GetAgentSteps());
+	mix(_simulation.GetRepathCount());
+	return hash;
+}
+
+// = DirectX =
+bool Canvas::CreateSwapChainResources(void) 
+{
+	ErrorChecker errChecker = {};
+
+	ComPtr<ID3D11Texture2D> backBuffer = nullptr;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)), ErrorCheckBackBuffer)) return false;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(_device->CreateRenderTargetView(backBuffer.Get(), nullptr, &_renderTarget),
+		ErrorCheckRenderTargetView)) return false;
+
+	return true;
+}
+
+void Canvas::DestroySwapChainResources(void) 
+{
+	_renderTarget.Reset();
+}
 // =============================================
\ No newline at end of file
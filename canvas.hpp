@@ -1,70 +1,193 @@
-#pragma once
-
-
-// = DirectX =
-#include <d3d11.h>
-#include <dxgi1_6.h>
-#include <wrl.h>
-
-
-// = SDL =
-#include <SDL.h>
-
-
-// = Basics =
-#include <string>
-
-class Canvas 
-{
-	template<typename T>
-	using ComPtr = Microsoft::WRL::ComPtr<T>;
-
-public:
-
-	Canvas(std::string& title, int scrnW, int scrnH, bool* isRunning);
-	~Canvas(void);
-
-	void Loop(void);
-
-	
-	ID3D11Device* GetDevice(void);
-	ID3D11DeviceContext* GetDeviceContext(void);
-	int GetScreenWidth(void) const;
-	int GetScreenHeight(void) const;
-
-protected:
-
-
-
-private:
-
-	void GenerateNewMazeSet(void);
-	void ProcessInput(void);
-	void UpdateVariables(void);
-	void RenderGraphics(void);
-	
-	std::string _title;
-	bool* _isRunning;
-	bool _isWaitingForMaze;
-	int _scrnW;
-	int _scrnH;
-
-	// ========== DirectX ==========
-	bool CreateSwapChainResources(void);
-	void DestroySwapChainResources(void);
-
-	ComPtr<ID3D11Device> _device = nullptr;
-	ComPtr<ID3D11DeviceContext> _deviceContext = nullptr;
-	ComPtr<IDXGIFactory2> _dxgiFactory = nullptr;
-	ComPtr<IDXGISwapChain1> _swapChain = nullptr;
-	ComPtr<ID3D11RenderTargetView> _renderTarget = nullptr;
-	ComPtr<ID3D11RasterizerState> _rasterizerState = nullptr;
-	ComPtr<ID3D11RasterizerState> _rasterizerStateWireframe = nullptr;
-	ComPtr<ID3D11RasterizerState> _rasterizerStateSolid = nullptr;
-	// ================================
-
-	// ========== SDL ==========
-	SDL_Window* _window = nullptr;
-
-	// =========================
+#pragma once
+
+
+// = DirectX =
+#include <d3d11.h>
+#include <dxgi1_6.h>
+#include <wrl.h>
+
+
+// = SDL =
+#include <SDL.h>
+
+
+// = Basics =
+#include <string>
+#include <thread>
+#include <atomic>
+
+#include "arena.hpp"
+#include "frameloop.hpp"
+#include "jobsystem.hpp"
+#include "maze.hpp"
+#include "mazetask.hpp"
+#include "mazeview.hpp"
+#include "sessionlog.hpp"
+#include "simulation.hpp"
+#include "tilebatch.hpp"
+
+#include <chrono>
+
+typedef enum MazeTaskStage 
+{
+	MazeTaskStageNone,
+	MazeTaskStageGenerate,
+	MazeTaskStageSolve
+};
+
+typedef enum SessionMode 
+{
+	SessionModeLive,
+	SessionModeRecord,		// Live input, logged to a session file
+	SessionModeReplay		// Input comes from a session file, live input is ignored
+};
+
+class Canvas 
+{
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+public:
+
+	// mazeCells is the grid size of every generated maze (square), any size past the screen works
+	Canvas(std::string& title, int scrnW, int scrnH, bool* isRunning, int mazeCells = 20);
+	~Canvas(void);
+
+	void Loop(void);
+
+	
+	ID3D11Device* GetDevice(void);
+	ID3D11DeviceContext* GetDeviceContext(void);
+	int GetScreenWidth(void) const;
+	int GetScreenHeight(void) const;
+
+	// Update / render rates, uncapped is the benchmark mode (no vsync, no sleeping between frames)
+	// The measured rates are also in the title bar
+	void SetFrameLoopConfig(const FrameLoopConfig& config, bool isUncapped);
+	const FrameLoop& GetFrameLoop(void) const;
+	double GetUpdateRate(void) const;
+	double GetRenderRate(void) const;
+
+	// Record / replay a session from the next frame on, main seeds rand() with the header's seed
+	// before constructing the Canvas so the first maze matches too
+	void StartRecording(const std::string& filename, unsigned int seed);
+	void StartReplay(const SessionLog& session);
+	// After the loop: writes the recording, or checks the replay's end state against the recorded digest
+	void EndSession(void);
+
+protected:
+
+
+
+private:
+
+	void RequestNewMazeSet(void);
+	void GenerateNewMazeSet(unsigned int seed);
+	void SwapMazeSet(void);
+	void RequestSlicedMazeSet(void);
+	void ResumeSlicedMazeSet(void);
+	void UpdateSlicedPyramid(void);
+	void UpdateFrameStats(void);
+	void ToggleSimulation(void);
+	void ProcessInput(void);
+	void HandleKeyDown(SDL_Keycode key);
+	void HandleKeyHeld(SDL_Scancode scancode);
+	void UpdateFrame(double stepSeconds);
+	void UpdateVariables(double stepSeconds);
+	void RenderFrame(double alpha);
+	void RenderGraphics(double alpha);
+	void PresentGraphics(bool isVsync);
+	
+	std::string _title;
+	bool* _isRunning;
+	bool _isWaitingForMaze;
+	int _scrnW;
+	int _scrnH;
+	int _mazeCells = 20;
+
+	// ========== Maze worker ==========
+	// A job builds into _backMaze, the main thread swaps it in at a frame boundary
+	// One core is left for the render thread
+	JobSystem _jobs{ static_cast<int>(std::thread::hardware_concurrency()) - 1 };
+	JobHandle _mazeJob;
+	std::atomic<bool> _isMazeReady = false;
+	Maze _backMaze;
+	// =================================
+
+	// ========== Sliced maze (no thread) ==========
+	// Resumed from UpdateVariables for at most _sliceBudgetMicroseconds per update
+	MazeTask _mazeTask;
+	MazeTaskStage _mazeTaskStage = MazeTaskStageNone;
+	long long _sliceBudgetMicroseconds = 4000;
+	// =============================================
+
+	// ========== Agent simulation ==========
+	// Fixed ticks on the job system, advanced by the update step of every UpdateVariables call
+	AgentSimulation _simulation;
+	bool _isSimulating = false;
+	int _simulationAgents = 10000;
+	// ======================================
+
+	// ========== View ==========
+	// Camera over the shown maze and the cell pyramids of the shown and the back maze set
+	// Only the samples on screen are drawn, at the pyramid level that fits the zoom, in one batch
+	bool HandleViewEvent(const SDL_Event& event);
+	void UpdateCamera(double stepSeconds);
+
+	MazeCamera _camera;
+	MazeCamera _previousCamera;		// At the start of this update, rendering interpolates between the two
+	CellPyramid _pyramid;
+	CellPyramid _backPyramid;
+	TileBatch _tileBatch;
+	std::vector<TileVertex> _viewVertices;
+	int _viewLevel = 0;
+
+	// The sliced _backMaze as far as it got, drawn over the shown maze until the swap. Updated every
+	// kSlicedPyramidSlices slices while generating (rows below _slicedRows are done) and rebuilt when
+	// the generate stage finishes
+	CellPyramid _slicedPyramid;
+	int _slicedRows = 0;
+	int _slicesSincePyramid = 0;
+	std::vector<TileVertex> _slicedVertices;
+	// ==========================
+
+	// ========== Frame loop ==========
+	// Input and updates run at the fixed update rate, rendering at its own rate (or as fast as vsync allows)
+	FrameLoop _frameLoop;
+	// ================================
+
+	// Render-side temporaries (window titles, path masks), reset at the top of every Loop
+	MonotonicArena _frameArena{ TelemetryMemoryFrame };
+
+	// ========== Session record / replay ==========
+	// Inputs, update deltas, slice counts and maze swaps are logged per update, a replay feeds them back
+	void RecordEvent(SessionEventType type, int32_t value = 0);
+	bool NextReplayEvent(SessionEventType type, SessionEvent& event);
+	uint64_t ComputeSessionDigest(void) const;
+
+	SessionMode _sessionMode = SessionModeLive;
+	SessionLog _session;
+	std::string _sessionFile;
+	uint32_t _frameIndex = 0;
+	std::chrono::steady_clock::time_point _sessionStart;
+	// =============================================
+
+	// ========== DirectX ==========
+	bool CreateSwapChainResources(void);
+	void DestroySwapChainResources(void);
+
+	ComPtr<ID3D11Device> _device = nullptr;
+	ComPtr<ID3D11DeviceContext> _deviceContext = nullptr;
+	ComPtr<IDXGIFactory2> _dxgiFactory = nullptr;
+	ComPtr<IDXGISwapChain1> _swapChain = nullptr;
+	ComPtr<ID3D11RenderTargetView> _renderTarget = nullptr;
+	ComPtr<ID3D11RasterizerState> _rasterizerState = nullptr;
+	ComPtr<ID3D11RasterizerState> _rasterizerStateWireframe = nullptr;
+	ComPtr<ID3D11RasterizerState> _rasterizerStateSolid = nullptr;
+	// ================================
+
+	// ========== SDL ==========
+	SDL_Window* _window = nullptr;
+
+	// =========================
 };
\ No newline at end of file
@@ -0,0 +1,147 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+/*
+	Storage orders for a grid of cells, used by LayoutGrid (see layoutgrid.hpp)
+	Every layout maps cell (x, y) to a storage index and steps to the four neighbours without decoding.
+	A step off the grid always lands on a storage slot the grid keeps as a wall, so the solvers need no
+	bounds checks: row-major and tiled keep a one-cell border, Morton (where a border would double the
+	power-of-two square) sends those steps to one extra slot past the square
+	Row-major puts the cell below a whole row away, Morton (Z-order) and 8x8 tiles keep
+	both neighbours within a few cache lines most of the time
+	Init returns false when the storage wouldn't fit int indices
+	グリッドのセルの並べ方、LayoutGrid用
+	グリッドの外への移動は必ず壁のスロットに着く：行優先とタイルは１セルの枠、Mortonは正方形の後の１スロット
+	行優先だと下のセルは１行分離れる、Morton（Z順）と8x8タイルは縦の隣も近い
+*/
+
+struct RowMajorLayout
+{
+	int stride = 0;
+	int height = 0;
+
+	bool Init(int width, int gridHeight)
+	{
+		stride = width + 2;
+		height = gridHeight + 2;
+		return static_cast<int64_t>(stride) * height <= INT32_MAX;
+	}
+	int GetStorageCount(void) const { return stride * height; }
+	int ToStorage(int x, int y) const { return (y + 1) * stride + x + 1; }
+	void ToXY(int index, int& x, int& y) const
+	{
+		x = index % stride - 1;
+		y = index / stride - 1;
+	}
+	int Left(int index) const { return index - 1; }
+	int Right(int index) const { return index + 1; }
+	int Up(int index) const { return index - stride; }
+	int Down(int index) const { return index + stride; }
+};
+
+// x bits on the even positions, y bits on the odd ones, the square side is a power of two
+// Steps add / subtract on one axis with the other axis' bits forced so the carry runs through them,
+// a step past either end of an axis goes to the wall slot at side * side instead
+// Cells past the grid's width / height (the rest of the square) are walls too
+// Storage indices are int, so the square stops at kMaxSide (2^30 cells plus the wall slot)
+// xのビットは偶数の位置、yは奇数の位置、正方形の辺は2の累乗
+// 軸の端から出る移動はside * sideの壁のスロットへ、正方形の残りも壁、辺はkMaxSideまで
+struct MortonLayout
+{
+	static constexpr uint32_t kXMask = 0x55555555u;
+	static constexpr uint32_t kYMask = 0xAAAAAAAAu;
+	static constexpr int kMaxSide = 1 << 15;
+	int side = 1;
+	uint32_t xEdge = 0;		// x bits of x == side - 1
+	uint32_t yEdge = 0;
+	int wallSlot = 1;
+
+	// False if the square would be bigger than kMaxSide
+	// 正方形がkMaxSideより大きくなる時はfalse
+	bool Init(int width, int height)
+	{
+		int64_t squareSide = 1;
+		while (squareSide < std::max(width, height)) squareSide <<= 1;
+		if (squareSide > kMaxSide) return false;
+		side = static_cast<int>(squareSide);
+		wallSlot = static_cast<int>(squareSide * squareSide);
+		xEdge = kXMask & static_cast<uint32_t>(wallSlot - 1);
+		yEdge = kYMask & static_cast<uint32_t>(wallSlot - 1);
+		return true;
+	}
+	int GetStorageCount(void) const { return wallSlot + 1; }
+	int ToStorage(int x, int y) const { return static_cast<int>(Spread(x) | (Spread(y) << 1)); }
+	void ToXY(int index, int& x, int& y) const
+	{
+		x = static_cast<int>(Compact(static_cast<uint32_t>(index)));
+		y = static_cast<int>(Compact(static_cast<uint32_t>(index) >> 1));
+	}
+	int Left(int index) const { return (static_cast<uint32_t>(index) & kXMask) == 0 ? wallSlot : Step(index, -1, kXMask); }
+	int Right(int index) const { return (static_cast<uint32_t>(index) & kXMask) == xEdge ? wallSlot : Step(index, 1, kXMask); }
+	int Up(int index) const { return (static_cast<uint32_t>(index) & kYMask) == 0 ? wallSlot : Step(index, -2, kYMask); }
+	int Down(int index) const { return (static_cast<uint32_t>(index) & kYMask) == yEdge ? wallSlot : Step(index, 2, kYMask); }
+
+	static uint32_t Spread(int value)
+	{
+		uint32_t bits = static_cast<uint32_t>(value) & 0xFFFFu;
+		bits = (bits | (bits << 8)) & 0x00FF00FFu;
+		bits = (bits | (bits << 4)) & 0x0F0F0F0Fu;
+		bits = (bits | (bits << 2)) & 0x33333333u;
+		bits = (bits | (bits << 1)) & 0x55555555u;
+		return bits;
+	}
+	static uint32_t Compact(uint32_t bits)
+	{
+		bits &= 0x55555555u;
+		bits = (bits | (bits >> 1)) & 0x33333333u;
+		bits = (bits | (bits >> 2)) & 0x0F0F0F0Fu;
+		bits = (bits | (bits >> 4)) & 0x00FF00FFu;
+		bits = (bits | (bits >> 8)) & 0x0000FFFFu;
+		return bits;
+	}
+	static int Step(int index, int delta, uint32_t axisMask)
+	{
+		uint32_t bits = static_cast<uint32_t>(index);
+		uint32_t axis = (delta > 0) ? ((bits | ~axisMask) + static_cast<uint32_t>(delta)) : ((bits & axisMask) - static_cast<uint32_t>(-delta));
+		return static_cast<int>((axis & axisMask) | (bits & ~axisMask));
+	}
+};
+
+// 8x8 tiles of 64 cells in row-major tile order, cells row-major inside a tile
+// The low 3 bits of an index are x & 7 and the next 3 are y & 7, so steps only look at those
+// 64セルの8x8タイル、インデックスの下3ビットがx & 7、次の3ビットがy & 7
+struct Tiled8Layout
+{
+	static constexpr int kTileShift = 3;
+	static constexpr int kTileCells = 64;
+	int tilesPerRow = 0;
+	int tileRows = 0;
+
+	// The border cells are at -1 and width / height, so tile (0, 0) starts one cell up and left of the grid
+	// 枠のセルは-1とwidth / height、タイル(0, 0)はグリッドの１セル左上から始まる
+	bool Init(int width, int height)
+	{
+		tilesPerRow = (width + 2 + 7) >> kTileShift;
+		tileRows = (height + 2 + 7) >> kTileShift;
+		return static_cast<int64_t>(tilesPerRow) * tileRows * kTileCells <= INT32_MAX;
+	}
+	int GetStorageCount(void) const { return tilesPerRow * tileRows * kTileCells; }
+	int ToStorage(int x, int y) const
+	{
+		x++;
+		y++;
+		return ((y >> kTileShift) * tilesPerRow + (x >> kTileShift)) * kTileCells + ((y & 7) << kTileShift) + (x & 7);
+	}
+	void ToXY(int index, int& x, int& y) const
+	{
+		int tile = index / kTileCells;
+		x = (tile % tilesPerRow) * 8 + (index & 7) - 1;
+		y = (tile / tilesPerRow) * 8 + ((index >> kTileShift) & 7) - 1;
+	}
+	int Left(int index) const { return (index & 7) != 0 ? index - 1 : index - kTileCells + 7; }
+	int Right(int index) const { return (index & 7) != 7 ? index + 1 : index + kTileCells - 7; }
+	int Up(int index) const { return (index & 56) != 0 ? index - 8 : index - tilesPerRow * kTileCells + 56; }
+	int Down(int index) const { return (index & 56) != 56 ? index + 8 : index + tilesPerRow * kTileCells - 56; }
+};
@@ -0,0 +1,382 @@
+﻿#include "cooperativeplanner.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+
+// ======= Public ==========
+SpaceTimeTable::SpaceTimeTable()
+{}
+
+SpaceTimeTable::~SpaceTimeTable()
+{}
+
+void SpaceTimeTable::Clear(int expectedEntries)
+{
+	size_t capacity = 16;
+	while (capacity < static_cast<size_t>(expectedEntries) * 2) capacity *= 2;
+
+	if (capacity > _slots.size())
+	{
+		_slots.assign(capacity, {});
+		_mask = capacity - 1;
+		_stamp = 0;
+	}
+
+	// Stamp wrapped around, old slots could look used again
+	// スタンプが一周した、古いスロットをクリアする
+	if (++_stamp == 0)
+	{
+		for (auto& slot : _slots) slot.stamp = 0;
+		_stamp = 1;
+	}
+	_entryCount = 0;
+}
+
+bool SpaceTimeTable::Insert(int cell, int time, int value)
+{
+	// Keep the load under 1/2, past that probing gets long
+	// 負荷を1/2以下に保つ
+	if (static_cast<size_t>(_entryCount + 1) * 2 > _slots.size())
+	{
+		std::vector<Slot> old;
+		old.swap(_slots);
+		unsigned int oldStamp = _stamp;
+		_slots.assign(old.size() * 2, {});
+		_mask = _slots.size() - 1;
+		_stamp = 1;
+		_entryCount = 0;
+		for (const auto& slot : old)
+		{
+			if (slot.stamp == oldStamp) Insert(static_cast<int>(slot.key >> 32), static_cast<int>(slot.key & 0xFFFFFFFFu), slot.value);
+		}
+	}
+
+	uint64_t key = MakeKey(cell, time);
+	Slot& slot = _slots[Probe(key)];
+	if (slot.stamp == _stamp) return false;
+
+	slot.key = key;
+	slot.value = value;
+	slot.stamp = _stamp;
+	_entryCount++;
+	return true;
+}
+
+int SpaceTimeTable::Find(int cell, int time) const
+{
+	if (_slots.empty()) return -1;
+	const Slot& slot = _slots[Probe(MakeKey(cell, time))];
+	return (slot.stamp == _stamp) ? slot.value : -1;
+}
+
+bool SpaceTimeTable::Erase(int cell, int time)
+{
+	if (_slots.empty()) return false;
+	size_t hole = Probe(MakeKey(cell, time));
+	if (_slots[hole].stamp != _stamp) return false;
+
+	// Backward-shift deletion: pull later entries of the chain into the hole unless it is before their home slot
+	// 後ろへのシフト削除：チェーンの後のエントリを、ホームより前にならない限り穴に詰める
+	for (size_t next = (hole + 1) & _mask; _slots[next].stamp == _stamp; next = (next + 1) & _mask)
+	{
+		size_t home = static_cast<size_t>(Hash(_slots[next].key)) & _mask;
+		bool isHomeBetween = (hole <= next) ? (hole < home && home <= next) : (hole < home || home <= next);
+		if (isHomeBetween) continue;
+		_slots[hole] = _slots[next];
+		hole = next;
+	}
+	_slots[hole].stamp = 0;
+	_entryCount--;
+	return true;
+}
+
+int SpaceTimeTable::GetEntryCount() const
+{
+	return _entryCount;
+}
+
+
+CooperativePlanner::CooperativePlanner()
+{}
+
+CooperativePlanner::~CooperativePlanner()
+{}
+
+void CooperativePlanner::PlanWindow(const Maze& maze, const std::vector<int>& order, const std::vector<int>& starts,
+	const std::vector<int>& goals, std::vector<std::vector<int>>& paths)
+{
+	PROFILE_SCOPE("CooperativePlanner::PlanWindow");
+	BeginWindow(maze, order, starts, goals);
+	PlanAgents(paths, static_cast<int>(order.size()));
+}
+
+void CooperativePlanner::BeginWindow(const Maze& maze, const std::vector<int>& order, const std::vector<int>& starts, const std::vector<int>& goals)
+{
+	int agentCount = static_cast<int>(starts.size());
+	_maze = &maze;
+	_order = order;
+	_starts = starts;
+	_goals = goals;
+	_isWaiting.assign(agentCount, 0);
+	_nextInOrder = 0;
+	_reservations.Clear(agentCount * (_window + 2));
+	_expandedNodes = 0;
+	_failedAgents = 0;
+	_displacedAgents = 0;
+	_conflicts = 0;
+
+	// Everyone stands somewhere at t = 0, nobody may plan into that
+	// (random starts may share a cell, that is the input and not a planning conflict)
+	// t = 0では全員どこかに立っている（ランダムなスタートは重なるかもしれない、それは入力で計画の衝突ではない）
+	for (int agent = 0; agent < agentCount; agent++)
+	{
+		_reservations.Insert(starts[agent], 0, agent);
+	}
+}
+
+bool CooperativePlanner::PlanAgents(std::vector<std::vector<int>>& paths, int maxAgents)
+{
+	PROFILE_SCOPE("CooperativePlanner::PlanAgents");
+	paths.resize(_starts.size());
+
+	int end = std::min(static_cast<int>(_order.size()), _nextInOrder + std::max(0, maxAgents));
+	for (; _nextInOrder < end; _nextInOrder++)
+	{
+		// Waiting agents can displace agents planned earlier, those are placed again before moving on
+		// 待つエージェントは先の計画を押しのけることがある、先に進む前にそれを置き直す
+		_displaced.push_back(_order[_nextInOrder]);
+		while (!_displaced.empty())
+		{
+			int agent = _displaced.back();
+			_displaced.pop_back();
+			PlaceAgent(agent, paths);
+		}
+	}
+	return _nextInOrder == static_cast<int>(_order.size());
+}
+
+int CooperativePlanner::GetRemainingAgents() const
+{
+	return static_cast<int>(_order.size()) - _nextInOrder;
+}
+
+int CooperativePlanner::GetWindow() const
+{
+	return _window;
+}
+
+void CooperativePlanner::SetWindow(int window)
+{
+	_window = std::max(1, window);
+}
+
+int CooperativePlanner::GetMaxExpansions() const
+{
+	return _maxExpansions;
+}
+
+void CooperativePlanner::SetMaxExpansions(int maxExpansions)
+{
+	_maxExpansions = std::max(1, maxExpansions);
+}
+
+long long CooperativePlanner::GetExpandedNodes() const
+{
+	return _expandedNodes;
+}
+
+int CooperativePlanner::GetFailedAgents() const
+{
+	return _failedAgents;
+}
+
+int CooperativePlanner::GetDisplacedAgents() const
+{
+	return _displacedAgents;
+}
+
+int CooperativePlanner::GetConflicts() const
+{
+	return _conflicts;
+}
+
+const SpaceTimeTable& CooperativePlanner::GetReservations() const
+{
+	return _reservations;
+}
+// =======================================
+
+// ====== Private ======
+uint64_t SpaceTimeTable::Hash(uint64_t key)
+{
+	// SplitMix64 finalizer
+	// SplitMix64の最後
+	uint64_t hash = key;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	return hash ^ (hash >> 31);
+}
+
+size_t SpaceTimeTable::Probe(uint64_t key) const
+{
+	// Linear probing up to the first free or matching slot
+	// 空きか同じキーのスロットまで線形探査
+	size_t index = static_cast<size_t>(Hash(key)) & _mask;
+	while (_slots[index].stamp == _stamp && _slots[index].key != key)
+	{
+		index = (index + 1) & _mask;
+	}
+	return index;
+}
+
+bool CooperativePlanner::PlanAgent(const Maze& maze, int start, int goal, std::vector<int>& path)
+{
+	SearchCounters counters;
+	SearchTelemetryScope telemetry(TelemetrySolverCooperative, counters, path);
+	path.clear();
+	int gridWidth = maze.GetGridWidth();
+	int gridHeight = maze.GetGridHeight();
+	int goalX = goal % gridWidth;
+	int goalY = goal / gridWidth;
+	auto heuristic = [=](int cell) { return std::abs(cell % gridWidth - goalX) + std::abs(cell / gridWidth - goalY); };
+
+	// Every move (waiting too) costs one tick, so g == time and f = time + Manhattan
+	// Heap keys are f then h, so ties go to the node closer to the goal
+	// 全ての移動は１ティックなので g == time、ヒープのキーは f、次に h
+	auto makeKey = [](int f, int h) { return (static_cast<long long>(f) << 32) | h; };
+	auto isGreater = std::greater<std::pair<long long, int>>();
+
+	_nodes.clear();
+	_open.clear();
+	_visited.Clear(std::min(_maxExpansions * 5, static_cast<int>(maze.GetCellCount()) * (_window + 1)));
+
+	_nodes.push_back({ start, 0, -1 });
+	_visited.Insert(start, 0, 0);
+	_open.push_back({ makeKey(heuristic(start), heuristic(start)), 0 });
+
+	int found = -1;
+	int expansions = 0;
+	while (!_open.empty() && expansions < _maxExpansions)
+	{
+		std::pop_heap(_open.begin(), _open.end(), isGreater);
+		int nodeIndex = _open.back().second;
+		_open.pop_back();
+
+		SearchNode node = _nodes[nodeIndex];
+		expansions++;
+
+		// Done at the goal if nobody needs it for the rest of the window, or at the edge of the window
+		// ゴールで窓の残りを誰も使わないか、窓の端に着いたら終わり
+		if ((node.cell == goal && IsFreeFrom(goal, node.time + 1)) || node.time == _window)
+		{
+			found = nodeIndex;
+			break;
+		}
+
+		int nodeX = node.cell % gridWidth;
+		int nodeY = node.cell / gridWidth;
+		int nextTime = node.time + 1;
+		auto expand = [&](int nextCell)
+		{
+			if (maze.IsWall(nextCell)) return;
+			if (_reservations.Find(nextCell, nextTime) != -1) return;
+
+			// No swapping places with the agent coming the other way
+			// 反対から来るエージェントと場所を入れ替えない
+			if (nextCell != node.cell)
+			{
+				int other = _reservations.Find(nextCell, node.time);
+				if (other != -1 && _reservations.Find(node.cell, nextTime) == other) return;
+			}
+			if (!_visited.Insert(nextCell, nextTime, static_cast<int>(_nodes.size()))) return;
+
+			int h = heuristic(nextCell);
+			_open.push_back({ makeKey(nextTime + h, h), static_cast<int>(_nodes.size()) });
+			std::push_heap(_open.begin(), _open.end(), isGreater);
+			_nodes.push_back({ nextCell, nextTime, nodeIndex });
+			counters.peakQueue = std::max(counters.peakQueue, static_cast<long long>(_open.size()));
+		};
+
+		// Wait, left, right, up, down
+		// 待つ、左、右、上、下
+		expand(node.cell);
+		if (nodeX > 0) expand(node.cell - 1);
+		if (nodeX < gridWidth - 1) expand(node.cell + 1);
+		if (nodeY > 0) expand(node.cell - gridWidth);
+		if (nodeY < gridHeight - 1) expand(node.cell + gridWidth);
+	}
+	_expandedNodes += expansions;
+	counters.expandedNodes = expansions;
+	counters.enqueuedNodes = static_cast<long long>(_nodes.size());
+	if (found == -1) return false;
+
+	// One cell per tick, then stand on the last cell until the window ends
+	// ティックごとに１セル、そして窓が終わるまで最後のセルに立つ
+	path.assign(_nodes[found].time + 1, 0);
+	for (int nodeIndex = found; nodeIndex != -1; nodeIndex = _nodes[nodeIndex].parent)
+	{
+		path[_nodes[nodeIndex].time] = _nodes[nodeIndex].cell;
+	}
+	path.resize(_window + 1, path.back());
+	return true;
+}
+
+bool CooperativePlanner::IsFreeFrom(int cell, int time) const
+{
+	for (int t = time; t <= _window; t++)
+	{
+		if (_reservations.Find(cell, t) != -1) return false;
+	}
+	return true;
+}
+
+void CooperativePlanner::PlaceAgent(int agent, std::vector<std::vector<int>>& paths)
+{
+	std::vector<int>& path = paths[agent];
+	if (PlanAgent(*_maze, _starts[agent], _goals[agent], path))
+	{
+		ReservePath(agent, path);
+		return;
+	}
+
+	// Nothing found, wait in place for the whole window. Agents planned earlier that pass through the cell
+	// give way and are planned again, each agent waits at most once per window so this ends
+	// 見つからない、窓の間その場で待つ。そのセルを通る先のエージェントは道を譲って計画し直す、
+	// 待つのは窓に１回だけなので終わる
+	_failedAgents++;
+	_isWaiting[agent] = 1;
+	int start = _starts[agent];
+	path.assign(_window + 1, start);
+	for (int time = 1; time <= _window; time++)
+	{
+		int holder = _reservations.Find(start, time);
+		if (holder == -1 || _isWaiting[holder]) continue;
+		UnreservePath(holder, paths[holder]);
+		_displaced.push_back(holder);
+		_displacedAgents++;
+	}
+	ReservePath(agent, path);
+}
+
+void CooperativePlanner::ReservePath(int agent, const std::vector<int>& path)
+{
+	// A planned path avoided every reservation, only two agents waiting on one start cell can clash
+	// 計画したパスは全ての予約を避けた、ぶつかるのは同じスタートセルで待つ２つのエージェントだけ
+	for (int time = 1; time <= _window; time++)
+	{
+		if (!_reservations.Insert(path[time], time, agent)) _conflicts++;
+	}
+}
+
+void CooperativePlanner::UnreservePath(int agent, const std::vector<int>& path)
+{
+	for (int time = 1; time <= _window; time++)
+	{
+		if (_reservations.Find(path[time], time) == agent) _reservations.Erase(path[time], time);
+	}
+}
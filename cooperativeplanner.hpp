@@ -0,0 +1,143 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Maze;
+
+/*
+	Open-addressing hash of (cell, time) -> value, used as the space-time reservation table
+	and as the visited set of the space-time A*
+	Slots carry a stamp, so Clear is O(1) unless the table has to grow
+	(cell, time) -> 値 のハッシュ、時空予約表と時空A*の訪問済みセットに使う
+*/
+
+class SpaceTimeTable 
+{
+public:
+	SpaceTimeTable(void);
+	~SpaceTimeTable(void);
+
+	// Drops every entry, grows to at least twice expectedEntries slots
+	// 全てのエントリを消す、expectedEntriesの２倍以上のスロットにする
+	void Clear(int expectedEntries);
+
+	// False if (cell, time) is already taken
+	// (cell, time)がもう取られていたらfalse
+	bool Insert(int cell, int time, int value);
+	// -1 if (cell, time) is free
+	// (cell, time)が空いていたら-1
+	int Find(int cell, int time) const;
+	// False if (cell, time) was free, the probe chain is shifted back so no tombstones pile up
+	// (cell, time)が空いていたらfalse、探査の列を詰めるので墓標は残らない
+	bool Erase(int cell, int time);
+
+	int GetEntryCount(void) const;
+
+private:
+	typedef struct Slot 
+	{
+		uint64_t key;
+		int value;
+		unsigned int stamp;
+	};
+
+	static uint64_t MakeKey(int cell, int time) { return (static_cast<uint64_t>(static_cast<uint32_t>(cell)) << 32) | static_cast<uint32_t>(time); }
+	static uint64_t Hash(uint64_t key);
+	size_t Probe(uint64_t key) const;
+
+	std::vector<Slot> _slots;
+	size_t _mask = 0;
+	unsigned int _stamp = 0;
+	int _entryCount = 0;
+};
+
+
+/*
+	Windowed cooperative A* (WHCA*): agents are planned one by one in priority order,
+	each one searches (cell, time) space for _window ticks around the reservations of the agents before it
+	Moves are the 4 neighbours or waiting, every move costs one tick
+	An agent that finds nothing stays where it is, and any agent planned before it that would pass through
+	that cell gives way: its reservations are taken back and it is planned again around the waiting one
+	A window can be planned in slices (BeginWindow, then PlanAgents until it returns true)
+	窓付き協調A*：エージェントを優先順に１つずつ計画する、前のエージェントの予約を避けて時空を探す
+	見つからないエージェントはその場で待ち、そのセルを通る先のエージェントは予約を戻して計画し直す
+*/
+
+class CooperativePlanner 
+{
+public:
+	CooperativePlanner(void);
+	~CooperativePlanner(void);
+
+	// Plans every agent in order (order[0] first), paths[agent] gets _window + 1 cells, one per tick
+	// starting at the agent's start, waiting repeats a cell
+	// Agents that find nothing in _maxExpansions wait where they are
+	// 順番に全てのエージェントを計画する、paths[agent]はティックごとに１セルで_window + 1セル
+	void PlanWindow(const Maze& maze, const std::vector<int>& order, const std::vector<int>& starts,
+		const std::vector<int>& goals, std::vector<std::vector<int>>& paths);
+
+	// Same plan as PlanWindow, a few agents at a time: order, starts and goals are copied,
+	// the maze must stay unchanged until PlanAgents returns true
+	// PlanWindowと同じ計画を少しずつ：order、starts、goalsはコピーする、終わるまでメイズは変えない
+	void BeginWindow(const Maze& maze, const std::vector<int>& order, const std::vector<int>& starts, const std::vector<int>& goals);
+	// Plans the next maxAgents agents of the order, true once every agent has a path
+	// 順番の次のmaxAgents体を計画する、全員にパスができたらtrue
+	bool PlanAgents(std::vector<std::vector<int>>& paths, int maxAgents);
+	int GetRemainingAgents(void) const;
+
+	int GetWindow(void) const;
+	void SetWindow(int window);
+	int GetMaxExpansions(void) const;
+	void SetMaxExpansions(int maxExpansions);
+	long long GetExpandedNodes(void) const;
+	int GetFailedAgents(void) const;
+	// Agents that gave way to a waiting one and were planned again
+	// 待つエージェントに道を譲って計画し直したエージェント
+	int GetDisplacedAgents(void) const;
+	// (cell, time) reservations that still clash, only when two waiting agents share a start cell
+	// まだぶつかる予約、２つの待つエージェントが同じスタートセルにいる時だけ
+	int GetConflicts(void) const;
+	const SpaceTimeTable& GetReservations(void) const;
+
+private:
+	typedef struct SearchNode 
+	{
+		int cell;
+		int time;
+		int parent;
+	};
+
+	bool PlanAgent(const Maze& maze, int start, int goal, std::vector<int>& path);
+	bool IsFreeFrom(int cell, int time) const;
+	// Plans the agent, or makes it wait and pushes the agents it displaces onto _displaced
+	// エージェントを計画する、または待たせて押しのけたエージェントを_displacedに積む
+	void PlaceAgent(int agent, std::vector<std::vector<int>>& paths);
+	void ReservePath(int agent, const std::vector<int>& path);
+	void UnreservePath(int agent, const std::vector<int>& path);
+
+	int _window = 16;
+	int _maxExpansions = 4096;
+
+	// The window being planned
+	// 計画中の窓
+	const Maze* _maze = nullptr;
+	std::vector<int> _order;
+	std::vector<int> _starts;
+	std::vector<int> _goals;
+	std::vector<char> _isWaiting;
+	std::vector<int> _displaced;
+	int _nextInOrder = 0;
+
+	SpaceTimeTable _reservations;
+	SpaceTimeTable _visited;
+	std::vector<SearchNode> _nodes;
+	std::vector<std::pair<long long, int>> _open;
+
+	long long _expandedNodes = 0;
+	int _failedAgents = 0;
+	int _displacedAgents = 0;
+	int _conflicts = 0;
+};
@@ -0,0 +1,330 @@
+﻿#include "externalbfs.hpp"
+#include "pagedgrid.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+
+// ======= Public ==========
+ExternalBFS::ExternalBFS()
+{}
+
+ExternalBFS::~ExternalBFS()
+{}
+
+void ExternalBFS::SetWorkDirectory(const std::string& directory)
+{
+	_workDirectory = directory;
+}
+
+void ExternalBFS::SetMemoryCap(size_t memoryCap)
+{
+	_memoryCap = memoryCap;
+}
+
+bool ExternalBFS::Solve(PagedGrid& grid, long long startIndex, long long endIndex, std::vector<long long>& path)
+{
+	PROFILE_SCOPE("ExternalBFS::Solve");
+	SearchTelemetryScope telemetry(TelemetrySolverExternalBFS, _counters, path);
+	path.clear();
+	_levelBegin.clear();
+	_counters = {};
+	_bytesRead = 0;
+	_bytesWritten = 0;
+	_isFailed = false;
+
+	if (!grid.IsGood())
+	{
+		_isFailed = true;
+		return false;
+	}
+	long long width = grid.GetWidth();
+	long long cellCount = grid.GetCellCount();
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+	if (grid.IsWall(startIndex) || grid.IsWall(endIndex)) return false;
+
+	std::string levelsName = PagedGrid::MakeWorkFileName(_workDirectory, "extbfs_levels");
+	std::string runsName = PagedGrid::MakeWorkFileName(_workDirectory, "extbfs_runs");
+	std::fstream levels(levelsName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	std::fstream runs(runsName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!levels || !runs)
+	{
+		std::cerr << "ExternalBFS: Cannot open work files in " << _workDirectory << "\n";
+		_isFailed = true;
+		levels.close();
+		runs.close();
+		std::remove(levelsName.c_str());
+		std::remove(runsName.c_str());
+		return false;
+	}
+
+	// Level 0 is the start cell
+	// レベル0はスタートのセル
+	WriteRecords(levels, 0, &startIndex, 1);
+	_levelBegin = { 0, 1 };
+	_counters.enqueuedNodes = 1;
+	_counters.peakQueue = 1;
+	bool isFound = (startIndex == endIndex);
+
+	// Half the cap for the run buffer, the rest is left for the merge's blocks
+	// 上限の半分をランのバッファに、残りはマージのブロック用
+	size_t runRecords = std::max<size_t>(kBlockRecords, _memoryCap / 2 / kRecordBytes);
+	std::vector<long long> buffer;
+	buffer.reserve(runRecords);
+	std::vector<long long> runBegin;
+	std::vector<BlockReader> runReaders;
+	std::vector<std::pair<long long, int>> heap;
+	auto isGreater = std::greater<std::pair<long long, int>>();
+	std::vector<long long> levelBlock;
+	levelBlock.reserve(kBlockRecords);
+
+	while (!isFound && !_isFailed)
+	{
+		int level = static_cast<int>(_levelBegin.size()) - 2;
+
+		// Neighbours of the current level into sorted runs
+		// 今のレベルの隣をソート済みのランにする
+		runBegin.assign(1, 0);
+		BlockReader frontier;
+		OpenReader(frontier, levels, _levelBegin[level], _levelBegin[level + 1]);
+		for (; frontier.isValid; Advance(frontier))
+		{
+			long long index = frontier.current;
+			long long x = index % width;
+			_counters.expandedNodes++;
+			auto push = [&](long long nextIndex)
+			{
+				if (grid.IsWall(nextIndex)) return;
+				buffer.push_back(nextIndex);
+				if (buffer.size() == runRecords) SpillRun(runs, buffer, runBegin);
+			};
+
+			// Left, right, up, down
+			// 左、右、上、下
+			if (x > 0) push(index - 1);
+			if (x < width - 1) push(index + 1);
+			if (index >= width) push(index - width);
+			if (index + width < cellCount) push(index + width);
+		}
+		SpillRun(runs, buffer, runBegin);
+
+		// K-way merge of the runs, skipping duplicates and cells of the current and previous level
+		// ランをK-wayマージ、重複と今・前のレベルのセルを飛ばす
+		int runCount = static_cast<int>(runBegin.size()) - 1;
+		runReaders.resize(runCount);
+		heap.clear();
+		for (int run = 0; run < runCount; run++)
+		{
+			OpenReader(runReaders[run], runs, runBegin[run], runBegin[run + 1]);
+			if (runReaders[run].isValid) heap.push_back({ runReaders[run].current, run });
+		}
+		std::make_heap(heap.begin(), heap.end(), isGreater);
+
+		BlockReader current, previous;
+		OpenReader(current, levels, _levelBegin[level], _levelBegin[level + 1]);
+		OpenReader(previous, levels, _levelBegin[std::max(level - 1, 0)], (level > 0) ? _levelBegin[level] : 0);
+
+		long long levelEnd = _levelBegin.back();
+		long long writePosition = levelEnd;
+		long long lastIndex = -1;
+		while (!heap.empty())
+		{
+			std::pop_heap(heap.begin(), heap.end(), isGreater);
+			auto [index, run] = heap.back();
+			heap.pop_back();
+			Advance(runReaders[run]);
+			if (runReaders[run].isValid)
+			{
+				heap.push_back({ runReaders[run].current, run });
+				std::push_heap(heap.begin(), heap.end(), isGreater);
+			}
+
+			if (index == lastIndex) continue;
+			lastIndex = index;
+			while (current.isValid && current.current < index) Advance(current);
+			while (previous.isValid && previous.current < index) Advance(previous);
+			if ((current.isValid && current.current == index) || (previous.isValid && previous.current == index)) continue;
+
+			levelBlock.push_back(index);
+			if (static_cast<long long>(levelBlock.size()) == kBlockRecords)
+			{
+				WriteRecords(levels, writePosition, levelBlock.data(), kBlockRecords);
+				writePosition += kBlockRecords;
+				levelBlock.clear();
+			}
+			if (index == endIndex) isFound = true;
+		}
+		WriteRecords(levels, writePosition, levelBlock.data(), static_cast<long long>(levelBlock.size()));
+		writePosition += static_cast<long long>(levelBlock.size());
+		levelBlock.clear();
+
+		// An empty level means the goal isn't reachable
+		// 空のレベルはゴールに届かないということ
+		if (writePosition == levelEnd) break;
+		_levelBegin.push_back(writePosition);
+		_counters.enqueuedNodes += writePosition - levelEnd;
+		_counters.peakQueue = std::max(_counters.peakQueue, writePosition - levelEnd);
+	}
+
+	// A lost level or run block would give a wrong distance, not a missing path, so nothing is returned
+	// レベルかランのブロックを失うと距離が間違うので何も返さない
+	if (!grid.IsGood()) _isFailed = true;
+	if (_isFailed)
+	{
+		std::cerr << "ExternalBFS: Reading or writing the work files in " << _workDirectory << " failed\n";
+		isFound = false;
+	}
+
+	if (isFound)
+	{
+		// The goal is in the last level, step back through each level before it
+		// ゴールは最後のレベルにある、前のレベルを１つずつ戻る
+		int distance = static_cast<int>(_levelBegin.size()) - 2;
+		path.resize(distance + 1);
+		path[distance] = endIndex;
+		long long cellIndex = endIndex;
+		for (int level = distance - 1; level >= 0; level--)
+		{
+			long long x = cellIndex % width;
+			long long candidates[4] = { -1, -1, -1, -1 };
+			if (x > 0) candidates[0] = cellIndex - 1;
+			if (x < width - 1) candidates[1] = cellIndex + 1;
+			if (cellIndex >= width) candidates[2] = cellIndex - width;
+			if (cellIndex + width < cellCount) candidates[3] = cellIndex + width;
+			for (long long candidate : candidates)
+			{
+				if (candidate == -1 || !LevelContains(levels, level, candidate)) continue;
+				cellIndex = candidate;
+				break;
+			}
+			path[level] = cellIndex;
+		}
+		if (_isFailed)
+		{
+			std::cerr << "ExternalBFS: Reading the level file in " << _workDirectory << " failed\n";
+			path.clear();
+			isFound = false;
+		}
+	}
+
+	levels.close();
+	runs.close();
+	std::remove(levelsName.c_str());
+	std::remove(runsName.c_str());
+	return isFound;
+}
+
+long long ExternalBFS::GetBytesRead() const
+{
+	return _bytesRead;
+}
+
+long long ExternalBFS::GetBytesWritten() const
+{
+	return _bytesWritten;
+}
+
+int ExternalBFS::GetLevelCount() const
+{
+	return std::max(static_cast<int>(_levelBegin.size()) - 1, 0);
+}
+
+long long ExternalBFS::GetVisitedCount() const
+{
+	return _levelBegin.empty() ? 0 : _levelBegin.back();
+}
+
+bool ExternalBFS::IsGood() const
+{
+	return !_isFailed;
+}
+// =======================================
+
+
+// ====== Private ======
+void ExternalBFS::OpenReader(BlockReader& reader, std::fstream& file, long long begin, long long end)
+{
+	reader.file = &file;
+	reader.next = begin;
+	reader.end = end;
+	reader.block.clear();
+	reader.cursor = 0;
+	reader.isValid = false;
+	Advance(reader);
+}
+
+void ExternalBFS::Advance(BlockReader& reader)
+{
+	if (reader.cursor == reader.block.size())
+	{
+		if (reader.next >= reader.end)
+		{
+			reader.isValid = false;
+			return;
+		}
+
+		// Every reader seeks before it reads, so several can share one stream
+		// 読む前に毎回シークするので、複数のリーダーが１つのストリームを使える
+		long long count = std::min(kBlockRecords, reader.end - reader.next);
+		reader.block.resize(count);
+		reader.file->clear();
+		reader.file->seekg(reader.next * kRecordBytes);
+		reader.file->read(reinterpret_cast<char*>(reader.block.data()), count * kRecordBytes);
+		if (reader.file->gcount() != count * kRecordBytes) _isFailed = true;
+		_bytesRead += count * kRecordBytes;
+		reader.next += count;
+		reader.cursor = 0;
+	}
+	reader.current = reader.block[reader.cursor++];
+	reader.isValid = true;
+}
+
+void ExternalBFS::WriteRecords(std::fstream& file, long long position, const long long* records, long long count)
+{
+	if (count == 0) return;
+	file.clear();
+	file.seekp(position * kRecordBytes);
+	file.write(reinterpret_cast<const char*>(records), count * kRecordBytes);
+	if (!file.good()) _isFailed = true;
+	_bytesWritten += count * kRecordBytes;
+}
+
+void ExternalBFS::SpillRun(std::fstream& runs, std::vector<long long>& buffer, std::vector<long long>& runBegin)
+{
+	if (buffer.empty()) return;
+	std::sort(buffer.begin(), buffer.end());
+	buffer.erase(std::unique(buffer.begin(), buffer.end()), buffer.end());
+	WriteRecords(runs, runBegin.back(), buffer.data(), static_cast<long long>(buffer.size()));
+	runBegin.push_back(runBegin.back() + static_cast<long long>(buffer.size()));
+	buffer.clear();
+}
+
+bool ExternalBFS::LevelContains(std::fstream& levels, int level, long long index)
+{
+	// Binary search with one seek per probe, only used for the path walk
+	// 二分探索、１回の比較に１回シーク、パスを戻る時だけ
+	long long low = _levelBegin[level];
+	long long high = _levelBegin[level + 1];
+	while (low < high)
+	{
+		long long middle = low + (high - low) / 2;
+		long long value = 0;
+		levels.clear();
+		levels.seekg(middle * kRecordBytes);
+		levels.read(reinterpret_cast<char*>(&value), kRecordBytes);
+		if (levels.gcount() != kRecordBytes)
+		{
+			_isFailed = true;
+			return false;
+		}
+		_bytesRead += kRecordBytes;
+		if (value == index) return true;
+		if (value < index) low = middle + 1;
+		else high = middle;
+	}
+	return false;
+}
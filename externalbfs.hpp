@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "telemetry.hpp"
+
+class PagedGrid;
+
+/*
+	External-memory BFS over a PagedGrid (Munagala-Ranade)
+	No queue, visited or parent array is kept in memory: every BFS level is a sorted file segment,
+	the next level is the sorted, de-duplicated neighbours of the current one minus the current and
+	previous levels (an undirected graph can't step back further than that)
+	Neighbours are collected into sorted runs of at most half the memory cap, spilled and merged
+	The path is walked back from the goal by looking each neighbour up in the level before it
+	外部メモリBFS、キューも訪問済みも親の配列もメモリに持たない
+	各レベルはソート済みのファイルの区間、次のレベルは今のレベルの隣から今と前のレベルを引いたもの
+*/
+
+class ExternalBFS
+{
+public:
+	ExternalBFS(void);
+	~ExternalBFS(void);
+
+	// Directory for the level and run files (removed again after each Solve)
+	// The names get the process id and a counter, so several runs can share one directory
+	// レベルとランのファイルを置くディレクトリ（Solveの後に消す）、名前にプロセスIDとカウンターを付ける
+	void SetWorkDirectory(const std::string& directory);
+	void SetMemoryCap(size_t memoryCap);
+
+	// Shortest path by steps, false if a cell is a wall / out of range, the goal is unreachable,
+	// the work files can't be opened or written (disk full, ...) or the grid has failed a chunk read / write
+	// 最短経路（歩数）、壁・範囲外・到達できない・ファイルが開けない・書けない時はfalse
+	bool Solve(PagedGrid& grid, long long startIndex, long long endIndex, std::vector<long long>& path);
+
+	long long GetBytesRead(void) const;
+	long long GetBytesWritten(void) const;
+	int GetLevelCount(void) const;
+	long long GetVisitedCount(void) const;
+	// False if the last Solve failed on file I/O rather than finding no path
+	// 最後のSolveが経路なしではなくファイルのI/Oで失敗した時はfalse
+	bool IsGood(void) const;
+
+private:
+	static constexpr long long kBlockRecords = 4096;
+	static constexpr long long kRecordBytes = sizeof(long long);
+
+	// Sequential reader over records [next, end) of a file, current is valid while isValid
+	// ファイルのレコード[next, end)を順番に読む
+	typedef struct BlockReader
+	{
+		std::fstream* file;
+		long long next;
+		long long end;
+		std::vector<long long> block;
+		size_t cursor;
+		long long current;
+		bool isValid;
+	};
+
+	void OpenReader(BlockReader& reader, std::fstream& file, long long begin, long long end);
+	void Advance(BlockReader& reader);
+	void WriteRecords(std::fstream& file, long long position, const long long* records, long long count);
+	// Sorts, de-duplicates and appends the buffer to the run file
+	// バッファをソートして重複を消し、ランのファイルに足す
+	void SpillRun(std::fstream& runs, std::vector<long long>& buffer, std::vector<long long>& runBegin);
+	bool LevelContains(std::fstream& levels, int level, long long index);
+
+	std::string _workDirectory = ".";
+	size_t _memoryCap = 64 * 1024 * 1024;
+
+	std::vector<long long> _levelBegin;		// record offset of every level in the level file, plus the end
+	SearchCounters _counters;				// the queue is the level file, peakQueue is the largest level
+	long long _bytesRead = 0;
+	long long _bytesWritten = 0;
+	bool _isFailed = false;					// a level / run file read or write failed during this Solve
+};
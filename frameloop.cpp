@@ -0,0 +1,169 @@
+﻿#include "frameloop.hpp"
+
+#include <algorithm>
+
+
+// ======= Public ==========
+FrameLoop::FrameLoop()
+{}
+
+FrameLoop::~FrameLoop()
+{}
+
+void FrameLoop::SetConfig(const FrameLoopConfig& config)
+{
+	_config = config;
+	_config.updateHz = std::max(config.updateHz, 1.0);
+	_config.renderHz = std::max(config.renderHz, 0.0);
+	_config.maxUpdatesPerStep = std::max(config.maxUpdatesPerStep, 1);
+}
+
+const FrameLoopConfig& FrameLoop::GetConfig(void) const
+{
+	return _config;
+}
+
+void FrameLoop::SetIsUncapped(bool isUncapped)
+{
+	_isUncapped = isUncapped;
+}
+
+bool FrameLoop::GetIsUncapped(void) const
+{
+	return _isUncapped;
+}
+
+void FrameLoop::SetUpdate(UpdateFunction update)
+{
+	_update = std::move(update);
+}
+
+void FrameLoop::SetRender(RenderFunction render)
+{
+	_render = std::move(render);
+}
+
+void FrameLoop::SetPresent(PresentFunction present)
+{
+	_present = std::move(present);
+}
+
+FrameStepResult FrameLoop::Step(int64_t nowNs)
+{
+	FrameStepResult result;
+	if (!_isStarted)
+	{
+		_isStarted = true;
+		_lastNs = nowNs;
+		_nextRenderNs = nowNs;
+		_windowStartNs = nowNs;
+	}
+
+	_accumulatorNs += std::clamp<int64_t>(nowNs - _lastNs, 0, kMaxStepNs);
+	_lastNs = nowNs;
+
+	// Fixed updates, as many as the accumulator holds
+	// 固定の更新、アキュムレータに入るだけ
+	int64_t stepNs = GetStepNs();
+	double stepSeconds = 1.0 / _config.updateHz;
+	while (_accumulatorNs >= stepNs && result.updates < _config.maxUpdatesPerStep)
+	{
+		if (_update) _update(stepSeconds);
+		_accumulatorNs -= stepNs;
+		result.updates++;
+	}
+	if (_accumulatorNs >= stepNs)
+	{
+		_droppedUpdates += _accumulatorNs / stepNs;
+		_accumulatorNs %= stepNs;
+	}
+	_updateCount += result.updates;
+	_windowUpdates += result.updates;
+
+	// Render when the interval has passed, a late frame doesn't make the next ones bunch up
+	// 間隔が過ぎたら描画する、遅れたフレームの後に詰めて描画しない
+	int64_t intervalNs = GetRenderIntervalNs();
+	result.alpha = static_cast<double>(_accumulatorNs) / stepNs;
+	if (intervalNs == 0 || nowNs >= _nextRenderNs)
+	{
+		if (_render) _render(result.alpha);
+		if (_present) _present(_config.isVsync && !_isUncapped);
+		result.isRendered = true;
+		_renderCount++;
+		_windowRenders++;
+		_nextRenderNs = std::max(_nextRenderNs + intervalNs, nowNs);
+	}
+
+	if (nowNs - _windowStartNs >= kRateWindowNs)
+	{
+		double windowSeconds = (nowNs - _windowStartNs) / 1e9;
+		_updateRate = _windowUpdates / windowSeconds;
+		_renderRate = _windowRenders / windowSeconds;
+		_windowStartNs = nowNs;
+		_windowUpdates = 0;
+		_windowRenders = 0;
+	}
+	return result;
+}
+
+int64_t FrameLoop::GetIdleNs(int64_t nowNs) const
+{
+	if (_isUncapped || !_isStarted) return 0;
+
+	int64_t untilUpdate = GetStepNs() - _accumulatorNs - (nowNs - _lastNs);
+	int64_t intervalNs = GetRenderIntervalNs();
+	int64_t untilRender = (intervalNs == 0) ? 0 : _nextRenderNs - nowNs;
+	return std::max<int64_t>(0, std::min(untilUpdate, untilRender));
+}
+
+double FrameLoop::GetUpdateRate(void) const
+{
+	return _updateRate;
+}
+
+double FrameLoop::GetRenderRate(void) const
+{
+	return _renderRate;
+}
+
+long long FrameLoop::GetUpdateCount(void) const
+{
+	return _updateCount;
+}
+
+long long FrameLoop::GetRenderCount(void) const
+{
+	return _renderCount;
+}
+
+long long FrameLoop::GetDroppedUpdates(void) const
+{
+	return _droppedUpdates;
+}
+
+void FrameLoop::Reset(void)
+{
+	_isStarted = false;
+	_accumulatorNs = 0;
+	_updateCount = 0;
+	_renderCount = 0;
+	_droppedUpdates = 0;
+	_windowUpdates = 0;
+	_windowRenders = 0;
+	_updateRate = 0.0;
+	_renderRate = 0.0;
+}
+// =======================================
+
+
+// ====== Private ======
+int64_t FrameLoop::GetStepNs(void) const
+{
+	return static_cast<int64_t>(1e9 / _config.updateHz + 0.5);
+}
+
+int64_t FrameLoop::GetRenderIntervalNs(void) const
+{
+	if (_isUncapped || _config.renderHz <= 0.0) return 0;
+	return static_cast<int64_t>(1e9 / _config.renderHz + 0.5);
+}
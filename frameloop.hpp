@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+
+/*
+	Fixed-timestep frame loop (headless, no DirectX / SDL)
+	Every Step adds the real time since the last one to an accumulator and runs as many fixed updates as
+	it holds, then renders if the render interval has passed (or on every Step when the rate is uncapped).
+	Render gets alpha, how far the accumulator is into the next update, to interpolate between the last
+	two update states. Updates run at the same rate whatever the display does, and a vsync'd present only
+	limits the render rate. The present callback may be empty (null presenter) so the loop runs headless
+	固定タイムステップのフレームループ（ヘッドレス）
+	Stepごとに経過時間をアキュムレータに足して、入るだけ固定の更新を実行し、描画の間隔が過ぎていれば描画する
+	描画は次の更新までの割合alphaを受け取って補間できる。presentは空でもいい（ヌルプレゼンター）
+*/
+
+typedef struct FrameLoopConfig
+{
+	double updateHz = 60.0;
+	double renderHz = 0.0;			// 0 renders on every Step (paced by vsync if the presenter waits for it)
+	bool isVsync = true;			// Passed to the presenter
+	int maxUpdatesPerStep = 8;		// Past this the backlog is dropped instead of spiralling
+};
+
+// What one Step did
+// １回のStepでしたこと
+typedef struct FrameStepResult
+{
+	int updates = 0;
+	bool isRendered = false;
+	double alpha = 0.0;
+};
+
+class FrameLoop
+{
+public:
+	using UpdateFunction = std::function<void(double stepSeconds)>;
+	using RenderFunction = std::function<void(double alpha)>;
+	using PresentFunction = std::function<void(bool isVsync)>;
+
+	FrameLoop(void);
+	~FrameLoop(void);
+
+	void SetConfig(const FrameLoopConfig& config);
+	const FrameLoopConfig& GetConfig(void) const;
+	// Benchmark mode: no vsync, no render cap, the caller shouldn't sleep either
+	// ベンチマークモード：vsyncなし、描画の上限なし、呼び出し側も寝ない
+	void SetIsUncapped(bool isUncapped);
+	bool GetIsUncapped(void) const;
+
+	void SetUpdate(UpdateFunction update);
+	void SetRender(RenderFunction render);
+	void SetPresent(PresentFunction present);
+
+	// One pass of the loop at nowNs (any monotonic nanosecond clock, so tests can feed their own)
+	// nowNs（単調なナノ秒の時計）でループを１回進める、テストは自分の時計を渡せる
+	FrameStepResult Step(int64_t nowNs);
+	// Until the next update or render is due, 0 if one is due now or the loop is uncapped
+	// 次の更新か描画までの時間、今すぐなら（または上限なしなら）0
+	int64_t GetIdleNs(int64_t nowNs) const;
+
+	// Measured over a rolling half-second window
+	// 0.5秒の移動ウィンドウで測る
+	double GetUpdateRate(void) const;
+	double GetRenderRate(void) const;
+	long long GetUpdateCount(void) const;
+	long long GetRenderCount(void) const;
+	long long GetDroppedUpdates(void) const;
+
+	// Back to the first Step, counters included
+	// 最初のStepの前に戻す、カウンターも
+	void Reset(void);
+
+private:
+	static constexpr int64_t kRateWindowNs = 500000000;
+	static constexpr int64_t kMaxStepNs = 250000000;	// A longer hitch (breakpoint, drag) counts as 250 ms
+
+	FrameLoopConfig _config;
+	bool _isUncapped = false;
+	UpdateFunction _update;
+	RenderFunction _render;
+	PresentFunction _present;
+
+	bool _isStarted = false;
+	int64_t _lastNs = 0;
+	int64_t _accumulatorNs = 0;
+	int64_t _nextRenderNs = 0;
+
+	long long _updateCount = 0;
+	long long _renderCount = 0;
+	long long _droppedUpdates = 0;
+
+	int64_t _windowStartNs = 0;
+	long long _windowUpdates = 0;
+	long long _windowRenders = 0;
+	double _updateRate = 0.0;
+	double _renderRate = 0.0;
+
+	int64_t GetStepNs(void) const;
+	int64_t GetRenderIntervalNs(void) const;
+};
@@ -0,0 +1,536 @@
+﻿#include "jobsystem.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+
+// = Job pool =
+// = ジョブのプール =
+// std::allocate_shared asks for one block of a single size (control block + Job), the pool carves them
+// out of slabs of kSlabBlocks and chains the freed ones through their first bytes, any other size goes
+// to operator new. A slab at a time leaves room for the job a worker is still letting go of when the
+// next ParallelFor starts
+// allocate_sharedは１つのサイズのブロックを求める（制御ブロック＋Job）、スラブから切り出して空いたものは先頭でつなぐ
+class JobPool
+{
+public:
+	~JobPool(void)
+	{
+		while (_slabs != nullptr)
+		{
+			FreeBlock* next = _slabs->next;
+			::operator delete(_slabs);
+			_slabs = next;
+		}
+	}
+
+	void* Allocate(size_t bytes)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_blockBytes == 0) _blockBytes = RoundUp(bytes);
+		if (RoundUp(bytes) != _blockBytes) return ::operator new(bytes);
+		if (_freeBlocks == nullptr)
+		{
+			// The slab's first block only links the slabs together
+			// スラブの最初のブロックはスラブをつなぐだけ
+			char* slab = static_cast<char*>(::operator new(_blockBytes * (kSlabBlocks + 1)));
+			FreeBlock* slabHead = reinterpret_cast<FreeBlock*>(slab);
+			slabHead->next = _slabs;
+			_slabs = slabHead;
+			for (int i = kSlabBlocks; i >= 1; i--)
+			{
+				FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + _blockBytes * i);
+				block->next = _freeBlocks;
+				_freeBlocks = block;
+			}
+		}
+		FreeBlock* block = _freeBlocks;
+		_freeBlocks = block->next;
+		return block;
+	}
+
+	void Deallocate(void* block, size_t bytes)
+	{
+		if (RoundUp(bytes) != _blockBytes)
+		{
+			::operator delete(block);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(_mutex);
+		FreeBlock* freed = static_cast<FreeBlock*>(block);
+		freed->next = _freeBlocks;
+		_freeBlocks = freed;
+	}
+
+private:
+	static constexpr int kSlabBlocks = 64;
+
+	typedef struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	static size_t RoundUp(size_t bytes)
+	{
+		constexpr size_t align = alignof(std::max_align_t);
+		return (std::max(bytes, sizeof(FreeBlock)) + align - 1) & ~(align - 1);
+	}
+
+	std::mutex _mutex;
+	FreeBlock* _freeBlocks = nullptr;
+	FreeBlock* _slabs = nullptr;
+	size_t _blockBytes = 0;		// set by the first Allocate, only read after that
+};
+
+template<typename T>
+class JobAllocator
+{
+public:
+	using value_type = T;
+
+	explicit JobAllocator(std::shared_ptr<JobPool> pool) : _pool(std::move(pool)) {}
+	template<typename U>
+	JobAllocator(const JobAllocator<U>& other) : _pool(other._pool) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(_pool->Allocate(count * sizeof(T)));
+	}
+
+	void deallocate(T* block, size_t count)
+	{
+		_pool->Deallocate(block, count * sizeof(T));
+	}
+
+	template<typename U>
+	bool operator==(const JobAllocator<U>& other) const
+	{
+		return _pool == other._pool;
+	}
+
+private:
+	template<typename U>
+	friend class JobAllocator;
+
+	std::shared_ptr<JobPool> _pool;
+};
+
+
+// = Per-thread worker identity =
+// = スレッドごとのワーカー情報 =
+static thread_local const JobSystem* tJobSystem = nullptr;
+static thread_local int tWorkerIndex = -1;
+static thread_local uint32_t tStealSeed = 0x9E3779B9u;
+
+
+// ======= Job ==========
+Job::Job()
+{}
+
+Job::~Job()
+{}
+// =======================================
+
+
+// ======= WorkStealingDeque ==========
+// Chase-Lev deque with the C11 memory orderings from Le et al. 2013
+// Le et al. 2013のC11メモリオーダーのChase-Levデック
+WorkStealingDeque::WorkStealingDeque(int capacity)
+{
+	_mask = capacity - 1;
+	_buffer = std::make_unique<std::atomic<Job*>[]>(capacity);
+}
+
+WorkStealingDeque::~WorkStealingDeque()
+{}
+
+bool WorkStealingDeque::Push(Job* job)
+{
+	int64_t bottom = _bottom.load(std::memory_order_relaxed);
+	int64_t top = _top.load(std::memory_order_acquire);
+	if (bottom - top > _mask) return false;
+
+	// Release store publishes the job to the thieves
+	// リリースストアで泥棒にジョブを公開する
+	_buffer[bottom & _mask].store(job, std::memory_order_relaxed);
+	_bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job* WorkStealingDeque::Pop(void)
+{
+	int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+	_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = _top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// Empty
+		// 空
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = _buffer[bottom & _mask].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		// 最後のジョブ、泥棒と競争する
+		if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* WorkStealingDeque::Steal(void)
+{
+	int64_t top = _top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = _bottom.load(std::memory_order_acquire);
+	if (top >= bottom) return nullptr;
+
+	Job* job = _buffer[top & _mask].load(std::memory_order_relaxed);
+	if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+// =======================================
+
+
+// ======= JobSystem Public ==========
+JobSystem::JobSystem(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+	_jobPool = std::make_shared<JobPool>();
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		_deques.push_back(std::make_unique<WorkStealingDeque>(kDequeCapacity));
+	}
+	for (int i = 0; i < workerCount; i++)
+	{
+		_workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_isStopping = true;
+	}
+	_sleepCondition.notify_all();
+
+	for (auto& worker : _workers)
+	{
+		worker.join();
+	}
+}
+
+JobHandle JobSystem::Submit(std::function<void(void)> work, const std::vector<JobHandle>& dependencies)
+{
+	JobHandle job = CreateJob(std::move(work), nullptr);
+	AddDependencies(job.get(), dependencies);
+	return job;
+}
+
+JobHandle JobSystem::ParallelForAsync(int count, int grainSize, std::function<void(int, int)> body,
+	const std::vector<JobHandle>& dependencies)
+{
+	return StartRange(count, grainSize, nullptr, &InvokeRange<std::function<void(int, int)>>, &body, dependencies);
+}
+
+void JobSystem::Wait(const JobHandle& job)
+{
+	// Only workers pick up queued jobs, another thread could end up inside a long one such as a background
+	// maze search. ParallelFor's caller helps with its own chunks instead, see WaitRange
+	// キューのジョブを取るのはワーカーだけ、他のスレッドだと裏の迷路探索のような長いジョブに入るかもしれない
+	// ParallelForの呼び出し側は代わりに自分のチャンクを手伝う、WaitRangeを参照
+	bool isWorker = GetCurrentWorkerIndex() >= 0;
+	while (!IsDone(job))
+	{
+		Job* other = isWorker ? FindJob() : nullptr;
+		if (other != nullptr)
+		{
+			Execute(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::IsDone(const JobHandle& job) const
+{
+	return !job || job->_unfinished.load(std::memory_order_acquire) == 0;
+}
+
+int JobSystem::GetWorkerCount(void) const
+{
+	return static_cast<int>(_workers.size());
+}
+// =======================================
+
+
+// ======= JobSystem Private ==========
+JobHandle JobSystem::StartRange(int count, int grainSize, void* body, JobRangeFunction run,
+	std::function<void(int, int)>* ownedBody, const std::vector<JobHandle>& dependencies)
+{
+	// The root job spawns one child per chunk, so it only finishes after all of them
+	// ルートジョブがチャンクごとに子を作るので、全部終わってから完了する
+	JobHandle root = CreateJob(nullptr, nullptr);
+	Job* rootJob = root.get();
+	if (ownedBody != nullptr)
+	{
+		rootJob->_ownedBody = std::move(*ownedBody);
+		body = &rootJob->_ownedBody;
+	}
+	rootJob->_rangeBody = body;
+	rootJob->_runRange = run;
+	rootJob->_rangeCount = std::max(0, count);
+	rootJob->_grainSize = std::max(1, grainSize);
+	rootJob->_chunkCount = static_cast<int>((static_cast<int64_t>(rootJob->_rangeCount) + rootJob->_grainSize - 1) / rootJob->_grainSize);
+	rootJob->_pendingChunks.store(rootJob->_chunkCount, std::memory_order_relaxed);
+	AddDependencies(rootJob, dependencies);
+	return root;
+}
+
+void JobSystem::SpawnRange(Job* root)
+{
+	// No more helpers than chunks left, none at all when the caller of ParallelFor already took them
+	// 残りのチャンクより多くのヘルパーは作らない、ParallelForの呼び出し側が全部取っていれば作らない
+	int remaining = root->_chunkCount - std::min(root->_chunkCount, root->_nextChunk.load(std::memory_order_relaxed));
+	int helpers = std::min(remaining, GetWorkerCount());
+	for (int i = 0; i < helpers; i++)
+	{
+		JobHandle helper = CreateJob(nullptr, root);
+		AddDependencies(helper.get(), {});
+	}
+}
+
+void JobSystem::RunChunks(Job* root)
+{
+	// The body is only touched after a chunk is claimed, so a helper that comes late never sees
+	// the body of a ParallelFor that has already returned
+	// bodyに触るのはチャンクを取った後だけ、遅れたヘルパーが戻った後のParallelForのbodyを見ることはない
+	for (int chunk = root->_nextChunk.fetch_add(1, std::memory_order_relaxed); chunk < root->_chunkCount;
+		chunk = root->_nextChunk.fetch_add(1, std::memory_order_relaxed))
+	{
+		int begin = chunk * root->_grainSize;
+		int end = std::min(root->_rangeCount, begin + root->_grainSize);
+		root->_runRange(root->_rangeBody, begin, end);
+		root->_pendingChunks.fetch_sub(1, std::memory_order_acq_rel);
+	}
+}
+
+void JobSystem::WaitRange(Job* root)
+{
+	RunChunks(root);
+
+	// Every chunk is claimed, wait for the ones still running on the workers
+	// 全てのチャンクは取られた、ワーカーでまだ実行中のものを待つ
+	bool isWorker = GetCurrentWorkerIndex() >= 0;
+	while (root->_pendingChunks.load(std::memory_order_acquire) != 0)
+	{
+		Job* other = isWorker ? FindJob() : nullptr;
+		if (other != nullptr)
+		{
+			Execute(other);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+JobHandle JobSystem::CreateJob(std::function<void(void)> work, Job* parent)
+{
+	JobHandle job = std::allocate_shared<Job>(JobAllocator<Job>(_jobPool));
+	job->_work = std::move(work);
+	job->_parent = parent;
+	job->_keepAlive = job;
+	if (parent != nullptr)
+	{
+		parent->_unfinished.fetch_add(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::AddDependencies(Job* job, const std::vector<JobHandle>& dependencies)
+{
+	for (const auto& dependency : dependencies)
+	{
+		if (!dependency) continue;
+
+		// Register as a continuation unless the dependency already finished
+		// 依存がまだ終わっていなければ継続として登録する
+		std::lock_guard<std::mutex> lock(dependency->_continuationMutex);
+		if (!dependency->_isFinished)
+		{
+			job->_dependencies.fetch_add(1, std::memory_order_relaxed);
+			dependency->_continuations.push_back(job);
+		}
+	}
+
+	// Drop the initial guard count, schedules right away if nothing is pending
+	// 最初のガードを外す、何も待っていなければすぐにスケジュールする
+	if (job->_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		Schedule(job);
+	}
+}
+
+void JobSystem::Schedule(Job* job)
+{
+	int workerIndex = GetCurrentWorkerIndex();
+	if (workerIndex < 0 || !_deques[workerIndex]->Push(job))
+	{
+		std::lock_guard<std::mutex> lock(_injectionMutex);
+		_injectionQueue.push_back(job);
+	}
+
+	_queuedJobs.fetch_add(1, std::memory_order_seq_cst);
+	if (_sleepingWorkers.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_sleepCondition.notify_one();
+	}
+}
+
+Job* JobSystem::FindJob(void)
+{
+	Job* job = nullptr;
+	int workerIndex = GetCurrentWorkerIndex();
+
+	// 1. Own deque
+	// 1. 自分のデック
+	if (workerIndex >= 0)
+	{
+		job = _deques[workerIndex]->Pop();
+	}
+
+	// 2. Injection queue
+	// 2. インジェクションキュー
+	if (job == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(_injectionMutex);
+		if (_injectionHead < _injectionQueue.size())
+		{
+			job = _injectionQueue[_injectionHead++];
+			if (_injectionHead == _injectionQueue.size())
+			{
+				_injectionQueue.clear();
+				_injectionHead = 0;
+			}
+		}
+	}
+
+	// 3. Steal, starting from a random victim
+	// 3. ランダムな相手から盗む
+	if (job == nullptr)
+	{
+		int nDeques = static_cast<int>(_deques.size());
+		tStealSeed ^= tStealSeed << 13;
+		tStealSeed ^= tStealSeed >> 17;
+		tStealSeed ^= tStealSeed << 5;
+		int start = static_cast<int>(tStealSeed % nDeques);
+		for (int i = 0; i < nDeques && job == nullptr; i++)
+		{
+			int victim = (start + i) % nDeques;
+			if (victim != workerIndex) job = _deques[victim]->Steal();
+		}
+	}
+
+	if (job != nullptr)
+	{
+		_queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+	if (job->_work) job->_work();
+	else if (job->_rangeBody != nullptr) SpawnRange(job);
+	else if (job->_parent != nullptr) RunChunks(job->_parent);
+	Finish(job);
+}
+
+void JobSystem::Finish(Job* job)
+{
+	if (job->_unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+	// Last one out, release the continuations and tell the parent
+	// 最後なので、継続を解放して親に知らせる
+	std::vector<Job*> continuations;
+	{
+		std::lock_guard<std::mutex> lock(job->_continuationMutex);
+		job->_isFinished = true;
+		continuations.swap(job->_continuations);
+	}
+	for (Job* continuation : continuations)
+	{
+		if (continuation->_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Schedule(continuation);
+		}
+	}
+
+	Job* parent = job->_parent;
+	job->_work = nullptr;
+	job->_ownedBody = nullptr;
+
+	// May delete the job, so nothing touches it after this
+	// ジョブが消えるかもしれないので、この後は触らない
+	std::shared_ptr<Job> keepAlive = std::move(job->_keepAlive);
+	keepAlive.reset();
+
+	if (parent != nullptr) Finish(parent);
+}
+
+void JobSystem::WorkerLoop(int workerIndex)
+{
+	tJobSystem = this;
+	tWorkerIndex = workerIndex;
+	tStealSeed = 0x9E3779B9u * (workerIndex + 1);
+	Profiler::GetInstance().NameThread("job worker");
+
+	while (!_isStopping.load(std::memory_order_relaxed))
+	{
+		Job* job = FindJob();
+		if (job != nullptr)
+		{
+			Execute(job);
+			continue;
+		}
+
+		// Nothing to do, sleep until something gets scheduled
+		// 何もないので、スケジュールされるまで寝る
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+		_sleepCondition.wait(lock, [this]()
+		{
+			return _queuedJobs.load(std::memory_order_seq_cst) > 0 || _isStopping.load(std::memory_order_relaxed);
+		});
+		_sleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
+
+int JobSystem::GetCurrentWorkerIndex(void) const
+{
+	return (tJobSystem == this) ? tWorkerIndex : -1;
+}
+// =======================================
@@ -0,0 +1,190 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+	Work-stealing job system
+	Every worker owns a lock-free Chase-Lev deque: it pushes/pops its own jobs at the bottom,
+	idle workers steal from the top of someone else's. Threads that are not workers submit
+	through a small locked injection queue.
+	Jobs come from a pool of recycled blocks and ParallelFor calls the caller's body in place,
+	so a warmed-up ParallelFor never reaches operator new.
+	The calling thread of ParallelFor claims chunks alongside the workers, so the call finishes
+	even when every worker is busy with something long.
+	ワークスティーリングのジョブシステム
+	ワーカーごとにロックフリーのChase-Levデックを持ち、暇なワーカーは他のデックから盗む
+	ジョブはプールから取り、ParallelForは呼び出し側のbodyをそのまま呼ぶので、温めた後はアロケーションなし
+	ParallelForを呼んだスレッドもワーカーと一緒にチャンクを取るので、ワーカーが全部忙しくても終わる
+*/
+
+class JobSystem;
+class JobPool;
+
+// Calls the body of a range job on [begin, end)
+// 範囲ジョブのbodyを[begin, end)で呼ぶ
+using JobRangeFunction = void (*)(void* body, int begin, int end);
+
+class Job 
+{
+public:
+	Job(void);
+	~Job(void);
+
+private:
+	friend class JobSystem;
+
+	std::function<void(void)> _work;
+	Job* _parent = nullptr;
+
+	// Range jobs of ParallelFor: the root (grainSize > 0) spawns up to one helper per worker, and the
+	// helpers claim chunks from the root's _nextChunk until none are left. The body is the caller's own
+	// for ParallelFor, which waits, or _ownedBody for the async one
+	// ParallelForの範囲ジョブ：ルート（grainSize > 0）がワーカーごとに最大１つのヘルパーを作り、
+	// ヘルパーはルートの_nextChunkからチャンクがなくなるまで取る
+	void* _rangeBody = nullptr;
+	JobRangeFunction _runRange = nullptr;
+	int _rangeCount = 0;
+	int _grainSize = 0;
+	int _chunkCount = 0;
+	std::atomic<int> _nextChunk = 0;
+	std::atomic<int> _pendingChunks = 0;
+	std::function<void(int, int)> _ownedBody;
+
+	// Itself + children still running, the job is done when this hits 0
+	// 自分＋実行中の子、0になったら完了
+	std::atomic<int> _unfinished = 1;
+
+	// Dependencies that have not finished yet, the job is scheduled when this hits 0
+	// まだ終わっていない依存、0になったらスケジュールする
+	std::atomic<int> _dependencies = 1;
+
+	std::mutex _continuationMutex;
+	std::vector<Job*> _continuations;
+	bool _isFinished = false;
+
+	// Keeps the job alive while it is queued or running
+	// キューにある間、実行中の間はジョブを生かしておく
+	std::shared_ptr<Job> _keepAlive;
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+class WorkStealingDeque 
+{
+public:
+	explicit WorkStealingDeque(int capacity);
+	~WorkStealingDeque(void);
+
+	// Owner only
+	// オーナーだけ
+	bool Push(Job* job);
+	Job* Pop(void);
+
+	// Any thread
+	// どのスレッドでも
+	Job* Steal(void);
+
+private:
+	std::atomic<int64_t> _top = 0;
+	std::atomic<int64_t> _bottom = 0;
+	int64_t _mask;
+	std::unique_ptr<std::atomic<Job*>[]> _buffer;
+};
+
+class JobSystem 
+{
+public:
+	// workerCount <= 0 uses one worker per hardware thread
+	// workerCount <= 0 ならハードウェアスレッドごとに１つ
+	explicit JobSystem(int workerCount = 0);
+	~JobSystem(void);
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Runs work once every dependency has finished
+	// 全ての依存が終わったらworkを実行する
+	JobHandle Submit(std::function<void(void)> work, const std::vector<JobHandle>& dependencies = {});
+
+	// Splits [0, count) into chunks of grainSize and runs body(begin, end) on the workers
+	// The returned job finishes when every chunk has finished
+	// [0, count)をgrainSizeのチャンクに分けて、ワーカーでbody(begin, end)を実行する
+	JobHandle ParallelForAsync(int count, int grainSize, std::function<void(int, int)> body,
+		const std::vector<JobHandle>& dependencies = {});
+
+	// Blocks until every chunk is done, so body is called where it is instead of being copied into a job
+	// The caller runs chunks too, it returns without waiting for the root job to reach a worker
+	// 全てのチャンクが終わるまで待つので、bodyはジョブにコピーせずにそのまま呼ぶ
+	// 呼び出し側もチャンクを実行する、ルートジョブがワーカーに届くのは待たない
+	template<typename Body>
+	void ParallelFor(int count, int grainSize, Body&& body)
+	{
+		using BodyType = std::remove_reference_t<Body>;
+		void* bodyAddress = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+		JobHandle root = StartRange(count, grainSize, bodyAddress, &InvokeRange<BodyType>, nullptr, {});
+		WaitRange(root.get());
+	}
+
+	// Blocks until the job is done, a worker calling this runs other jobs in the meantime
+	// Other threads only yield, they never pick up a job that might run for as long as a maze search
+	// ジョブが終わるまで待つ、ワーカーならその間に他のジョブを実行する
+	// 他のスレッドは譲るだけ、迷路の探索ほど長いかもしれないジョブは取らない
+	void Wait(const JobHandle& job);
+	bool IsDone(const JobHandle& job) const;
+
+	int GetWorkerCount(void) const;
+
+private:
+	static constexpr int kDequeCapacity = 4096;
+
+	template<typename Body>
+	static void InvokeRange(void* body, int begin, int end)
+	{
+		(*static_cast<Body*>(body))(begin, end);
+	}
+
+	// Root job of a ParallelFor, ownedBody is moved into it when the body has to outlive the call
+	// ParallelForのルートジョブ、呼び出しより長く生きるbodyはownedBodyとしてジョブに移す
+	JobHandle StartRange(int count, int grainSize, void* body, JobRangeFunction run,
+		std::function<void(int, int)>* ownedBody, const std::vector<JobHandle>& dependencies);
+	void SpawnRange(Job* root);
+	void RunChunks(Job* root);
+	void WaitRange(Job* root);
+	JobHandle CreateJob(std::function<void(void)> work, Job* parent);
+	void AddDependencies(Job* job, const std::vector<JobHandle>& dependencies);
+	void Schedule(Job* job);
+	Job* FindJob(void);
+	void Execute(Job* job);
+	void Finish(Job* job);
+	void WorkerLoop(int workerIndex);
+	int GetCurrentWorkerIndex(void) const;
+
+	// Recycled blocks for the jobs and their shared_ptr control blocks, shared with every handle's
+	// allocator so a handle kept past the JobSystem can still give its block back
+	// ジョブと制御ブロックの再利用するブロック、JobSystemより長く残るハンドルのためにアロケーターと共有する
+	std::shared_ptr<JobPool> _jobPool;
+
+	std::vector<std::unique_ptr<WorkStealingDeque>> _deques;
+	std::vector<std::thread> _workers;
+
+	// Jobs submitted from threads that are not workers, popped from _injectionHead
+	// The vector is only cleared once it drains, so it keeps its capacity (a deque frees its blocks as it goes)
+	// ワーカーではないスレッドからのジョブ、空になった時だけクリアするので容量が残る
+	std::mutex _injectionMutex;
+	std::vector<Job*> _injectionQueue;
+	size_t _injectionHead = 0;
+
+	std::atomic<int> _queuedJobs = 0;
+	std::atomic<int> _sleepingWorkers = 0;
+	std::atomic<bool> _isStopping = false;
+	std::mutex _sleepMutex;
+	std::condition_variable _sleepCondition;
+};
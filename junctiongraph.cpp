@@ -0,0 +1,457 @@
+﻿#include "junctiongraph.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <functional>
+
+
+// ======= Public ==========
+JunctionGraph::JunctionGraph()
+{}
+
+JunctionGraph::~JunctionGraph()
+{}
+
+void JunctionGraph::Build(const Maze& maze)
+{
+	PROFILE_SCOPE("JunctionGraph::Build");
+	auto startTime = std::chrono::steady_clock::now();
+
+	Clear();
+	_gridWidth = maze.GetGridWidth();
+	_gridHeight = maze.GetGridHeight();
+	int cellCount = maze.GetCellCount();
+
+	_cost.resize(cellCount);
+	for (int i = 0; i < cellCount; i++)
+	{
+		_cost[i] = maze.GetCost(i);
+		_openCells += _cost[i] != kWallCost;
+	}
+
+	auto forEachOpenNeighbour = [this](int index, auto&& body)
+	{
+		int x = index % _gridWidth;
+		int y = index / _gridWidth;
+		if (x > 0 && _cost[index - 1] != kWallCost) body(index - 1);
+		if (x < _gridWidth - 1 && _cost[index + 1] != kWallCost) body(index + 1);
+		if (y > 0 && _cost[index - _gridWidth] != kWallCost) body(index - _gridWidth);
+		if (y < _gridHeight - 1 && _cost[index + _gridWidth] != kWallCost) body(index + _gridWidth);
+	};
+
+	// == Dead-end filling: peel cells with at most one open neighbour left until none remain ==
+	// The neighbour still open when a cell is peeled becomes its tree parent
+	// == 行き止まり埋め：開いた隣が１つ以下のセルを無くなるまで剥がす、その時の隣が木の親 ==
+	std::vector<int> degree(cellCount, 0);
+	std::vector<int> queue;
+	_isCore.assign(cellCount, 0);
+	_treeParent.assign(cellCount, -1);
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (_cost[i] == kWallCost) continue;
+		_isCore[i] = 1;
+		forEachOpenNeighbour(i, [&](int) { degree[i]++; });
+		if (degree[i] <= 1) queue.push_back(i);
+	}
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int currIndex = queue[head];
+		if (!_isCore[currIndex]) continue;
+		_isCore[currIndex] = 0;
+
+		forEachOpenNeighbour(currIndex, [&](int nextIndex)
+		{
+			if (!_isCore[nextIndex]) return;
+			_treeParent[currIndex] = nextIndex;
+			if (--degree[nextIndex] == 1) queue.push_back(nextIndex);
+		});
+	}
+
+	// Parents are peeled after their children, so the reverse peel order sees every parent first
+	// 親は子の後で剥がされるので、逆順なら親が先
+	_treeDepth.assign(cellCount, 0);
+	_anchor.assign(cellCount, -1);
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (_isCore[i]) _anchor[i] = i;
+	}
+	for (auto it = queue.rbegin(); it != queue.rend(); ++it)
+	{
+		int parent = _treeParent[*it];
+		_anchor[*it] = (parent == -1) ? *it : _anchor[parent];
+		_treeDepth[*it] = (parent == -1) ? 0 : _treeDepth[parent] + 1;
+		_filledCells++;
+	}
+
+	// == Corridor contraction: core cells that aren't degree 2 are nodes, the runs between them edges ==
+	// == 通路の縮約：次数2でないコアのセルがノード、その間の列がエッジ ==
+	_cellNode.assign(cellCount, -1);
+	_cellEdge.assign(cellCount, -1);
+	_cellPosition.assign(cellCount, -1);
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (_isCore[i] && degree[i] != 2) AddNode(i);
+	}
+
+	int junctionCount = static_cast<int>(_nodeCell.size());
+	for (int node = 0; node < junctionCount; node++)
+	{
+		forEachOpenNeighbour(_nodeCell[node], [&](int nextIndex)
+		{
+			if (!_isCore[nextIndex]) return;
+			int nextNode = _cellNode[nextIndex];
+			if (nextNode != -1)
+			{
+				// Two junctions side by side, one edge with no interior cells
+				// 隣り合ったジャンクション、内側のセルが無いエッジ
+				if (node < nextNode) _edges.push_back({ node, nextNode, static_cast<int>(_edgeCells.size()), 0 });
+			}
+			else if (_cellEdge[nextIndex] == -1)
+			{
+				TraceCorridor(node, nextIndex);
+			}
+		});
+	}
+
+	// Loops with no junction at all, one of their cells becomes a node with a self-loop edge
+	// ジャンクションの無いループ、セルの１つを自己ループのノードにする
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (!_isCore[i] || _cellNode[i] != -1 || _cellEdge[i] != -1) continue;
+		int node = AddNode(i);
+		int firstCell = -1;
+		forEachOpenNeighbour(i, [&](int nextIndex) { if (_isCore[nextIndex] && firstCell == -1) firstCell = nextIndex; });
+		TraceCorridor(node, firstCell);
+	}
+
+	// Directed edge codes per node, CSR
+	// ノードごとの向き付きエッジ、CSR
+	int nodeCount = static_cast<int>(_nodeCell.size());
+	_nodeEdgeBegin.assign(nodeCount + 1, 0);
+	for (const JunctionEdge& edge : _edges)
+	{
+		_nodeEdgeBegin[edge.from + 1]++;
+		_nodeEdgeBegin[edge.to + 1]++;
+	}
+	for (int node = 0; node < nodeCount; node++) _nodeEdgeBegin[node + 1] += _nodeEdgeBegin[node];
+
+	std::vector<int> fill(_nodeEdgeBegin.begin(), _nodeEdgeBegin.end() - 1);
+	_nodeEdges.resize(_edges.size() * 2);
+	for (int e = 0; e < static_cast<int>(_edges.size()); e++)
+	{
+		_nodeEdges[fill[_edges[e].from]++] = e * 2;
+		_nodeEdges[fill[_edges[e].to]++] = e * 2 + 1;
+	}
+
+	_buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void JunctionGraph::Clear()
+{
+	_openCells = 0;
+	_filledCells = 0;
+	_buildMs = 0.0;
+	_cost.clear();
+	_isCore.clear();
+	_treeParent.clear();
+	_treeDepth.clear();
+	_anchor.clear();
+	_cellNode.clear();
+	_cellEdge.clear();
+	_cellPosition.clear();
+	_nodeCell.clear();
+	_nodeEdgeBegin.clear();
+	_nodeEdges.clear();
+	_edges.clear();
+	_edgeCells.clear();
+	_edgePrefix.clear();
+}
+
+bool JunctionGraph::Solve(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverJunctionGraph, workspace, path);
+	int cellCount = static_cast<int>(_cost.size());
+
+	path.clear();
+	workspace.Prepare(GetNodeCount());
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+	if (_cost[startIndex] == kWallCost || _cost[endIndex] == kWallCost) return false;
+
+	// Both ends hang off the same anchor: the path runs through their lowest common ancestor
+	// 同じ根にぶら下がっている：一番低い共通の祖先を通る
+	SearchVector<int>& tail = workspace.queue;
+	int startAnchor = _anchor[startIndex];
+	int endAnchor = _anchor[endIndex];
+	if (startAnchor == endAnchor)
+	{
+		int a = startIndex;
+		int b = endIndex;
+		while (a != b)
+		{
+			if (_treeDepth[a] >= _treeDepth[b])
+			{
+				path.push_back(a);
+				a = _treeParent[a];
+			}
+			else
+			{
+				tail.push_back(b);
+				b = _treeParent[b];
+			}
+		}
+		path.push_back(a);
+		path.insert(path.end(), tail.rbegin(), tail.rend());
+		return true;
+	}
+
+	// Tree components have no way out, otherwise walk up to the core, cross it, walk down
+	// 木だけの成分からは出られない、それ以外はコアまで上がって、横切って、下りる
+	if (!_isCore[startAnchor] || !_isCore[endAnchor]) return false;
+
+	for (int cell = startIndex; cell != startAnchor; cell = _treeParent[cell]) path.push_back(cell);
+	if (!SolveCore(startAnchor, endAnchor, workspace, path))
+	{
+		path.clear();
+		return false;
+	}
+	for (int cell = endIndex; cell != endAnchor; cell = _treeParent[cell]) tail.push_back(cell);
+	path.insert(path.end(), tail.rbegin(), tail.rend());
+	return true;
+}
+
+int JunctionGraph::GetOpenCells() const
+{
+	return _openCells;
+}
+
+int JunctionGraph::GetFilledCells() const
+{
+	return _filledCells;
+}
+
+int JunctionGraph::GetNodeCount() const
+{
+	return static_cast<int>(_nodeCell.size());
+}
+
+int JunctionGraph::GetEdgeCount() const
+{
+	return static_cast<int>(_edges.size());
+}
+
+size_t JunctionGraph::GetMemoryBytes() const
+{
+	return _cost.size() * sizeof(unsigned char) + _isCore.size() * sizeof(char)
+		+ (_treeParent.size() + _treeDepth.size() + _anchor.size() + _cellNode.size() + _cellEdge.size() + _cellPosition.size()) * sizeof(int)
+		+ (_nodeCell.size() + _nodeEdgeBegin.size() + _nodeEdges.size() + _edgeCells.size() + _edgePrefix.size()) * sizeof(int)
+		+ _edges.size() * sizeof(JunctionEdge);
+}
+
+double JunctionGraph::GetBuildMs() const
+{
+	return _buildMs;
+}
+// =======================================
+
+
+// ====== Private ======
+int JunctionGraph::GetEdgeCost(int code) const
+{
+	const JunctionEdge& edge = _edges[code >> 1];
+	int target = (code & 1) ? edge.from : edge.to;
+	return GetPrefix(edge, edge.cellCount - 1) + _cost[_nodeCell[target]];
+}
+
+int JunctionGraph::GetPrefix(const JunctionEdge& edge, int position) const
+{
+	// Cost of entering the interior cells 0...position, 0 before the first one
+	// 内側のセル0...positionに入るコスト
+	return (position < 0) ? 0 : _edgePrefix[edge.firstCell + position];
+}
+
+int JunctionGraph::AddNode(int cell)
+{
+	_cellNode[cell] = static_cast<int>(_nodeCell.size());
+	_nodeCell.push_back(cell);
+	return _cellNode[cell];
+}
+
+void JunctionGraph::TraceCorridor(int fromNode, int firstCell)
+{
+	int edgeId = static_cast<int>(_edges.size());
+	JunctionEdge edge = { fromNode, -1, static_cast<int>(_edgeCells.size()), 0 };
+	int runningCost = 0;
+	int prevIndex = _nodeCell[fromNode];
+	int currIndex = firstCell;
+
+	// Corridor cells have exactly two core neighbours, keep stepping away from the previous one
+	// 通路のセルにはコアの隣がちょうど２つ、前のセルから離れる方に進む
+	while (_cellNode[currIndex] == -1)
+	{
+		_cellEdge[currIndex] = edgeId;
+		_cellPosition[currIndex] = edge.cellCount++;
+		runningCost += _cost[currIndex];
+		_edgeCells.push_back(currIndex);
+		_edgePrefix.push_back(runningCost);
+
+		int x = currIndex % _gridWidth;
+		int y = currIndex / _gridWidth;
+		int nextIndex = -1;
+		auto step = [&](int candidate)
+		{
+			if (candidate != prevIndex && _isCore[candidate]) nextIndex = candidate;
+		};
+		if (x > 0) step(currIndex - 1);
+		if (x < _gridWidth - 1) step(currIndex + 1);
+		if (y > 0) step(currIndex - _gridWidth);
+		if (y < _gridHeight - 1) step(currIndex + _gridWidth);
+
+		prevIndex = currIndex;
+		currIndex = nextIndex;
+	}
+
+	edge.to = _cellNode[currIndex];
+	_edges.push_back(edge);
+}
+
+void JunctionGraph::PushCells(std::vector<int>& path, const JunctionEdge& edge, int beginPosition, int endPosition) const
+{
+	int step = (beginPosition <= endPosition) ? 1 : -1;
+	for (int position = beginPosition; ; position += step)
+	{
+		path.push_back(_edgeCells[edge.firstCell + position]);
+		if (position == endPosition) break;
+	}
+}
+
+bool JunctionGraph::SolveCore(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	if (startIndex == endIndex)
+	{
+		path.push_back(startIndex);
+		return true;
+	}
+
+	int startNode = _cellNode[startIndex];
+	int endNode = _cellNode[endIndex];
+	int startEdge = _cellEdge[startIndex];
+	int endEdge = _cellEdge[endIndex];
+	int startPosition = _cellPosition[startIndex];
+	int endPosition = _cellPosition[endIndex];
+
+	// Binary heap over nodes, a node's parent is the directed edge code it came in on,
+	// -2 - code for the partial edge from a start that sits inside a corridor
+	// ノードのバイナリヒープ、親は入ってきた向き付きエッジ、通路の中のスタートからは -2 - code
+	SearchVector<std::pair<int, int>>& heap = workspace.heap;
+	auto isGreater = std::greater<std::pair<int, int>>();
+	heap.clear();
+	auto push = [&](int node, int dist, int parentCode)
+	{
+		if (workspace.IsVisited(node) && workspace.GetDist(node) <= dist) return;
+		workspace.Visit(node, parentCode, dist);
+		heap.push_back({ dist, node });
+		std::push_heap(heap.begin(), heap.end(), isGreater);
+		workspace.enqueuedNodes++;
+		workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(heap.size()));
+	};
+
+	if (startNode != -1)
+	{
+		push(startNode, 0, -1);
+	}
+	else
+	{
+		const JunctionEdge& edge = _edges[startEdge];
+		push(edge.to, GetPrefix(edge, edge.cellCount - 1) - GetPrefix(edge, startPosition) + _cost[_nodeCell[edge.to]], -2 - (startEdge * 2));
+		push(edge.from, GetPrefix(edge, startPosition - 1) + _cost[_nodeCell[edge.from]], -2 - (startEdge * 2 + 1));
+	}
+
+	// Best way into the end found so far: straight along a shared corridor (bestNode -1),
+	// or from bestNode into the end's corridor in direction bestDirection
+	// 今までで一番いい終わりへの入り方：同じ通路をまっすぐか、bestNodeから終わりの通路へ
+	int best = INT_MAX;
+	int bestNode = -1;
+	int bestDirection = 0;
+	if (startEdge != -1 && startEdge == endEdge)
+	{
+		const JunctionEdge& edge = _edges[startEdge];
+		best = (startPosition < endPosition) ? GetPrefix(edge, endPosition) - GetPrefix(edge, startPosition) :
+			GetPrefix(edge, startPosition - 1) - GetPrefix(edge, endPosition - 1);
+	}
+
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), isGreater);
+		auto [currDist, currNode] = heap.back();
+		heap.pop_back();
+
+		if (workspace.GetDist(currNode) != currDist) continue;
+		if (currDist >= best) break;
+		workspace.expandedNodes++;
+
+		if (currNode == endNode)
+		{
+			best = currDist;
+			bestNode = currNode;
+			break;
+		}
+		if (endNode == -1)
+		{
+			const JunctionEdge& edge = _edges[endEdge];
+			int fromFront = currDist + GetPrefix(edge, endPosition);
+			int fromBack = currDist + GetPrefix(edge, edge.cellCount - 1) - GetPrefix(edge, endPosition - 1);
+			if (currNode == edge.from && fromFront < best) { best = fromFront; bestNode = currNode; bestDirection = 0; }
+			if (currNode == edge.to && fromBack < best) { best = fromBack; bestNode = currNode; bestDirection = 1; }
+		}
+
+		for (int k = _nodeEdgeBegin[currNode]; k < _nodeEdgeBegin[currNode + 1]; k++)
+		{
+			int code = _nodeEdges[k];
+			const JunctionEdge& edge = _edges[code >> 1];
+			push((code & 1) ? edge.from : edge.to, currDist + GetEdgeCost(code), code);
+		}
+	}
+	if (best == INT_MAX) return false;
+
+	// Expand back to cells, built end -> start then reversed
+	// セルに戻す、終わり -> 初めで作って逆にする
+	size_t offset = path.size();
+	if (bestNode == -1)
+	{
+		PushCells(path, _edges[endEdge], endPosition, startPosition);
+	}
+	else
+	{
+		if (endNode == -1)
+		{
+			const JunctionEdge& edge = _edges[endEdge];
+			PushCells(path, edge, endPosition, (bestDirection == 0) ? 0 : edge.cellCount - 1);
+		}
+
+		int currNode = bestNode;
+		while (true)
+		{
+			path.push_back(_nodeCell[currNode]);
+			int code = workspace.GetParent(currNode);
+			if (code == -1) break;
+
+			bool isFromStart = code <= -2;
+			if (isFromStart) code = -2 - code;
+			const JunctionEdge& edge = _edges[code >> 1];
+			bool isForward = (code & 1) == 0;
+			if (isFromStart)
+			{
+				PushCells(path, edge, isForward ? edge.cellCount - 1 : 0, startPosition);
+				break;
+			}
+			if (edge.cellCount > 0) PushCells(path, edge, isForward ? edge.cellCount - 1 : 0, isForward ? 0 : edge.cellCount - 1);
+			currNode = isForward ? edge.from : edge.to;
+		}
+	}
+	std::reverse(path.begin() + offset, path.end());
+	return true;
+}
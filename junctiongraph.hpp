@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "searchworkspace.hpp"
+
+class Maze;
+
+/*
+	Preprocessed query graph for perfect and near-perfect mazes
+	Dead-end filling peels every dead end off the grid, the peeled cells form trees that hang
+	off the remaining core (or are whole tree components on their own). Degree-2 corridors of the
+	core are then contracted into edges between junctions, so a query is a Dijkstra over junctions
+	plus walks up the trees, expanded back to a cell path
+	完全なメイズ用の前処理したクエリグラフ
+	行き止まりを埋めて木にする、残ったコアの通路（次数2）をジャンクション間のエッジに縮める
+	クエリはジャンクションのDijkstraと木をたどるだけ、最後にセルのパスに戻す
+*/
+
+class JunctionGraph
+{
+public:
+	JunctionGraph(void);
+	~JunctionGraph(void);
+
+	// Keeps its own copy of the costs, the maze must not change afterwards
+	// コストのコピーを持つ、後でメイズを変えてはいけない
+	void Build(const Maze& maze);
+	void Clear(void);
+
+	// Same cost as Maze::SolveDijkstra, the workspace is used over junction nodes (thread-safe per workspace)
+	// Maze::SolveDijkstraと同じコスト、ワークスペースはジャンクションのノードに使う
+	bool Solve(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int GetOpenCells(void) const;
+	int GetFilledCells(void) const;
+	int GetNodeCount(void) const;
+	int GetEdgeCount(void) const;
+	size_t GetMemoryBytes(void) const;
+	double GetBuildMs(void) const;
+
+private:
+	// Corridor between two nodes, its interior cells are _edgeCells[firstCell ... firstCell + cellCount)
+	// ordered from -> to, _edgePrefix holds the running cost of entering them
+	// ２つのノード間の通路、内側のセルはfrom -> toの順
+	typedef struct JunctionEdge
+	{
+		int from;
+		int to;
+		int firstCell;
+		int cellCount;
+	};
+
+	// Directed edge code: edge * 2 + 0 runs from -> to, edge * 2 + 1 runs to -> from
+	// 向き付きエッジのコード：edge * 2 + 0 は from -> to、+ 1 は to -> from
+	int GetEdgeCost(int code) const;
+	int GetPrefix(const JunctionEdge& edge, int position) const;
+	int AddNode(int cell);
+	void TraceCorridor(int fromNode, int firstCell);
+	void PushCells(std::vector<int>& path, const JunctionEdge& edge, int beginPosition, int endPosition) const;
+	bool SolveCore(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int _gridWidth = 0;
+	int _gridHeight = 0;
+	int _openCells = 0;
+	int _filledCells = 0;
+	double _buildMs = 0.0;
+
+	// Per cell: cost, core flag, tree parent / depth / anchor (core cell or tree root) from the dead-end filling,
+	// node id for junctions, edge id and position for corridor cells
+	// セルごと：コスト、コアか、行き止まり埋めの木の親／深さ／根、ジャンクションのノード番号、通路のエッジと位置
+	std::vector<unsigned char> _cost;
+	std::vector<char> _isCore;
+	std::vector<int> _treeParent;
+	std::vector<int> _treeDepth;
+	std::vector<int> _anchor;
+	std::vector<int> _cellNode;
+	std::vector<int> _cellEdge;
+	std::vector<int> _cellPosition;
+
+	std::vector<int> _nodeCell;
+	std::vector<int> _nodeEdgeBegin;	// CSR offsets into _nodeEdges
+	std::vector<int> _nodeEdges;		// directed edge codes leaving each node
+	std::vector<JunctionEdge> _edges;
+	std::vector<int> _edgeCells;
+	std::vector<int> _edgePrefix;
+};
@@ -0,0 +1,125 @@
+﻿#include "landmarks.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+
+
+// ======= Public ==========
+LandmarkTable::LandmarkTable()
+{}
+
+LandmarkTable::~LandmarkTable()
+{}
+
+bool LandmarkTable::Build(const Maze& maze, int landmarkCount)
+{
+	PROFILE_SCOPE("LandmarkTable::Build");
+	auto startTime = std::chrono::steady_clock::now();
+
+	Clear();
+	int cellCount = maze.GetCellCount();
+	int firstOpen = -1;
+	for (int i = 0; i < cellCount && firstOpen == -1; i++)
+	{
+		if (!maze.IsWall(i)) firstOpen = i;
+	}
+	if (firstOpen == -1 || landmarkCount <= 0) return false;
+
+	// The first landmark is the cell farthest from an arbitrary open cell, after that each one is
+	// the cell farthest from every landmark picked so far (only cells they can reach count)
+	// 最初のランドマークは任意の空きセルから一番遠いセル、その後は選んだランドマーク全てから一番遠いセル
+	maze.SolveDijkstra(firstOpen, -1, _workspace, _path);
+	int nextLandmark = firstOpen;
+	for (int i = 0; i < cellCount; i++)
+	{
+		if (_workspace.GetDist(i) > _workspace.GetDist(nextLandmark)) nextLandmark = i;
+	}
+
+	// Built 32-bit first, narrowed to 16-bit once the largest distance is known
+	// まず32ビットで作って、一番大きい距離が分かったら16ビットにする
+	std::vector<uint32_t> dist(static_cast<size_t>(cellCount) * landmarkCount);
+	std::vector<int> nearestLandmarkDist(cellCount, INT_MAX);
+	uint32_t maxDist = 0;
+
+	for (int landmark = 0; landmark < landmarkCount; landmark++)
+	{
+		_landmarks.push_back(nextLandmark);
+		maze.SolveDijkstra(nextLandmark, -1, _workspace, _path);
+
+		nextLandmark = -1;
+		for (int i = 0; i < cellCount; i++)
+		{
+			int cellDist = _workspace.GetDist(i);
+			dist[static_cast<size_t>(i) * landmarkCount + landmark] = (cellDist == -1) ? UINT32_MAX : static_cast<uint32_t>(cellDist);
+			if (cellDist == -1) continue;
+
+			maxDist = std::max(maxDist, static_cast<uint32_t>(cellDist));
+			nearestLandmarkDist[i] = std::min(nearestLandmarkDist[i], cellDist);
+			if (nextLandmark == -1 || nearestLandmarkDist[i] > nearestLandmarkDist[nextLandmark]) nextLandmark = i;
+		}
+
+		// Every reachable cell is already a landmark, the rest of the columns would repeat
+		// 到達できる全てのセルがもうランドマーク
+		if (nearestLandmarkDist[nextLandmark] == 0) break;
+	}
+
+	// Drop the columns of landmarks that were never picked
+	// 選ばれなかったランドマークの列を捨てる
+	_landmarkCount = static_cast<int>(_landmarks.size());
+	_isWide = maxDist >= UINT16_MAX;
+	if (_isWide) _dist32.resize(static_cast<size_t>(cellCount) * _landmarkCount);
+	else _dist16.resize(static_cast<size_t>(cellCount) * _landmarkCount);
+
+	for (int i = 0; i < cellCount; i++)
+	{
+		for (int landmark = 0; landmark < _landmarkCount; landmark++)
+		{
+			uint32_t value = dist[static_cast<size_t>(i) * landmarkCount + landmark];
+			if (_isWide) _dist32[static_cast<size_t>(i) * _landmarkCount + landmark] = value;
+			else _dist16[static_cast<size_t>(i) * _landmarkCount + landmark] = (value == UINT32_MAX) ? UINT16_MAX : static_cast<uint16_t>(value);
+		}
+	}
+
+	_buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	return true;
+}
+
+void LandmarkTable::Clear()
+{
+	_landmarkCount = 0;
+	_isWide = false;
+	_buildMs = 0.0;
+	_landmarks.clear();
+	_dist16.clear();
+	_dist16.shrink_to_fit();
+	_dist32.clear();
+	_dist32.shrink_to_fit();
+}
+
+int LandmarkTable::GetLandmarkCount() const
+{
+	return _landmarkCount;
+}
+
+int LandmarkTable::GetLandmark(int landmark) const
+{
+	return _landmarks[landmark];
+}
+
+bool LandmarkTable::GetIsWide() const
+{
+	return _isWide;
+}
+
+size_t LandmarkTable::GetMemoryBytes() const
+{
+	return _dist16.size() * sizeof(uint16_t) + _dist32.size() * sizeof(uint32_t) + _landmarks.size() * sizeof(int);
+}
+
+double LandmarkTable::GetBuildMs() const
+{
+	return _buildMs;
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "searchworkspace.hpp"
+
+class Maze;
+
+/*
+	ALT (A*, Landmarks, Triangle inequality) distance oracle for static mazes
+	K landmarks are picked by farthest-point selection, every cell keeps its cost to each landmark,
+	d(L, goal) - d(L, cell) is a lower bound of d(cell, goal) for every landmark L, and so is the reverse
+	difference once the cost of entering cell and goal is swapped (paths cost the cells they enter)
+	Tables are 16-bit while every distance fits, 32-bit otherwise, laid out cell-major
+	so one heuristic lookup reads K neighbouring values
+	静的なメイズ用のALT距離オラクル、K個のランドマークを一番遠い点から選ぶ
+	三角不等式でゴールまでの距離の下限を出す、A*のヒューリスティックに使う
+*/
+
+class LandmarkTable
+{
+public:
+	LandmarkTable(void);
+	~LandmarkTable(void);
+
+	// One Dijkstra per landmark over the cell costs, the maze must not change afterwards
+	// Returns false if the maze has no open cell
+	// ランドマークごとにDijkstra１回、後でメイズを変えてはいけない
+	bool Build(const Maze& maze, int landmarkCount);
+	void Clear(void);
+
+	// Hot path, kept inline, costShift is cost(goal) - cost(index) (0 on flat mazes)
+	// ホットパスなのでインライン、costShiftはcost(goal) - cost(index)
+	int LowerBound(int index, int goalIndex, int costShift) const
+	{
+		return _isWide ? LowerBoundOf(_dist32, index, goalIndex, costShift) : LowerBoundOf(_dist16, index, goalIndex, costShift);
+	}
+
+	int GetLandmarkCount(void) const;
+	int GetLandmark(int landmark) const;
+	bool GetIsWide(void) const;
+	size_t GetMemoryBytes(void) const;
+	double GetBuildMs(void) const;
+
+private:
+	template <typename T>
+	int LowerBoundOf(const std::vector<T>& table, int index, int goalIndex, int costShift) const
+	{
+		// Landmarks that can't reach one of the two cells give no bound
+		// どちらかのセルに届かないランドマークは下限にならない
+		constexpr T kUnreachable = static_cast<T>(~T(0));
+		const T* cell = &table[static_cast<size_t>(index) * _landmarkCount];
+		const T* goal = &table[static_cast<size_t>(goalIndex) * _landmarkCount];
+		int bound = 0;
+		for (int landmark = 0; landmark < _landmarkCount; landmark++)
+		{
+			if (cell[landmark] == kUnreachable || goal[landmark] == kUnreachable) continue;
+			int diff = static_cast<int>(goal[landmark]) - static_cast<int>(cell[landmark]);
+			bound = std::max(bound, std::max(diff, costShift - diff));
+		}
+		return bound;
+	}
+
+	int _landmarkCount = 0;
+	bool _isWide = false;
+	double _buildMs = 0.0;
+
+	std::vector<int> _landmarks;
+	std::vector<uint16_t> _dist16;
+	std::vector<uint32_t> _dist32;
+
+	SearchWorkspace _workspace;
+	std::vector<int> _path;
+};
@@ -0,0 +1,208 @@
+﻿#include "layoutgrid.hpp"
+#include "maze.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <utility>
+
+
+// ======= Public ==========
+template <typename Layout>
+LayoutGrid<Layout>::LayoutGrid()
+{}
+
+template <typename Layout>
+LayoutGrid<Layout>::~LayoutGrid()
+{}
+
+template <typename Layout>
+bool LayoutGrid<Layout>::Build(const Maze& maze)
+{
+	_width = maze.GetGridWidth();
+	_height = maze.GetGridHeight();
+	if (!_layout.Init(_width, _height))
+	{
+		std::cerr << "LayoutGrid: A " << _width << "x" << _height << " grid doesn't fit the layout's int indices\n";
+		_width = 0;
+		_height = 0;
+		_costs.clear();
+		return false;
+	}
+
+	// Everything that isn't a cell (border, Morton's wall slot and the rest of its square) stays a wall
+	// セルでないもの（枠、Mortonの壁のスロットと正方形の残り）は壁のまま
+	_costs.assign(_layout.GetStorageCount(), kWallCost);
+	for (int y = 0; y < _height; y++)
+	{
+		for (int x = 0; x < _width; x++)
+		{
+			_costs[_layout.ToStorage(x, y)] = maze.GetCost(y * _width + x);
+		}
+	}
+	return true;
+}
+
+template <typename Layout>
+bool LayoutGrid<Layout>::SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverLayoutBFS, workspace, path);
+	int cellCount = _width * _height;
+	path.clear();
+	workspace.Prepare(GetStorageCount());
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+
+	int storageStart = ToStorage(startIndex);
+	int storageEnd = ToStorage(endIndex);
+	if (_costs[storageEnd] == kWallCost) return false;
+
+	const unsigned char* costs = _costs.data();
+	SearchVector<int>& queue = workspace.queue;
+	queue.push_back(storageStart);
+	workspace.Visit(storageStart, -1, 0);
+	size_t peakQueue = 0;
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int currIndex = queue[head];
+		workspace.expandedNodes++;
+		peakQueue = std::max(peakQueue, queue.size() - head);
+
+		if (currIndex == storageEnd)
+		{
+			workspace.enqueuedNodes = static_cast<long long>(queue.size());
+			workspace.peakQueue = static_cast<long long>(peakQueue);
+			ExtractPath(storageEnd, workspace, path);
+			return true;
+		}
+
+		int nextDist = workspace.GetDist(currIndex) + 1;
+		auto visit = [&](int nextIndex)
+		{
+			if (costs[nextIndex] == kWallCost || workspace.IsVisited(nextIndex)) return;
+			workspace.Visit(nextIndex, currIndex, nextDist);
+			queue.push_back(nextIndex);
+		};
+
+		// Left, right, up, down
+		// 左、右、上、下
+		visit(_layout.Left(currIndex));
+		visit(_layout.Right(currIndex));
+		visit(_layout.Up(currIndex));
+		visit(_layout.Down(currIndex));
+	}
+
+	workspace.enqueuedNodes = static_cast<long long>(queue.size());
+	workspace.peakQueue = static_cast<long long>(peakQueue);
+	return false;
+}
+
+template <typename Layout>
+bool LayoutGrid<Layout>::SolveAStar(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverLayoutAStar, workspace, path);
+	int cellCount = _width * _height;
+	path.clear();
+	workspace.Prepare(GetStorageCount());
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+
+	int storageStart = ToStorage(startIndex);
+	int storageEnd = ToStorage(endIndex);
+	if (_costs[storageEnd] == kWallCost) return false;
+
+	// Manhattan distance in cell coordinates, only ever taken for open cells
+	// セル座標のマンハッタン距離、空いたセルだけに使う
+	int endX, endY;
+	_layout.ToXY(storageEnd, endX, endY);
+	auto heuristic = [&](int index)
+	{
+		int x, y;
+		_layout.ToXY(index, x, y);
+		return std::abs(x - endX) + std::abs(y - endY);
+	};
+
+	// Same lazy-deletion binary heap as Maze::SolveAStar
+	// Maze::SolveAStarと同じバイナリヒープ
+	const unsigned char* costs = _costs.data();
+	SearchVector<std::pair<int, int>>& heap = workspace.heap;
+	auto isGreater = std::greater<std::pair<int, int>>();
+	heap.clear();
+	heap.push_back({ heuristic(storageStart), storageStart });
+	workspace.Visit(storageStart, -1, 0);
+	workspace.enqueuedNodes = 1;
+	workspace.peakQueue = 1;
+
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), isGreater);
+		auto [currF, currIndex] = heap.back();
+		heap.pop_back();
+
+		int currDist = workspace.GetDist(currIndex);
+		if (currDist + heuristic(currIndex) != currF) continue;
+		workspace.expandedNodes++;
+
+		if (currIndex == storageEnd)
+		{
+			ExtractPath(storageEnd, workspace, path);
+			return true;
+		}
+
+		auto relax = [&](int nextIndex)
+		{
+			int cost = costs[nextIndex];
+			if (cost == kWallCost) return;
+			int nextDist = currDist + cost;
+			if (workspace.IsVisited(nextIndex) && workspace.GetDist(nextIndex) <= nextDist) return;
+			workspace.Visit(nextIndex, currIndex, nextDist);
+			heap.push_back({ nextDist + heuristic(nextIndex), nextIndex });
+			std::push_heap(heap.begin(), heap.end(), isGreater);
+			workspace.enqueuedNodes++;
+			workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(heap.size()));
+		};
+
+		relax(_layout.Left(currIndex));
+		relax(_layout.Right(currIndex));
+		relax(_layout.Up(currIndex));
+		relax(_layout.Down(currIndex));
+	}
+
+	return false;
+}
+
+template <typename Layout>
+int LayoutGrid<Layout>::GetWidth() const
+{
+	return _width;
+}
+
+template <typename Layout>
+int LayoutGrid<Layout>::GetHeight() const
+{
+	return _height;
+}
+
+template <typename Layout>
+int LayoutGrid<Layout>::GetStorageCount() const
+{
+	return static_cast<int>(_costs.size());
+}
+// =======================================
+
+
+// ====== Private ======
+template <typename Layout>
+void LayoutGrid<Layout>::ExtractPath(int storageEnd, const SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	path.clear();
+	for (int storageIndex = storageEnd; storageIndex != -1; storageIndex = workspace.GetParent(storageIndex))
+	{
+		path.push_back(FromStorage(storageIndex));
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+template class LayoutGrid<RowMajorLayout>;
+template class LayoutGrid<MortonLayout>;
+template class LayoutGrid<Tiled8Layout>;
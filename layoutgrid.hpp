@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "celllayout.hpp"
+#include "searchworkspace.hpp"
+#include "telemetry.hpp"
+
+class Maze;
+
+/*
+	Copy of the cell costs stored in the Layout order (see celllayout.hpp), for measuring layouts side by side
+	The solvers here are written once against the layout's neighbour steps, so they run unchanged on every
+	layout; Maze::SolveBFS / SolveAStar and the app stay on the row-major grid, and LayoutGrid<RowMajorLayout>
+	is the control the other layouts are compared against with the same solver code
+	Indices going in and out are plain Maze indices, the workspace is indexed in storage order
+	so its visited / parent / distance arrays get the same locality as the costs
+	Layoutの順に並べたコストのコピー、レイアウトを比べるためのもの。ここのソルバーは全てのレイアウトで動く、
+	Mazeのソルバーとアプリは行優先のまま、LayoutGrid<RowMajorLayout>は同じコードで比べる基準
+	出入りするインデックスは普通のMazeのインデックス、ワークスペースは保存順
+*/
+
+template <typename Layout>
+class LayoutGrid
+{
+public:
+	LayoutGrid(void);
+	~LayoutGrid(void);
+
+	// Copies the costs out of the maze, call again after the maze changes
+	// Returns false (and leaves the grid empty) if the layout can't hold a grid that big
+	// メイズからコストをコピーする、メイズが変わったらもう一度呼ぶ、レイアウトに入らなければfalse
+	bool Build(const Maze& maze);
+
+	bool SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+	// A* by cell cost with the Manhattan heuristic, same cost as Maze::SolveAStar
+	// マンハッタン距離のA*、Maze::SolveAStarと同じコスト
+	bool SolveAStar(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int ToStorage(int index) const { return _layout.ToStorage(index % _width, index / _width); }
+	int FromStorage(int storageIndex) const
+	{
+		int x, y;
+		_layout.ToXY(storageIndex, x, y);
+		return y * _width + x;
+	}
+
+	int GetWidth(void) const;
+	int GetHeight(void) const;
+	int GetStorageCount(void) const;
+
+private:
+	// Turns the storage-order parent chain into a Maze index path
+	// 保存順の親のチェーンをMazeのインデックスのパスにする
+	void ExtractPath(int storageEnd, const SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int _width = 0;
+	int _height = 0;
+	Layout _layout;
+	TrackedVector<unsigned char, TelemetryMemoryStorage> _costs;
+};
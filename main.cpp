@@ -1,39 +1,91 @@
-#define WIN32_LEAN_AND_MEAN
-#include <iostream>
-#include <stdlib.h>
-#include <string>
-
-// = Direct X =
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "dxgi.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-#pragma comment(lib, "winmm.lib")
-#pragma comment(lib, "dxguid.lib")
-
-// = SDL =
-#define SDL_MAIN_HANDLED
-#include <SDL.h>
-// ============
-
-#include "canvas.hpp"
-
-int main(int argc, char* args[])
-{
-	SDL_SetMainReady();
-	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "direct3D");
-
-	srand(time(NULL));
-	bool isRunning = true;
-
-	std::string name = "Maze";
-
-	Canvas app = {name, 800, 600, &isRunning};
-
-	// = Main Program Loop =
-	while (isRunning) 
-	{
-		app.Loop();
-	}
-
-	return 0;
+#define WIN32_LEAN_AND_MEAN
+#include <iostream>
+#include <stdlib.h>
+#include <string>
+
+// = Direct X =
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "winmm.lib")
+#pragma comment(lib, "dxguid.lib")
+
+// = SDL =
+#define SDL_MAIN_HANDLED
+#include <SDL.h>
+// ============
+
+#include "canvas.hpp"
+#include "profiler.hpp"
+#include "sessionlog.hpp"
+#include "telemetry.hpp"
+
+// Maze [--record session.bin | --replay session.bin] [--maze-size 20] [--update-hz 60] [--render-hz 0] [--no-vsync] [--uncapped]
+int main(int argc, char* args[])
+{
+	SDL_SetMainReady();
+	Profiler::GetInstance().NameThread("main");
+	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "direct3D");
+
+	std::string recordFile;
+	std::string replayFile;
+	FrameLoopConfig frameConfig;
+	bool isUncapped = false;
+	int mazeCells = 20;
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = args[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--record" && hasValue)			recordFile = args[++i];
+		else if (arg == "--replay" && hasValue)		replayFile = args[++i];
+		else if (arg == "--maze-size" && hasValue)	mazeCells = atoi(args[++i]);
+		else if (arg == "--update-hz" && hasValue)	frameConfig.updateHz = atof(args[++i]);
+		else if (arg == "--render-hz" && hasValue)	frameConfig.renderHz = atof(args[++i]);
+		else if (arg == "--no-vsync")				frameConfig.isVsync = false;
+		else if (arg == "--uncapped")				isUncapped = true;
+		else
+		{
+			std::cerr << "Unknown argument: " << arg << "\n" << "Maze [--record session.bin | --replay session.bin] "
+				"[--maze-size 20] [--update-hz 60] [--render-hz 0] [--no-vsync] [--uncapped]\n";
+			return 1;
+		}
+	}
+
+	// A replay takes the seed, screen size and maze size from the recording
+	SessionLog session;
+	unsigned int seed = static_cast<unsigned int>(time(NULL));
+	int scrnW = 800;
+	int scrnH = 600;
+	if (!replayFile.empty())
+	{
+		if (!session.Load(replayFile)) return 1;
+		seed = session.GetHeader().seed;
+		scrnW = session.GetHeader().screenWidth;
+		scrnH = session.GetHeader().screenHeight;
+		mazeCells = session.GetHeader().mazeCells;
+	}
+
+	srand(seed);
+	bool isRunning = true;
+
+	std::string name = "Maze";
+
+	Canvas app = {name, scrnW, scrnH, &isRunning, mazeCells};
+	app.SetFrameLoopConfig(frameConfig, isUncapped);
+	if (!recordFile.empty()) app.StartRecording(recordFile, seed);
+	else if (!replayFile.empty()) app.StartReplay(session);
+
+	// = Main Program Loop =
+	while (isRunning) 
+	{
+		app.Loop();
+	}
+
+	app.EndSession();
+	const FrameLoop& frameLoop = app.GetFrameLoop();
+	std::cout << "Frame loop: " << frameLoop.GetUpdateCount() << " updates, " << frameLoop.GetRenderCount() << " frames, "
+		<< frameLoop.GetDroppedUpdates() << " updates dropped, last " << app.GetUpdateRate() << " updates/s / "
+		<< app.GetRenderRate() << " frames/s\n";
+	Telemetry::GetInstance().Dump(std::cout);
+	return 0;
 }
\ No newline at end of file
@@ -1,10 +1,10 @@
-#pragma once
-
-#ifndef _MAIN_HPP_
-#define _MAIN_HPP_
-
-extern int scrn_w;
-extern int scrn_h;
-extern bool isRunning;
-
-#endif
+#pragma once
+
+#ifndef _MAIN_HPP_
+#define _MAIN_HPP_
+
+extern int scrn_w;
+extern int scrn_h;
+extern bool isRunning;
+
+#endif
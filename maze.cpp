@@ -1,277 +1,1066 @@
-﻿#include "maze.hpp"
-#include "tile.hpp"
-#include "canvas.hpp"
-
-#include <stdlib.h>
-#include <queue>
-
-
-// ======= Public ==========
-Maze::~Maze()
-{}
-
-void Maze::InitMaze(int nCellsWidth, int nCellsHeight, int scrnW, int scrnH)
-{
-	_isDrawn = false;
-	_cellWidth = scrnW / nCellsWidth;
-	_cellHeight = scrnH / nCellsHeight;
-	_mazeSizeWidth = _cellWidth * nCellsWidth;
-	_mazeSizeHeight = _cellHeight * nCellsHeight;
-}
-
-void Maze::GenerateMaze(Canvas* canvas)
-{
-	_tiles.clear();
-	_maze.clear();
-
-	for (int j = 0; j < (_mazeSizeHeight / _cellHeight); j++) {
-		for (int i = 0; i < (_mazeSizeWidth / _cellWidth); i++)
-		{
-			GridIndex nGrid = {};
-			int nRan = rand() % 10;
-
-			if ((i == 0 && j == 0) || (nRan < 9))  nGrid.isWall = false;
-			else									nGrid.isWall = true;
-
-			nGrid.x = i;
-			nGrid.y = j;
-			nGrid.visited = false;
-			nGrid.distFromStart = 0;
-			_maze.push_back(nGrid);
-		}
-	}
-}
-
-void Maze::FindPath(int startX, int startY, int endX, int endY)
-{
-	// Convert screen coords -> grid coords
-	// 画面座標 -> グリッド座標に変更する
-	int startGridX = startX / _cellWidth;
-	int startGridY = startY / _cellHeight;
-	int endGridX = endX / _cellWidth;
-	int endGridY = endY / _cellHeight;
-
-	// Get grid dimensions
-	// グリッドサイズを取って
-	int gridWidth = _mazeSizeWidth / _cellWidth;
-	int gridHeight = _mazeSizeHeight / _cellHeight;
-
-	// Bounds check using lambda function
-	// lamba functionで画面の限定確認
-	auto isInBounds = [gridWidth, gridHeight](int x, int y) 
-	{
-		return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight;
-	};
-
-	if (!isInBounds(startGridX, startGridY) || !isInBounds(endGridX, endGridY)) 
-	{
-		std::cout << "Start or end position out of bounds\n";
-		return;
-	}
-
-	int endIndex = endGridY * gridWidth + endGridX;
-	if (endIndex >= _maze.size()) 
-	{
-		std::cout << "End index out of bounds: " << endIndex << " >= " << _maze.size() << "\n";
-		return;
-	}
-
-	// Check Wall
-	// 壁場合を確認
-	if (_maze.at(endIndex).isWall) 
-	{
-		std::cout << "Cannot pathfind to a wall tile at grid position: " << endGridX << ", " << endGridY << "\n";
-		std::cout << "Index: " << endIndex << "\n";
-		return;
-	}
-
-	// Convert start position to 1D array index
-	// 初めてのポジション -> 1D アレイ index
-	int startIndex = startGridY * gridWidth + startGridX;
-
-	// Initialize start position
-	// 初めてのポジションをイニシャライズ
-	std::queue<int> pathQ;
-	pathQ.push(startIndex);
-	_maze.at(startIndex).visited = true;
-	_maze.at(startIndex).isWall = false;
-	_maze.at(startIndex).parentIndex = -1;
-
-	// BFS loop
-	// BFS ループ
-	while (!pathQ.empty())
-	{
-		int currIndex = pathQ.front();
-		pathQ.pop();
-
-		GridIndex& currGrid = _maze.at(currIndex);
-
-		// Check if we reached the end
-		// 果てのポイントを確認
-		if (currGrid.x == endGridX && currGrid.y == endGridY)
-		{
-			_path.clear();
-
-			// Backtrack from end to start
-			// 果てから初めてのポジションへ後戻る
-			int backtrackIndex = currIndex;
-			while (backtrackIndex != -1)
-			{
-				_path.push_back(_maze.at(backtrackIndex));
-				backtrackIndex = _maze.at(backtrackIndex).parentIndex;
-			}
-			std::reverse(_path.begin(), _path.end());
-			return;
-		}
-
-		// Check neighbours
-		// グリッド隣人を確認
-		std::vector<std::pair<int, int>> directions = 
-		{ 
-			{-1, 0}, 
-			{1, 0}, 
-			{0, -1}, 
-			{0, 1} 
-		};
-
-		// ranged-based for-loop using structured binding
-		// 日本語わかんね
-		for (const auto& [dx, dy] : directions)
-		{
-			int newX = currGrid.x + dx;
-			int newY = currGrid.y + dy;
-
-			if (isInBounds(newX, newY))
-			{
-				int neighborIndex = newY * gridWidth + newX;
-				if (!_maze.at(neighborIndex).visited && !_maze.at(neighborIndex).isWall)
-				{
-					_maze.at(neighborIndex).visited = true;
-					_maze.at(neighborIndex).distFromStart = currGrid.distFromStart + 1;
-					_maze.at(neighborIndex).parentIndex = currIndex;
-					pathQ.push(neighborIndex);
-				}
-			}
-		}
-	}
-}
-
-void Maze::GeneratePath(Canvas* canvas) 
-{
-	// And also Maze
-	// メイズと
-	std::cout << _maze.size() << "\n";
-	for (int i = 0; i < _maze.size(); i++) 
-	{
-		if (i % (_mazeSizeWidth / _cellWidth) == 0) 
-		{
-			std::cout << "\n";
-		}
-
-		bool isStart = false;
-		bool isEnd = false;
-		bool isPathCell = false;
-
-		// Only check path-related stuff if we actually have a path
-		// ルートがある場合だけで
-		if (!_path.empty()) 
-		{
-			isStart = (_maze.at(i).x == _path.front().x && _maze.at(i).y == _path.front().y);
-			isEnd = (_maze.at(i).x == _path.back().x && _maze.at(i).y == _path.back().y);
-		
-			for (const auto& pathCell : _path)
-			{
-				if (_maze.at(i).x == pathCell.x && _maze.at(i).y == pathCell.y)
-				{
-					isPathCell = true;
-					break;
-				}
-			}
-		}
-
-		if (isStart) 
-		{
-			std::cout << " S ";
-		}
-		else if (isEnd) 
-		{
-			std::cout << " E ";
-		}
-
-		if (!_maze.at(i).isWall) 
-		{
-			if (isPathCell)
-			{
-					std::cout << "   ";
-			}
-			else	std::cout << " a ";
-		}
-		else 
-		{
-			std::cout << " I ";
-		}
-		
-		Tile newTile(
-			_maze.at(i).x, _maze.at(i).y,
-			_maze.at(i).isWall, isPathCell,
-			canvas->GetScreenWidth(), canvas->GetScreenHeight(), this);
-		if (!newTile.Initialize(canvas)) 
-		{
-			std::cerr << "Failed to initialize tile\n";
-			continue;
-		}
-		_tiles.push_back(newTile);
-	}
-
-	_isDrawn = true;
-}
-
-int Maze::GetMazeWidth() const
-{
-	return _mazeSizeWidth;
-}
-
-int Maze::GetMazeHeight() const
-{
-	return _mazeSizeHeight;
-}
-
-int Maze::GetCellWidth() const
-{
-	return _cellWidth;
-}
-
-int Maze::GetCellHeight() const
-{
-	return _cellHeight;
-}
-
-bool Maze::GetIsDrawn() const 
-{
-	return _isDrawn;
-}
-
-void Maze::SetIsDrawn(bool state) 
-{
-	_isDrawn = state;
-}
-
-std::vector<GridIndex>* Maze::GetMaze(void)
-{
-	return &_maze;
-}
-
-std::vector<GridIndex>* Maze::GetPath(void)
-{
-	return &_path;
-}
-
-std::vector<Tile>& Maze::GetTiles(void)
-{
-	return _tiles;
-}
-// =======================================
-
-// ====== Private ======
-Maze::Maze()
-{}
\ No newline at end of file
+﻿#include "maze.hpp"
+#include "jobsystem.hpp"
+#include "landmarks.hpp"
+#include "profiler.hpp"
+#include "topology.hpp"
+
+#include <stdlib.h>
+#include <algorithm>
+#include <climits>
+#include <functional>
+
+
+// ======= Public ==========
+Maze::Maze()
+{}
+
+Maze::~Maze()
+{}
+
+void Maze::Swap(Maze& other)
+{
+	std::swap(_mazeSizeWidth, other._mazeSizeWidth);
+	std::swap(_mazeSizeHeight, other._mazeSizeHeight);
+	std::swap(_cellWidth, other._cellWidth);
+	std::swap(_cellHeight, other._cellHeight);
+	std::swap(_isDrawn, other._isDrawn);
+	std::swap(_generatedCells, other._generatedCells);
+	std::swap(_expandedNodes, other._expandedNodes);
+	std::swap(_findPathResult, other._findPathResult);
+	_maze.swap(other._maze);
+	std::swap(_wallPercent, other._wallPercent);
+	std::swap(_maxCost, other._maxCost);
+	std::swap(_generator, other._generator);
+	_path.swap(other._path);
+	std::swap(_version, other._version);
+	std::swap(_pathCache, other._pathCache);
+}
+
+void Maze::InitMaze(int nCellsWidth, int nCellsHeight, int scrnW, int scrnH)
+{
+	_isDrawn = false;
+
+	// Cells are at least one unit wide, so a grid wider than the screen is bigger than it in maze
+	// coordinates instead of getting 0-wide cells (the camera decides how much of it is on screen)
+	// セルは最低１単位、画面より多い列のグリッドは0幅のセルにせず画面より大きくする（表示はカメラが決める）
+	_cellWidth = std::max(1, scrnW / nCellsWidth);
+	_cellHeight = std::max(1, scrnH / nCellsHeight);
+	_mazeSizeWidth = _cellWidth * nCellsWidth;
+	_mazeSizeHeight = _cellHeight * nCellsHeight;
+}
+
+void Maze::GenerateMaze(void)
+{
+	PROFILE_SCOPE("GenerateMaze");
+
+	// Run the sliced version to completion in one go
+	// スライス版を一気に最後まで実行する
+	MazeTask task = GenerateMazeSliced(INT_MAX);
+	while (task.Resume());
+}
+
+void Maze::GenerateMazeParallel(JobSystem& jobs, unsigned int seed)
+{
+	PROFILE_SCOPE("GenerateMazeParallel");
+
+	if (_generator != MazeGeneratorRandom)
+	{
+		srand(seed);
+		GenerateMaze();
+		return;
+	}
+
+	_path.clear();
+	_version++;
+
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	_maze.resize(static_cast<size_t>(gridWidth) * gridHeight);
+
+	jobs.ParallelFor(gridHeight, 16, [this, gridWidth, seed](int rowBegin, int rowEnd)
+	{
+		for (int j = rowBegin; j < rowEnd; j++)
+		{
+			for (int i = 0; i < gridWidth; i++)
+			{
+				int index = j * gridWidth + i;
+
+				// SplitMix64 finalizer on (seed, index)
+				// (seed, index) の SplitMix64
+				uint64_t hash = (static_cast<uint64_t>(seed) << 32) ^ static_cast<uint64_t>(index);
+				hash += 0x9E3779B97F4A7C15ull;
+				hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+				hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+				hash ^= hash >> 31;
+
+				GridIndex& nGrid = _maze[index];
+				nGrid = {};
+				nGrid.x = i;
+				nGrid.y = j;
+				nGrid.parentIndex = -1;
+				bool isWall = !(i == 0 && j == 0) && static_cast<int>(hash % 100) < _wallPercent;
+				nGrid.cost = isWall ? kWallCost : static_cast<unsigned char>(1 + (hash >> 32) % _maxCost);
+			}
+		}
+	});
+	_generatedCells = static_cast<int>(_maze.size());
+}
+
+void Maze::FindPath(int startX, int startY, int endX, int endY)
+{
+	PROFILE_SCOPE("FindPath");
+	MazeTask task = FindPathSliced(startX, startY, endX, endY, INT_MAX);
+	while (task.Resume());
+}
+
+void Maze::ExtractPath(int endIndex)
+{
+	// Count the steps first, then fill from the back so _path reuses its capacity in place
+	// 先に長さを数えて、後ろから埋める。_pathは容量をそのまま使う
+	size_t length = 0;
+	for (int backtrackIndex = endIndex; backtrackIndex != -1; backtrackIndex = _maze.at(backtrackIndex).parentIndex) length++;
+	_path.resize(length);
+
+	// Backtrack from end to start
+	// 果てから初めてのポジションへ後戻る
+	int backtrackIndex = endIndex;
+	while (backtrackIndex != -1)
+	{
+		_path[--length] = _maze.at(backtrackIndex);
+		backtrackIndex = _maze.at(backtrackIndex).parentIndex;
+	}
+}
+
+void Maze::BuildPathMask(std::vector<char>& mask) const
+{
+	// One flag per cell, 1 if the cell is on _path
+	// セルごとのフラグ、_pathにあれば1
+	int gridWidth = _mazeSizeWidth / _cellWidth;
+	mask.assign(_maze.size(), 0);
+	for (const auto& pathCell : _path)
+	{
+		mask[pathCell.y * gridWidth + pathCell.x] = 1;
+	}
+}
+
+const char* Maze::BuildPathMask(MonotonicArena& arena) const
+{
+	int gridWidth = _mazeSizeWidth / _cellWidth;
+	char* mask = arena.AllocateArray<char>(_maze.size());
+	std::fill(mask, mask + _maze.size(), 0);
+	for (const auto& pathCell : _path)
+	{
+		mask[pathCell.y * gridWidth + pathCell.x] = 1;
+	}
+	return mask;
+}
+
+bool Maze::SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverBFS, workspace, path);
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < -1 || endIndex >= cellCount) return false;
+	if (endIndex != -1 && _maze[endIndex].cost == kWallCost) return false;
+
+	workspace.queue.push_back(startIndex);
+	workspace.Visit(startIndex, -1, 0);
+	if (ExpandBFS(workspace, endIndex, false) == -1) return false;
+
+	workspace.ExtractPath(endIndex, path);
+	return true;
+}
+
+int Maze::SolveMultiSourceBFS(const std::vector<int>& sources, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverMultiSourceBFS, workspace, path);
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (endIndex < -1 || endIndex >= cellCount) return -1;
+	if (endIndex != -1 && _maze[endIndex].cost == kWallCost) return -1;
+
+	// Every source goes in at distance 0, marked with its index so the path root tells which one won
+	// 全てのソースは距離0で入る、パスの根がどれか分かるようにインデックスで印を付ける
+	for (int s = 0; s < static_cast<int>(sources.size()); s++)
+	{
+		int sourceIndex = sources[s];
+		if (sourceIndex < 0 || sourceIndex >= cellCount || workspace.IsVisited(sourceIndex)) continue;
+		workspace.queue.push_back(sourceIndex);
+		workspace.Visit(sourceIndex, -1, 0);
+		workspace.MarkTarget(sourceIndex, s);
+	}
+	if (ExpandBFS(workspace, endIndex, false) == -1) return -1;
+
+	workspace.ExtractPath(endIndex, path);
+	return workspace.GetTarget(path.front());
+}
+
+int Maze::FindNearestGoal(int startIndex, const std::vector<int>& goals, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverNearestGoal, workspace, path);
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (startIndex < 0 || startIndex >= cellCount) return -1;
+
+	// Goals are marked up front, the first one the BFS pops is the nearest
+	// ゴールに先に印を付ける、BFSが最初に取り出したゴールが一番近い
+	for (int g = static_cast<int>(goals.size()) - 1; g >= 0; g--)
+	{
+		int goalIndex = goals[g];
+		if (goalIndex >= 0 && goalIndex < cellCount && _maze[goalIndex].cost != kWallCost) workspace.MarkTarget(goalIndex, g);
+	}
+
+	workspace.queue.push_back(startIndex);
+	workspace.Visit(startIndex, -1, 0);
+	int reachedIndex = ExpandBFS(workspace, -1, true);
+	if (reachedIndex == -1) return -1;
+
+	workspace.ExtractPath(reachedIndex, path);
+	return workspace.GetTarget(reachedIndex);
+}
+
+bool Maze::SolveDijkstra(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverDijkstra, workspace, path);
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < -1 || endIndex >= cellCount) return false;
+	if (endIndex != -1 && _maze[endIndex].cost == kWallCost) return false;
+
+	// Dial's bucket queue: every edge costs at most kMaxCellCost, so the open distances
+	// always fit in kMaxCellCost + 1 circular buckets (push and pop are O(1))
+	// Dialのバケットキュー：コストはkMaxCellCost以下なので、kMaxCellCost + 1の循環バケットで足りる
+	constexpr int kBucketCount = kMaxCellCost + 1;
+	SearchVector<SearchVector<int>>& buckets = workspace.buckets;
+	if (buckets.size() < kBucketCount) buckets.resize(kBucketCount);
+	for (auto& bucket : buckets) bucket.clear();
+
+	buckets[0].push_back(startIndex);
+	workspace.Visit(startIndex, -1, 0);
+	int pending = 1;
+	workspace.enqueuedNodes = 1;
+	workspace.peakQueue = 1;
+
+	for (int currDist = 0; pending > 0; currDist++)
+	{
+		SearchVector<int>& bucket = buckets[currDist % kBucketCount];
+		while (!bucket.empty())
+		{
+			int currIndex = bucket.back();
+			bucket.pop_back();
+			pending--;
+
+			// Stale entry, the cell was reached cheaper after it was pushed
+			// 古いエントリ、プッシュした後でもっと安く着いた
+			if (workspace.GetDist(currIndex) != currDist) continue;
+			workspace.expandedNodes++;
+
+			if (currIndex == endIndex)
+			{
+				workspace.ExtractPath(endIndex, path);
+				return true;
+			}
+
+			int currX = currIndex % gridWidth;
+			int currY = currIndex / gridWidth;
+			auto relax = [&](int nextIndex)
+			{
+				int cost = _maze[nextIndex].cost;
+				if (cost == kWallCost) return;
+				int nextDist = currDist + cost;
+				if (workspace.IsVisited(nextIndex) && workspace.GetDist(nextIndex) <= nextDist) return;
+				workspace.Visit(nextIndex, currIndex, nextDist);
+				buckets[nextDist % kBucketCount].push_back(nextIndex);
+				pending++;
+				workspace.enqueuedNodes++;
+				workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(pending));
+			};
+
+			// Left, right, up, down
+			// 左、右、上、下
+			if (currX > 0) relax(currIndex - 1);
+			if (currX < gridWidth - 1) relax(currIndex + 1);
+			if (currY > 0) relax(currIndex - gridWidth);
+			if (currY < gridHeight - 1) relax(currIndex + gridWidth);
+		}
+	}
+
+	return false;
+}
+
+bool Maze::SolveDijkstraHeap(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverDijkstraHeap, workspace, path);
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+	if (_maze[endIndex].cost == kWallCost) return false;
+
+	// Binary min-heap of (dist, index) with lazy deletion, the O(log n) baseline for SolveDijkstra
+	// (dist, index)のバイナリヒープ、SolveDijkstraと比べるためのO(log n)版
+	SearchVector<std::pair<int, int>>& heap = workspace.heap;
+	auto isGreater = std::greater<std::pair<int, int>>();
+	heap.clear();
+	heap.push_back({ 0, startIndex });
+	workspace.Visit(startIndex, -1, 0);
+	workspace.enqueuedNodes = 1;
+	workspace.peakQueue = 1;
+
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), isGreater);
+		auto [currDist, currIndex] = heap.back();
+		heap.pop_back();
+
+		if (workspace.GetDist(currIndex) != currDist) continue;
+		workspace.expandedNodes++;
+
+		if (currIndex == endIndex)
+		{
+			workspace.ExtractPath(endIndex, path);
+			return true;
+		}
+
+		int currX = currIndex % gridWidth;
+		int currY = currIndex / gridWidth;
+		auto relax = [&](int nextIndex)
+		{
+			int cost = _maze[nextIndex].cost;
+			if (cost == kWallCost) return;
+			int nextDist = currDist + cost;
+			if (workspace.IsVisited(nextIndex) && workspace.GetDist(nextIndex) <= nextDist) return;
+			workspace.Visit(nextIndex, currIndex, nextDist);
+			heap.push_back({ nextDist, nextIndex });
+			std::push_heap(heap.begin(), heap.end(), isGreater);
+			workspace.enqueuedNodes++;
+			workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(heap.size()));
+		};
+
+		if (currX > 0) relax(currIndex - 1);
+		if (currX < gridWidth - 1) relax(currIndex + 1);
+		if (currY > 0) relax(currIndex - gridWidth);
+		if (currY < gridHeight - 1) relax(currIndex + gridWidth);
+	}
+
+	return false;
+}
+
+bool Maze::SolveAStar(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverAStar, workspace, path);
+	int gridWidth = GetGridWidth();
+	int endX = endIndex % gridWidth;
+	int endY = endIndex / gridWidth;
+	return SolveAStarWith(startIndex, endIndex, workspace, path, [=](int index)
+	{
+		return std::abs(index % gridWidth - endX) + std::abs(index / gridWidth - endY);
+	});
+}
+
+bool Maze::SolveAStar(int startIndex, int endIndex, const LandmarkTable& landmarks, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverAStarALT, workspace, path);
+	int cellCount = static_cast<int>(_maze.size());
+	int endCost = (endIndex >= 0 && endIndex < cellCount) ? _maze[endIndex].cost : 0;
+	return SolveAStarWith(startIndex, endIndex, workspace, path, [this, &landmarks, endIndex, endCost](int index)
+	{
+		return landmarks.LowerBound(index, endIndex, endCost - _maze[index].cost);
+	});
+}
+
+bool Maze::SolveBFSParallel(JobSystem& jobs, int startIndex, int endIndex, FrontierWorkspace& workspace, std::vector<int>& path) const
+{
+	PROFILE_SCOPE("SolveBFSParallel");
+	SearchTelemetryScope telemetry(TelemetrySolverBFSParallel, workspace, path);
+
+	// Beamer's thresholds: go bottom-up once the frontier is a big share of what is left,
+	// back to top-down once it shrinks again (edge counts ~ 4 * cells on a grid, so cells are used)
+	// Beamerのしきい値
+	constexpr long long kAlpha = 14;
+	constexpr long long kBeta = 24;
+
+	// Small top-down levels run on the calling thread, a job round trip costs more than the level
+	// 小さいトップダウンのレベルは呼び出し元のスレッドで実行する
+	constexpr long long kSerialFrontier = 1024;
+
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	int cellCount = static_cast<int>(_maze.size());
+	int chunkCount = std::max(1, jobs.GetWorkerCount() * 8);
+
+	path.clear();
+	workspace.Prepare(cellCount, chunkCount);
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < -1 || endIndex >= cellCount) return false;
+	if (endIndex != -1 && _maze[endIndex].cost == kWallCost) return false;
+
+	// Clear in 64-cell aligned chunks so no two chunks share a bitmap word, count open cells on the way
+	// ビットマップのワードを共有しないように64セル単位でクリアする
+	std::atomic<long long> openCells = 0;
+	int clearGrain = std::max(64, (cellCount / chunkCount + 63) / 64 * 64);
+	jobs.ParallelFor(cellCount, clearGrain, [&](int begin, int end)
+	{
+		workspace.ClearRange(begin, end);
+		long long open = 0;
+		for (int i = begin; i < end; i++) open += _maze[i].cost != kWallCost;
+		openCells += open;
+	});
+
+	SearchVector<int>& frontier = workspace.frontier;
+	SearchVector<SearchVector<int>>& nextChunks = workspace.nextChunks;
+	workspace.TryVisit(startIndex);
+	workspace.SetDist(startIndex, 0);
+	frontier.push_back(startIndex);
+	workspace.enqueuedNodes = 1;
+	long long unvisitedCells = openCells - 1;
+	bool isBottomUp = false;
+
+	while (!frontier.empty())
+	{
+		if (endIndex != -1 && workspace.IsVisited(endIndex)) break;
+
+		int nextDist = workspace.levels + 1;
+		long long frontierSize = static_cast<long long>(frontier.size());
+		workspace.peakQueue = std::max(workspace.peakQueue, frontierSize);
+		if (!isBottomUp && frontierSize * kAlpha > unvisitedCells) isBottomUp = true;
+		else if (isBottomUp && frontierSize * kBeta < openCells) isBottomUp = false;
+
+		for (int c = 0; c < chunkCount; c++) nextChunks[c].clear();
+
+		if (!isBottomUp)
+		{
+			// Top-down: every frontier cell claims its unvisited neighbours
+			// トップダウン：フロンティアのセルが未訪問の隣を取る
+			int grain = static_cast<int>((frontierSize + chunkCount - 1) / chunkCount);
+			auto expand = [&](int begin, int end)
+			{
+				SearchVector<int>& next = nextChunks[begin / grain];
+				auto visit = [&](int index)
+				{
+					if (_maze[index].cost == kWallCost || workspace.IsVisited(index) || !workspace.TryVisit(index)) return;
+					workspace.SetDist(index, nextDist);
+					next.push_back(index);
+				};
+				for (int f = begin; f < end; f++)
+				{
+					int currIndex = frontier[f];
+					int currX = currIndex % gridWidth;
+					int currY = currIndex / gridWidth;
+					if (currX > 0) visit(currIndex - 1);
+					if (currX < gridWidth - 1) visit(currIndex + 1);
+					if (currY > 0) visit(currIndex - gridWidth);
+					if (currY < gridHeight - 1) visit(currIndex + gridWidth);
+				}
+			};
+			if (frontierSize <= kSerialFrontier) expand(0, static_cast<int>(frontierSize));
+			else jobs.ParallelFor(static_cast<int>(frontierSize), grain, expand);
+			workspace.topDownLevels++;
+		}
+		else
+		{
+			// Bottom-up: every unvisited cell looks for a parent on the current level, whole rows per chunk
+			// ボトムアップ：未訪問のセルが今のレベルの親を探す
+			int level = nextDist - 1;
+			int grain = std::max(gridWidth, (cellCount + chunkCount - 1) / chunkCount);
+			jobs.ParallelFor(cellCount, grain, [&](int begin, int end)
+			{
+				SearchVector<int>& next = nextChunks[begin / grain];
+				for (int currIndex = begin; currIndex < end; currIndex++)
+				{
+					if (_maze[currIndex].cost == kWallCost || workspace.IsVisited(currIndex)) continue;
+
+					int currX = currIndex % gridWidth;
+					int currY = currIndex / gridWidth;
+					if ((currX > 0 && workspace.GetDist(currIndex - 1) == level) ||
+						(currX < gridWidth - 1 && workspace.GetDist(currIndex + 1) == level) ||
+						(currY > 0 && workspace.GetDist(currIndex - gridWidth) == level) ||
+						(currY < gridHeight - 1 && workspace.GetDist(currIndex + gridWidth) == level))
+					{
+						workspace.TryVisit(currIndex);
+						workspace.SetDist(currIndex, nextDist);
+						next.push_back(currIndex);
+					}
+				}
+			});
+			workspace.bottomUpLevels++;
+		}
+		workspace.expandedNodes += frontierSize;
+
+		// Concatenate the per-chunk outputs into the next frontier
+		// チャンクごとの結果を次のフロンティアにつなげる
+		std::vector<size_t> offsets(chunkCount + 1, 0);
+		for (int c = 0; c < chunkCount; c++) offsets[c + 1] = offsets[c] + nextChunks[c].size();
+		frontier.resize(offsets[chunkCount]);
+		auto gather = [&](int begin, int end)
+		{
+			for (int c = begin; c < end; c++)
+			{
+				std::copy(nextChunks[c].begin(), nextChunks[c].end(), frontier.begin() + offsets[c]);
+			}
+		};
+		if (static_cast<long long>(frontier.size()) <= kSerialFrontier) gather(0, chunkCount);
+		else jobs.ParallelFor(chunkCount, 1, gather);
+		unvisitedCells -= static_cast<long long>(frontier.size());
+		workspace.enqueuedNodes += static_cast<long long>(frontier.size());
+		workspace.levels++;
+	}
+
+	if (endIndex == -1 || !workspace.IsVisited(endIndex)) return false;
+
+	// Walk back down the distances, first neighbour one step closer wins
+	// 距離を下りながら戻る、１つ近い最初の隣を選ぶ
+	for (int currIndex = endIndex; ; )
+	{
+		path.push_back(currIndex);
+		int dist = workspace.GetDist(currIndex);
+		if (dist == 0) break;
+
+		int currX = currIndex % gridWidth;
+		int currY = currIndex / gridWidth;
+		if (currX > 0 && workspace.GetDist(currIndex - 1) == dist - 1) currIndex -= 1;
+		else if (currX < gridWidth - 1 && workspace.GetDist(currIndex + 1) == dist - 1) currIndex += 1;
+		else if (currY > 0 && workspace.GetDist(currIndex - gridWidth) == dist - 1) currIndex -= gridWidth;
+		else currIndex += gridWidth;
+	}
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+MazeTask Maze::GenerateMazeSliced(int cellsPerSlice)
+{
+	_maze.clear();
+	_path.clear();
+	_generatedCells = 0;
+	_version++;
+
+	// Regenerating at the same size reuses the old storage, a new size allocates once up front
+	// 同じサイズで作り直すなら前の領域を使う、新しいサイズなら最初に１回だけ確保する
+	_maze.reserve(static_cast<size_t>(GetGridWidth()) * GetGridHeight());
+
+	for (int j = 0; j < (_mazeSizeHeight / _cellHeight); j++) {
+		for (int i = 0; i < (_mazeSizeWidth / _cellWidth); i++)
+		{
+			GridIndex nGrid = {};
+
+			if (_generator == MazeGeneratorBacktracker)
+			{
+				// Everything starts as wall, the backtracker carves it out below
+				// 全部壁から始めて、下でバックトラッカーが掘る
+				nGrid.cost = kWallCost;
+			}
+			else
+			{
+				int nRan = rand() % 100;
+
+				if ((i == 0 && j == 0) || (nRan >= _wallPercent))  nGrid.cost = RollCellCost();
+				else									nGrid.cost = kWallCost;
+			}
+
+			nGrid.x = i;
+			nGrid.y = j;
+			nGrid.visited = false;
+			nGrid.distFromStart = 0;
+			_maze.push_back(nGrid);
+
+			if (++_generatedCells % cellsPerSlice == 0) co_await std::suspend_always{};
+		}
+	}
+
+	if (_generator != MazeGeneratorBacktracker) co_return;
+
+	// Recursive backtracker with an explicit stack, rooms are the cells with even x and y
+	// 明示的なスタックのバックトラッカー、部屋はxとyが偶数のセル
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	constexpr int dirs[4][2] = { {-2, 0}, {2, 0}, {0, -2}, {0, 2} };
+
+	std::vector<int> stack;
+	stack.push_back(0);
+	_maze.at(0).cost = 1;
+	int carved = 0;
+
+	while (!stack.empty())
+	{
+		int currIndex = stack.back();
+		int currX = currIndex % gridWidth;
+		int currY = currIndex / gridWidth;
+
+		// Collect the unvisited rooms around the current one
+		// 周りのまだ掘っていない部屋を集める
+		int options[4];
+		int nOptions = 0;
+		for (const auto& dir : dirs)
+		{
+			int newX = currX + dir[0];
+			int newY = currY + dir[1];
+			if (newX >= 0 && newX < gridWidth && newY >= 0 && newY < gridHeight && _maze.at(newY * gridWidth + newX).cost == kWallCost)
+			{
+				options[nOptions++] = newY * gridWidth + newX;
+			}
+		}
+
+		if (nOptions == 0)
+		{
+			stack.pop_back();
+			continue;
+		}
+
+		// Knock down the wall in between and move on
+		// 間の壁を壊して進む
+		int nextIndex = options[rand() % nOptions];
+		_maze.at((currIndex + nextIndex) / 2).cost = 1;
+		_maze.at(nextIndex).cost = 1;
+		stack.push_back(nextIndex);
+
+		if (++carved % cellsPerSlice == 0) co_await std::suspend_always{};
+	}
+
+	// Terrain on the carved corridors
+	// 掘った通路に地形コストを付ける
+	if (_maxCost > 1)
+	{
+		for (auto& grid : _maze)
+		{
+			if (grid.cost != kWallCost) grid.cost = RollCellCost();
+		}
+	}
+}
+
+MazeTask Maze::FindPathSliced(int startX, int startY, int endX, int endY, int expansionsPerSlice)
+{
+	_expandedNodes = 0;
+	_path.clear();
+
+	// Counters go to Telemetry whenever the task ends (returned, finished or destroyed mid-search)
+	// タスクが終わった時（戻った、完了した、途中で破棄された）にカウンターをTelemetryに足す
+	SearchCounters counters;
+	SearchTelemetryScope telemetry(TelemetrySolverFindPath, counters, _path);
+	auto finish = [this](FindPathResult result)
+	{
+		_findPathResult = result;
+		Telemetry::GetInstance().RecordFindPath(result);
+	};
+
+	// Convert screen coords -> grid coords
+	// 画面座標 -> グリッド座標に変更する
+	int startGridX = startX / _cellWidth;
+	int startGridY = startY / _cellHeight;
+	int endGridX = endX / _cellWidth;
+	int endGridY = endY / _cellHeight;
+
+	// Get grid dimensions
+	// グリッドサイズを取って
+	int gridWidth = _mazeSizeWidth / _cellWidth;
+	int gridHeight = _mazeSizeHeight / _cellHeight;
+
+	// Bounds check using lambda function
+	// lamba functionで画面の限定確認
+	auto isInBounds = [gridWidth, gridHeight](int x, int y) 
+	{
+		return x >= 0 && x < gridWidth && y >= 0 && y < gridHeight;
+	};
+
+	if (!isInBounds(startGridX, startGridY) || !isInBounds(endGridX, endGridY)) 
+	{
+		std::cerr << "FindPath: Start or end position out of bounds\n";
+		finish(FindPathOutOfBounds);
+		co_return;
+	}
+
+	int endIndex = endGridY * gridWidth + endGridX;
+	if (endIndex >= static_cast<int>(_maze.size())) 
+	{
+		std::cerr << "FindPath: End index out of bounds: " << endIndex << " >= " << _maze.size() << "\n";
+		finish(FindPathOutOfBounds);
+		co_return;
+	}
+
+	// Check Wall
+	// 壁場合を確認
+	if (_maze.at(endIndex).cost == kWallCost) 
+	{
+		std::cerr << "FindPath: Cannot pathfind to a wall tile at grid position: " << endGridX << ", " << endGridY << " (index " << endIndex << ")\n";
+		finish(FindPathWallGoal);
+		co_return;
+	}
+
+	// Convert start position to 1D array index
+	// 初めてのポジション -> 1D アレイ index
+	int startIndex = startGridY * gridWidth + startGridX;
+	if (_maze.at(startIndex).cost == kWallCost) SetWall(startIndex, false);
+	uint64_t searchVersion = _version;
+
+	// Same pair on the same maze version, rebuild _path from the cache without searching
+	// 同じバージョンで同じペア、探索せずにキャッシュから_pathを作り直す
+	_cachedPath.clear();
+	if (_pathCache.Find(searchVersion, startIndex, endIndex, _cachedPath))
+	{
+		_path.resize(_cachedPath.size());
+		for (size_t i = 0; i < _cachedPath.size(); i++)
+		{
+			GridIndex& pathCell = _path[i];
+			pathCell = _maze[_cachedPath[i]];
+			pathCell.visited = true;
+			pathCell.distFromStart = static_cast<int>(i);
+			pathCell.parentIndex = (i > 0) ? _cachedPath[i - 1] : -1;
+		}
+		finish(FindPathCached);
+		co_return;
+	}
+
+	// Reset the search state so FindPath can run more than once on the same maze
+	// 同じメイズで何回もFindPathできるように検索状態をリセットする
+	for (auto& grid : _maze)
+	{
+		grid.visited = false;
+		grid.distFromStart = 0;
+		grid.parentIndex = -1;
+	}
+
+	// Initialize start position, the queue is a flat array in the query arena (every cell is enqueued at most once)
+	// 初めてのポジションをイニシャライズ、キューはクエリのアリーナの配列（セルは最大１回だけ入る）
+	_queryArena.Reset();
+	int* pathQ = _queryArena.AllocateArray<int>(_maze.size());
+	int queueHead = 0;
+	int queueTail = 0;
+	pathQ[queueTail++] = startIndex;
+	counters.enqueuedNodes = 1;
+	_maze.at(startIndex).visited = true;
+	_maze.at(startIndex).parentIndex = -1;
+
+	// BFS loop
+	// BFS ループ
+	while (queueHead < queueTail)
+	{
+		counters.peakQueue = std::max(counters.peakQueue, static_cast<long long>(queueTail - queueHead));
+		int currIndex = pathQ[queueHead++];
+
+		GridIndex& currGrid = _maze.at(currIndex);
+		_expandedNodes++;
+		counters.expandedNodes++;
+
+		// Check if we reached the end
+		// 果てのポイントを確認
+		if (currGrid.x == endGridX && currGrid.y == endGridY)
+		{
+			ExtractPath(currIndex);
+			if (_pathCache.GetCapacity() > 0)
+			{
+				for (const auto& pathCell : _path) _cachedPath.push_back(pathCell.y * gridWidth + pathCell.x);
+				_pathCache.Insert(searchVersion, startIndex, endIndex, _cachedPath, gridWidth);
+			}
+			finish(FindPathFound);
+			co_return;
+		}
+
+		// Check neighbours, offsets come from the compile-time 4-connected topology
+		// グリッド隣人を確認、オフセットはコンパイル時の４方向トポロジーから
+		for (int n = 0; n < Topology4::kNeighborCount; n++)
+		{
+			int newX = currGrid.x + Topology4::kDx[0][n];
+			int newY = currGrid.y + Topology4::kDy[0][n];
+
+			if (isInBounds(newX, newY))
+			{
+				GridIndex& neighbor = _maze[newY * gridWidth + newX];
+				if (!neighbor.visited && neighbor.cost != kWallCost)
+				{
+					neighbor.visited = true;
+					neighbor.distFromStart = currGrid.distFromStart + 1;
+					neighbor.parentIndex = currIndex;
+					pathQ[queueTail++] = newY * gridWidth + newX;
+					counters.enqueuedNodes++;
+				}
+			}
+		}
+
+		if (_expandedNodes % expansionsPerSlice == 0) co_await std::suspend_always{};
+	}
+
+	// Unreachable is cached too (as an empty path), only opening a cell can change it
+	// 届かないこともキャッシュする（空のパス）、変わるのはセルが開いた時だけ
+	_pathCache.Insert(searchVersion, startIndex, endIndex, _cachedPath, gridWidth);
+	finish(FindPathUnreachable);
+}
+
+
+int Maze::GetMazeWidth() const
+{
+	return _mazeSizeWidth;
+}
+
+int Maze::GetMazeHeight() const
+{
+	return _mazeSizeHeight;
+}
+
+int Maze::GetCellWidth() const
+{
+	return _cellWidth;
+}
+
+int Maze::GetCellHeight() const
+{
+	return _cellHeight;
+}
+
+int Maze::GetGridWidth() const
+{
+	return _mazeSizeWidth / _cellWidth;
+}
+
+int Maze::GetGridHeight() const
+{
+	return _mazeSizeHeight / _cellHeight;
+}
+
+int Maze::GetCellCount() const
+{
+	return static_cast<int>(_maze.size());
+}
+
+bool Maze::IsWall(int index) const
+{
+	return _maze[index].cost == kWallCost;
+}
+
+void Maze::SetWall(int index, bool isWall)
+{
+	if (isWall == (_maze[index].cost == kWallCost)) return;
+	if (isWall)
+	{
+		_maze[index].cost = kWallCost;
+		_pathCache.InvalidateCell(index, GetGridWidth());
+	}
+	else
+	{
+		_maze[index].cost = 1;
+		_version++;
+	}
+}
+
+void Maze::BumpVersion()
+{
+	_version++;
+}
+
+uint64_t Maze::GetVersion() const
+{
+	return _version;
+}
+
+PathCache& Maze::GetPathCache()
+{
+	return _pathCache;
+}
+
+unsigned char Maze::GetCost(int index) const
+{
+	return _maze[index].cost;
+}
+
+int Maze::GetGeneratedCells() const
+{
+	return _generatedCells;
+}
+
+int Maze::GetExpandedNodes() const
+{
+	return _expandedNodes;
+}
+
+FindPathResult Maze::GetFindPathResult() const
+{
+	return _findPathResult;
+}
+
+int Maze::GetMaxCost() const
+{
+	return _maxCost;
+}
+
+void Maze::SetMaxCost(int maxCost)
+{
+	_maxCost = std::clamp(maxCost, 1, static_cast<int>(kMaxCellCost));
+}
+
+int Maze::GetWallPercent() const
+{
+	return _wallPercent;
+}
+
+void Maze::SetWallPercent(int wallPercent)
+{
+	_wallPercent = wallPercent;
+}
+
+MazeGeneratorType Maze::GetGenerator() const
+{
+	return _generator;
+}
+
+void Maze::SetGenerator(MazeGeneratorType generator)
+{
+	_generator = generator;
+}
+
+bool Maze::GetIsDrawn() const 
+{
+	return _isDrawn;
+}
+
+void Maze::SetIsDrawn(bool state) 
+{
+	_isDrawn = state;
+}
+
+GridVector* Maze::GetMaze(void)
+{
+	return &_maze;
+}
+
+GridVector* Maze::GetPath(void)
+{
+	return &_path;
+}
+// =======================================
+
+// ====== Private ======
+int Maze::ExpandBFS(SearchWorkspace& workspace, int endIndex, bool isStoppingAtTarget) const
+{
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+
+	// The queue is a flat vector with a read cursor, reused between queries
+	// キューはフラットなベクター、クエリ間で再利用する
+	SearchVector<int>& queue = workspace.queue;
+	size_t peakQueue = 0;
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int currIndex = queue[head];
+		workspace.expandedNodes++;
+		peakQueue = std::max(peakQueue, queue.size() - head);
+
+		if (currIndex == endIndex || (isStoppingAtTarget && workspace.GetTarget(currIndex) != -1))
+		{
+			workspace.enqueuedNodes = static_cast<long long>(queue.size());
+			workspace.peakQueue = static_cast<long long>(peakQueue);
+			return currIndex;
+		}
+
+		int currX = currIndex % gridWidth;
+		int currY = currIndex / gridWidth;
+		int nextDist = workspace.GetDist(currIndex) + 1;
+
+		// Left, right, up, down
+		// 左、右、上、下
+		if (currX > 0 && _maze[currIndex - 1].cost != kWallCost && !workspace.IsVisited(currIndex - 1))
+		{
+			workspace.Visit(currIndex - 1, currIndex, nextDist);
+			queue.push_back(currIndex - 1);
+		}
+		if (currX < gridWidth - 1 && _maze[currIndex + 1].cost != kWallCost && !workspace.IsVisited(currIndex + 1))
+		{
+			workspace.Visit(currIndex + 1, currIndex, nextDist);
+			queue.push_back(currIndex + 1);
+		}
+		if (currY > 0 && _maze[currIndex - gridWidth].cost != kWallCost && !workspace.IsVisited(currIndex - gridWidth))
+		{
+			workspace.Visit(currIndex - gridWidth, currIndex, nextDist);
+			queue.push_back(currIndex - gridWidth);
+		}
+		if (currY < gridHeight - 1 && _maze[currIndex + gridWidth].cost != kWallCost && !workspace.IsVisited(currIndex + gridWidth))
+		{
+			workspace.Visit(currIndex + gridWidth, currIndex, nextDist);
+			queue.push_back(currIndex + gridWidth);
+		}
+	}
+
+	workspace.enqueuedNodes = static_cast<long long>(queue.size());
+	workspace.peakQueue = static_cast<long long>(peakQueue);
+	return -1;
+}
+
+template <typename Heuristic>
+bool Maze::SolveAStarWith(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path, Heuristic heuristic) const
+{
+	int gridWidth = GetGridWidth();
+	int gridHeight = GetGridHeight();
+	int cellCount = static_cast<int>(_maze.size());
+
+	path.clear();
+	workspace.Prepare(cellCount);
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+	if (_maze[endIndex].cost == kWallCost) return false;
+
+	// Min-heap of (dist + heuristic, index) with lazy deletion, the heuristic is consistent
+	// so a cell popped with its current f is final
+	// (距離 + ヒューリスティック, index)のヒープ、ヒューリスティックは一貫しているので最新のfで出たセルは確定
+	SearchVector<std::pair<int, int>>& heap = workspace.heap;
+	auto isGreater = std::greater<std::pair<int, int>>();
+	heap.clear();
+	heap.push_back({ heuristic(startIndex), startIndex });
+	workspace.Visit(startIndex, -1, 0);
+	workspace.enqueuedNodes = 1;
+	workspace.peakQueue = 1;
+
+	while (!heap.empty())
+	{
+		std::pop_heap(heap.begin(), heap.end(), isGreater);
+		auto [currF, currIndex] = heap.back();
+		heap.pop_back();
+
+		int currDist = workspace.GetDist(currIndex);
+		if (currDist + heuristic(currIndex) != currF) continue;
+		workspace.expandedNodes++;
+
+		if (currIndex == endIndex)
+		{
+			workspace.ExtractPath(endIndex, path);
+			return true;
+		}
+
+		int currX = currIndex % gridWidth;
+		int currY = currIndex / gridWidth;
+		auto relax = [&](int nextIndex)
+		{
+			int cost = _maze[nextIndex].cost;
+			if (cost == kWallCost) return;
+			int nextDist = currDist + cost;
+			if (workspace.IsVisited(nextIndex) && workspace.GetDist(nextIndex) <= nextDist) return;
+			workspace.Visit(nextIndex, currIndex, nextDist);
+			heap.push_back({ nextDist + heuristic(nextIndex), nextIndex });
+			std::push_heap(heap.begin(), heap.end(), isGreater);
+			workspace.enqueuedNodes++;
+			workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(heap.size()));
+		};
+
+		if (currX > 0) relax(currIndex - 1);
+		if (currX < gridWidth - 1) relax(currIndex + 1);
+		if (currY > 0) relax(currIndex - gridWidth);
+		if (currY < gridHeight - 1) relax(currIndex + gridWidth);
+	}
+
+	return false;
+}
+
+unsigned char Maze::RollCellCost(void) const
+{
+	// rand() is only drawn for terrain, so flat mazes come out the same as before costs existed
+	// rand()は地形の時だけ使う、平らなメイズは前と同じになる
+	if (_maxCost <= 1) return 1;
+	return static_cast<unsigned char>(1 + rand() % _maxCost);
+}
\ No newline at end of file
@@ -1,66 +1,206 @@
-﻿#pragma once
-#include <iostream>
-#include <vector>
-#include <memory>
-
-typedef struct GridIndex 
-{
-	int x;
-	int y;
-	int distFromStart;
-	int parentIndex;
-	bool visited;
-	bool isWall;
-};
-
-// Forward declaration of other classes
-// 前のクラス表明
-class Canvas;
-class Tile;
-
-class Maze 
-{
-public:
-	Maze(const Maze&) = delete;
-	Maze& operator=(const Maze&) = delete;
-
-	// Meyers' Singleton
-	static Maze& GetInstance(void)
-	{
-		static Maze instance;
-		return instance;
-	}
-	~Maze(void);
-	
-	void InitMaze(int nCellsWidth, int nCellsHeight, int scrnW, int scrnH);
-	void GenerateMaze(Canvas* canvas);
-	void FindPath(int startX, int startY, int endX, int endY);
-	void GeneratePath(Canvas* canvas);
-
-	
-	int GetMazeWidth(void) const;
-	int GetMazeHeight(void) const;
-	int GetCellWidth(void) const;
-	int GetCellHeight(void) const;
-	bool GetIsDrawn(void) const;
-	void SetIsDrawn(bool state);
-	std::vector<GridIndex>* GetMaze(void);
-	std::vector<GridIndex>* GetPath(void);
-	std::vector<Tile>& GetTiles(void);
-
-private:
-	Maze(void);
-
-	static Maze* _mazePtr;
-
-	int _mazeSizeWidth;
-	int _mazeSizeHeight;
-	int _cellWidth;
-	int _cellHeight;
-
-	bool _isDrawn = false;
-
-	std::vector<GridIndex> _maze;
-	std::vector<GridIndex> _path;
-	std::vector<Tile> _tiles;
+﻿#pragma once
+#include <iostream>
+#include <vector>
+#include <memory>
+
+#include "arena.hpp"
+#include "mazetask.hpp"
+#include "pathcache.hpp"
+#include "searchworkspace.hpp"
+#include "telemetry.hpp"
+
+// Traversal cost of stepping onto a cell, 0 is a wall
+// セルに入るコスト、0は壁
+constexpr unsigned char kWallCost = 0;
+constexpr unsigned char kMaxCellCost = 255;
+
+typedef struct GridIndex 
+{
+	int x;
+	int y;
+	int distFromStart;
+	int parentIndex;
+	bool visited;
+	unsigned char cost;		// kWallCost or 1..kMaxCellCost
+};
+
+typedef enum MazeGeneratorType 
+{
+	MazeGeneratorRandom,		// Independent random walls (wall percent)
+	MazeGeneratorBacktracker	// Perfect maze, recursive backtracker on even cells
+};
+
+// Forward declaration of other classes
+// 前のクラス表明
+class JobSystem;
+class LandmarkTable;
+
+// The grid and the path are counted under their own Telemetry subsystem
+// グリッドとパスはそれぞれのTelemetryのサブシステムとして数える
+using GridVector = TrackedVector<GridIndex, TelemetryMemoryMaze>;
+
+/*
+	The grid, generation and solvers, nothing here touches DirectX / SDL, so MAZE_HEADLESS builds
+	(benchmarks and batch tools) use it as is. Drawing goes through CellPyramid and TileBatch
+	グリッド、生成、ソルバー、DirectX / SDLには触らないのでMAZE_HEADLESSのビルドでもそのまま使う
+	描画はCellPyramidとTileBatchから
+*/
+
+class Maze 
+{
+public:
+	Maze(void);
+	Maze(const Maze&) = delete;
+	Maze& operator=(const Maze&) = delete;
+
+	// Meyers' Singleton
+	static Maze& GetInstance(void)
+	{
+		static Maze instance;
+		return instance;
+	}
+	~Maze(void);
+
+	// Exchanges the whole maze set (grid, path and settings) with another Maze
+	// 他のMazeと全てのデータを交換する
+	void Swap(Maze& other);
+	
+	// Cell size is scrnW / nCellsWidth (at least 1), FindPath takes coordinates in that unit
+	// セルのサイズはscrnW / nCellsWidth（最低1）、FindPathはその単位の座標を使う
+	void InitMaze(int nCellsWidth, int nCellsHeight, int scrnW, int scrnH);
+	void GenerateMaze(void);
+
+	// Row chunks are generated on the job system, walls come from a per-cell hash of the seed
+	// so the maze is the same for any worker count (the backtracker falls back to serial)
+	// 行のチャンクをジョブシステムで作る、壁はシードのセルごとのハッシュなのでワーカー数に関係なく同じ
+	void GenerateMazeParallel(JobSystem& jobs, unsigned int seed);
+	// BFS from start to end in screen coords, answered from the path cache when the same pair
+	// was solved on the same maze version, GetFindPathResult tells how it ended
+	// 画面座標でスタートからゴールまでのBFS、同じバージョンで同じペアを解いていたらキャッシュから
+	void FindPath(int startX, int startY, int endX, int endY);
+	void ExtractPath(int endIndex);
+	void BuildPathMask(std::vector<char>& mask) const;
+	// Same mask in the arena, one char per cell
+	// 同じマスクをアリーナに、セルごとに１文字
+	const char* BuildPathMask(MonotonicArena& arena) const;
+
+	// Read-only BFS on grid indices, all state lives in the workspace (thread-safe per workspace)
+	// Returns false if endIndex can't be reached, endIndex -1 fills the distances of every reachable cell
+	// 読み取り専用のBFS、状態は全部ワークスペースにある。endIndex -1で全ての到達できるセルの距離を出す
+	bool SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// Multi-source BFS: every source starts at distance 0, so one traversal gives every cell's distance
+	// to its nearest source. Returns the index in sources of the source nearest to endIndex
+	// (path runs source -> end), -1 if none reaches it. endIndex -1 fills the whole distance field
+	// 複数ソースのBFS：全てのソースが距離0から始まる、１回の探索で一番近いソースへの距離が出る
+	int SolveMultiSourceBFS(const std::vector<int>& sources, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// Nearest of several goals in one traversal, returns the index in goals of the goal reached
+	// (path runs start -> goal), -1 if none can be reached
+	// １回の探索で一番近いゴール、着いたゴールのgoalsでのインデックスを返す
+	int FindNearestGoal(int startIndex, const std::vector<int>& goals, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// Level-synchronous BFS on the job system for single huge queries, switches between
+	// top-down and bottom-up levels by frontier size (Beamer's direction-optimizing BFS)
+	// Gives the same distances as SolveBFS, the path may pick a different (equally short) route
+	// 巨大なクエリ用の並列BFS、フロンティアの大きさでトップダウンとボトムアップを切り替える
+	// SolveBFSと同じ距離になる、パスは同じ長さの別のルートかもしれない
+	bool SolveBFSParallel(JobSystem& jobs, int startIndex, int endIndex, FrontierWorkspace& workspace, std::vector<int>& path) const;
+
+	// Cheapest path by cell cost, Dial's bucket queue (O(1) push / pop for small integer costs)
+	// and a binary-heap version to compare against, the distance is the sum of the entered cells' costs
+	// SolveDijkstra with endIndex -1 fills the cost of every reachable cell
+	// セルコストで一番安いパス、Dialのバケットキューとバイナリヒープ版
+	bool SolveDijkstra(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+	bool SolveDijkstraHeap(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// A* by cell cost, Manhattan distance or the landmark (ALT) lower bound as the heuristic
+	// Both are admissible because every floor cell costs at least 1, so the cost matches SolveDijkstra
+	// セルコストのA*、マンハッタン距離かランドマーク（ALT）の下限がヒューリスティック
+	bool SolveAStar(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+	bool SolveAStar(int startIndex, int endIndex, const LandmarkTable& landmarks, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// Time-sliced versions, suspend every N cells / expansions
+	// タイムスライス版、Nセルごとにサスペンドする
+	MazeTask GenerateMazeSliced(int cellsPerSlice);
+	MazeTask FindPathSliced(int startX, int startY, int endX, int endY, int expansionsPerSlice);
+
+	
+	int GetMazeWidth(void) const;
+	int GetMazeHeight(void) const;
+	int GetCellWidth(void) const;
+	int GetCellHeight(void) const;
+	int GetGridWidth(void) const;
+	int GetGridHeight(void) const;
+	int GetCellCount(void) const;
+	bool IsWall(int index) const;
+	// Wall edits go through here so the path cache stays valid: opening a cell bumps the version
+	// (any route may get shorter), a new wall only drops the cached paths that cross it
+	// Writing cells through GetMaze() bypasses this, call BumpVersion afterwards
+	// 壁の編集はここから：セルを開くとバージョンが上がる、新しい壁はその上を通るパスだけを消す
+	void SetWall(int index, bool isWall);
+	void BumpVersion(void);
+	uint64_t GetVersion(void) const;
+	PathCache& GetPathCache(void);
+	unsigned char GetCost(int index) const;
+	int GetGeneratedCells(void) const;
+	int GetExpandedNodes(void) const;
+	FindPathResult GetFindPathResult(void) const;
+	int GetMaxCost(void) const;
+	void SetMaxCost(int maxCost);
+	int GetWallPercent(void) const;
+	void SetWallPercent(int wallPercent);
+	MazeGeneratorType GetGenerator(void) const;
+	void SetGenerator(MazeGeneratorType generator);
+	bool GetIsDrawn(void) const;
+	void SetIsDrawn(bool state);
+	GridVector* GetMaze(void);
+	GridVector* GetPath(void);
+
+private:
+	static Maze* _mazePtr;
+
+	int _mazeSizeWidth;
+	int _mazeSizeHeight;
+	int _cellWidth;
+	int _cellHeight;
+
+	bool _isDrawn = false;
+
+	// Chance (0-100) of a cell becoming a wall
+	// セルが壁になる確率（0-100）
+	int _wallPercent = 10;
+
+	// Floor cells get a random cost in 1..._maxCost, 1 keeps the maze flat
+	// 床のセルは1..._maxCostのランダムなコスト、1なら平ら
+	int _maxCost = 1;
+	MazeGeneratorType _generator = MazeGeneratorRandom;
+
+	// Progress counters for the sliced tasks
+	// スライスタスクの進捗カウンター
+	int _generatedCells = 0;
+	int _expandedNodes = 0;
+	FindPathResult _findPathResult = FindPathUnreachable;
+
+	GridVector _maze;
+	GridVector _path;
+
+	// Changes whenever a cell opens up or the grid is rebuilt, part of the path cache key
+	// セルが開いたりグリッドを作り直したら変わる、パスキャッシュのキーの一部
+	uint64_t _version = 0;
+	PathCache _pathCache;
+
+	// Per-query scratch of FindPath (the BFS queue), reset when the next query starts
+	// The cache hit buffer keeps its capacity between queries
+	// FindPathのクエリごとのスクラッチ（BFSキュー）、次のクエリの始めにリセットする
+	MonotonicArena _queryArena{ TelemetryMemorySearch };
+	std::vector<int> _cachedPath;
+
+	// Runs the BFS queue already seeded in the workspace, stops at endIndex or (optionally) the first
+	// marked target, returns the cell it stopped on or -1
+	// ワークスペースのキューのBFSを実行する、止まったセルか-1を返す
+	int ExpandBFS(SearchWorkspace& workspace, int endIndex, bool isStoppingAtTarget) const;
+	template <typename Heuristic>
+	bool SolveAStarWith(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path, Heuristic heuristic) const;
+	unsigned char RollCellCost(void) const;
 };
\ No newline at end of file
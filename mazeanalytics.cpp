@@ -0,0 +1,237 @@
+﻿#include "mazeanalytics.hpp"
+#include "jobsystem.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+
+// ======= Public ==========
+MazeAnalytics::MazeAnalytics()
+{}
+
+MazeAnalytics::~MazeAnalytics()
+{}
+
+void MazeAnalytics::Analyze(JobSystem& jobs, const Maze& maze, MazeStats& stats)
+{
+	PROFILE_SCOPE("MazeAnalytics::Analyze");
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point passStart = Clock::now();
+
+	stats = {};
+	int width = maze.GetGridWidth();
+	int height = maze.GetGridHeight();
+	int cellCount = maze.GetCellCount();
+	if (cellCount == 0) return;
+
+	_component.resize(cellCount);
+	_corridor.resize(cellCount);
+	_degree.resize(cellCount);
+	int chunkCount = std::min(height, std::max(1, jobs.GetWorkerCount() * 8));
+	_chunkStats.assign(chunkCount, {});
+	auto getRowBegin = [height, chunkCount](int chunk) { return static_cast<int>(static_cast<long long>(height) * chunk / chunkCount); };
+
+	// == Pass: degrees, counters and the unions inside each chunk ==
+	// == １回目：次数、カウンター、チャンクの中のUnion ==
+	jobs.ParallelFor(chunkCount, 1, [&](int chunkBegin, int chunkEnd)
+	{
+		// Three rolling rows of open flags, so every cell's wall is read once
+		// 空きフラグの３行を回す、壁は１回だけ読む
+		std::vector<char> rowAbove(width), row(width), rowBelow(width);
+		auto loadRow = [&](int y, std::vector<char>& flags)
+		{
+			if (y < 0 || y >= height)
+			{
+				std::fill(flags.begin(), flags.end(), 0);
+				return;
+			}
+			for (int x = 0; x < width; x++) flags[x] = !maze.IsWall(y * width + x);
+		};
+
+		for (int chunk = chunkBegin; chunk < chunkEnd; chunk++)
+		{
+			ChunkStats& chunkStats = _chunkStats[chunk];
+			int rowBegin = getRowBegin(chunk);
+			int rowEnd = getRowBegin(chunk + 1);
+			loadRow(rowBegin - 1, rowAbove);
+			loadRow(rowBegin, row);
+			for (int y = rowBegin; y < rowEnd; y++)
+			{
+				loadRow(y + 1, rowBelow);
+				for (int x = 0; x < width; x++)
+				{
+					int index = y * width + x;
+					_component[index] = -1;
+					_corridor[index] = -1;
+					if (!row[x])
+					{
+						_degree[index] = kWallDegree;
+						continue;
+					}
+
+					bool isLeftOpen = x > 0 && row[x - 1];
+					bool isRightOpen = x < width - 1 && row[x + 1];
+					int degree = isLeftOpen + isRightOpen + rowAbove[x] + rowBelow[x];
+					_degree[index] = static_cast<unsigned char>(degree);
+					chunkStats.degreeCounts[degree]++;
+
+					// Left and up only, the row above belongs to this chunk unless it's the first row
+					// 左と上だけ、最初の行でなければ上の行もこのチャンク
+					bool isUpInChunk = y > rowBegin && rowAbove[x];
+					if (isLeftOpen) Union(_component, index, index - 1);
+					if (isUpInChunk) Union(_component, index, index - width);
+					if (degree != 2) continue;
+					if (isLeftOpen && _degree[index - 1] == 2) Union(_corridor, index, index - 1);
+					if (isUpInChunk && _degree[index - width] == 2) Union(_corridor, index, index - width);
+				}
+				std::swap(rowAbove, row);
+				std::swap(row, rowBelow);
+			}
+		}
+	});
+
+	// == Seams between chunks, serial (one row per seam) ==
+	// == チャンクの境目、シリアル（境目ごとに１行） ==
+	for (int chunk = 1; chunk < chunkCount; chunk++)
+	{
+		int seamBegin = getRowBegin(chunk) * width;
+		for (int index = seamBegin; index < seamBegin + width; index++)
+		{
+			int up = index - width;
+			if (_degree[index] == kWallDegree || _degree[up] == kWallDegree) continue;
+			Union(_component, index, up);
+			if (_degree[index] == 2 && _degree[up] == 2) Union(_corridor, index, up);
+		}
+	}
+
+	// == Roots: components, corridor lengths ==
+	// == 根：成分、通路の長さ ==
+	jobs.ParallelFor(chunkCount, 1, [&](int chunkBegin, int chunkEnd)
+	{
+		for (int chunk = chunkBegin; chunk < chunkEnd; chunk++)
+		{
+			ChunkStats& chunkStats = _chunkStats[chunk];
+			chunkStats.largestRoot = -1;
+			for (int index = getRowBegin(chunk) * width; index < getRowBegin(chunk + 1) * width; index++)
+			{
+				if (_degree[index] == kWallDegree) continue;
+				if (_component[index] < 0)
+				{
+					chunkStats.components++;
+					if (-_component[index] > chunkStats.largestComponent)
+					{
+						chunkStats.largestComponent = -_component[index];
+						chunkStats.largestRoot = index;
+					}
+				}
+				if (_degree[index] == 2 && _corridor[index] < 0)
+				{
+					int length = -_corridor[index];
+					chunkStats.corridors++;
+					chunkStats.longestCorridor = std::max(chunkStats.longestCorridor, length);
+					chunkStats.corridorHistogram[std::bit_width(static_cast<unsigned int>(length)) - 1]++;
+				}
+			}
+		}
+	});
+
+	// Chunk order keeps the largest root (and so the diameter sweep) the same for any worker count
+	// チャンクの順でまとめるので、ワーカー数に関係なく同じ結果
+	int largestRoot = -1;
+	for (const ChunkStats& chunkStats : _chunkStats)
+	{
+		stats.isolatedCells += chunkStats.degreeCounts[0];
+		stats.deadEnds += chunkStats.degreeCounts[1];
+		stats.corridorCells += chunkStats.degreeCounts[2];
+		stats.junctions += chunkStats.degreeCounts[3] + chunkStats.degreeCounts[4];
+		stats.components += chunkStats.components;
+		if (chunkStats.largestComponent > stats.largestComponent)
+		{
+			stats.largestComponent = chunkStats.largestComponent;
+			largestRoot = chunkStats.largestRoot;
+		}
+		stats.corridors += chunkStats.corridors;
+		stats.longestCorridor = std::max(stats.longestCorridor, chunkStats.longestCorridor);
+		for (int bin = 0; bin < MazeStats::kHistogramBins; bin++) stats.corridorHistogram[bin] += chunkStats.corridorHistogram[bin];
+	}
+	stats.openCells = stats.isolatedCells + stats.deadEnds + stats.corridorCells + stats.junctions;
+	stats.passMs = std::chrono::duration<double, std::milli>(Clock::now() - passStart).count();
+	if (largestRoot == -1) return;
+
+	// == Diameter: BFS from the largest component's root, then from the farthest cell found ==
+	// == 直径：一番大きい成分の根からBFS、見つけた一番遠いセルからもう一度 ==
+	Clock::time_point diameterStart = Clock::now();
+	int farthestDist = 0;
+	maze.SolveBFSParallel(jobs, largestRoot, -1, _frontier, _path);
+	stats.diameterStart = FindFarthest(jobs, cellCount, farthestDist);
+	maze.SolveBFSParallel(jobs, stats.diameterStart, -1, _frontier, _path);
+	stats.diameterEnd = FindFarthest(jobs, cellCount, stats.diameter);
+	stats.diameterMs = std::chrono::duration<double, std::milli>(Clock::now() - diameterStart).count();
+}
+
+size_t MazeAnalytics::GetMemoryBytes() const
+{
+	return (_component.capacity() + _corridor.capacity()) * sizeof(int) + _degree.capacity();
+}
+// =======================================
+
+
+// ====== Private ======
+int MazeAnalytics::Find(std::vector<int>& parent, int index)
+{
+	while (parent[index] >= 0)
+	{
+		int next = parent[index];
+		if (parent[next] >= 0) parent[index] = parent[next];
+		index = next;
+	}
+	return index;
+}
+
+void MazeAnalytics::Union(std::vector<int>& parent, int a, int b)
+{
+	int rootA = Find(parent, a);
+	int rootB = Find(parent, b);
+	if (rootA == rootB) return;
+
+	// The bigger tree (more negative) keeps the root
+	// 大きい木（よりマイナス）が根を残す
+	if (parent[rootA] > parent[rootB]) std::swap(rootA, rootB);
+	parent[rootA] += parent[rootB];
+	parent[rootB] = rootA;
+}
+
+int MazeAnalytics::FindFarthest(JobSystem& jobs, int cellCount, int& farthestDist)
+{
+	int chunkCount = static_cast<int>(_chunkStats.size());
+	jobs.ParallelFor(chunkCount, 1, [&](int chunkBegin, int chunkEnd)
+	{
+		for (int chunk = chunkBegin; chunk < chunkEnd; chunk++)
+		{
+			ChunkStats& chunkStats = _chunkStats[chunk];
+			chunkStats.farthestDist = -1;
+			chunkStats.farthestCell = -1;
+			int end = static_cast<int>(static_cast<long long>(cellCount) * (chunk + 1) / chunkCount);
+			for (int index = static_cast<int>(static_cast<long long>(cellCount) * chunk / chunkCount); index < end; index++)
+			{
+				int dist = _frontier.GetDist(index);
+				if (dist <= chunkStats.farthestDist) continue;
+				chunkStats.farthestDist = dist;
+				chunkStats.farthestCell = index;
+			}
+		}
+	});
+
+	int farthestCell = -1;
+	farthestDist = -1;
+	for (const ChunkStats& chunkStats : _chunkStats)
+	{
+		if (chunkStats.farthestDist <= farthestDist) continue;
+		farthestDist = chunkStats.farthestDist;
+		farthestCell = chunkStats.farthestCell;
+	}
+	return farthestCell;
+}
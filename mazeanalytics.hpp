@@ -0,0 +1,102 @@
+﻿#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "searchworkspace.hpp"
+
+class Maze;
+class JobSystem;
+
+// Difficulty numbers for one maze, filled by MazeAnalytics::Analyze
+// Degree is the number of open 4-neighbours of an open cell
+// メイズ１つの難しさの数字、次数は開いている４方向の隣の数
+typedef struct MazeStats
+{
+	static constexpr int kHistogramBins = 32;
+
+	long long openCells = 0;
+	long long isolatedCells = 0;	// degree 0
+	long long deadEnds = 0;			// degree 1
+	long long corridorCells = 0;	// degree 2
+	long long junctions = 0;		// degree 3 and 4
+
+	int components = 0;
+	long long largestComponent = 0;
+
+	// A corridor is a maximal connected run of degree-2 cells (a loop with no junction counts as one)
+	// corridorHistogram[k] counts the corridors of length 2^k ... 2^(k+1) - 1
+	// 通路は次数2のセルのつながった最大の並び、ヒストグラムは長さ2^k ... 2^(k+1) - 1の数
+	int corridors = 0;
+	int longestCorridor = 0;
+	std::array<long long, kHistogramBins> corridorHistogram = {};
+
+	// Double-sweep BFS on the largest component: farthest cell from any cell, then the farthest from
+	// that one. Exact on trees (perfect mazes), a lower bound once there are loops
+	// 一番大きい成分で２回のBFS：木（完全なメイズ）なら正確、ループがあれば下限
+	int diameter = 0;
+	int diameterStart = -1;
+	int diameterEnd = -1;
+
+	double passMs = 0.0;
+	double diameterMs = 0.0;
+};
+
+/*
+	Parallel maze analytics
+	One pass over row chunks on the job system counts degrees and builds two union-finds at the same time
+	(open cells, and degree-2 cells), each chunk only links cells inside itself. The chunk seams are
+	linked afterwards on the calling thread, then the roots (which hold -size) give the components and
+	corridor lengths. Per-chunk counters are reduced at the end, so the result doesn't depend on the worker count
+	並列のメイズ分析
+	行のチャンクを１回通って次数を数え、２つのUnion-Find（空きセル、次数2のセル）を同時に作る
+	チャンクの境目は後で呼び出し元のスレッドでつなぐ、根（-サイズを持つ）から成分と通路の長さが出る
+*/
+
+class MazeAnalytics
+{
+public:
+	MazeAnalytics(void);
+	~MazeAnalytics(void);
+
+	void Analyze(JobSystem& jobs, const Maze& maze, MazeStats& stats);
+
+	// Scratch held between calls: two int parents and one degree byte per cell
+	// 呼び出しの間に持つメモリ：セルごとにintの親２つと次数１バイト
+	size_t GetMemoryBytes(void) const;
+
+private:
+	static constexpr unsigned char kWallDegree = 0xFF;
+
+	// Counters of one row chunk, reduced in chunk order
+	// 行のチャンク１つのカウンター、チャンクの順にまとめる
+	typedef struct ChunkStats
+	{
+		long long degreeCounts[5];
+		int components;
+		long long largestComponent;
+		int largestRoot;
+		int corridors;
+		int longestCorridor;
+		std::array<long long, MazeStats::kHistogramBins> corridorHistogram;
+		int farthestDist;
+		int farthestCell;
+	};
+
+	// parent[i] < 0 marks a root holding -size, union by size with path halving
+	// parent[i] < 0 は根で-サイズを持つ
+	static int Find(std::vector<int>& parent, int index);
+	static void Union(std::vector<int>& parent, int a, int b);
+
+	// Farthest reached cell after a full-grid BFS in _frontier (lowest index on ties)
+	// BFSの後の一番遠いセル（同じなら小さいインデックス）
+	int FindFarthest(JobSystem& jobs, int cellCount, int& farthestDist);
+
+	std::vector<int> _component;
+	std::vector<int> _corridor;
+	std::vector<unsigned char> _degree;
+	std::vector<ChunkStats> _chunkStats;
+	FrontierWorkspace _frontier;
+	std::vector<int> _path;
+};
@@ -0,0 +1,417 @@
+﻿#include "externalbfs.hpp"
+#include "jobsystem.hpp"
+#include "landmarks.hpp"
+#include "maze.hpp"
+#include "mazeanalytics.hpp"
+#include "pagedgrid.hpp"
+#include "profiler.hpp"
+#include "searchworkspace.hpp"
+#include "shardedsolver.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+	Headless batch runner (build with MAZE_HEADLESS)
+	Generates a maze, runs N random start/goal queries and writes throughput, latency and path stats as JSON.
+	ヘッドレスのバッチランナー（MAZE_HEADLESSでビルドする）
+
+	mazebatch [--config file] [--width N] [--height N] [--generator random|backtracker] [--wall-percent N]
+	          [--max-cost N] [--seed N] [--solver bfs|dijkstra|dijkstra-heap|astar|alt|sharded] [--landmarks N] [--processes N]
+	          [--queries N] [--threads N] [--store memory|paged] [--memory-cap-mb N] [--store-dir path] [--analyze 0|1]
+	          [--out file.json]
+
+	Config file: one "key = value" per line, same keys as the arguments without "--", # for comments.
+	Arguments given on the command line override the config file.
+
+	store = paged keeps the walls in a chunked file under store-dir and answers the queries one by one
+	with the external-memory BFS, both held to memory-cap-mb (random generator and bfs solver only)
+	store = pagedは壁をファイルに置いて外部メモリBFSで解く（randomとbfsだけ）
+
+	solver = sharded runs every query as a BFS split over "processes" forked worker processes (Linux only)
+	solver = shardedは各クエリをフォークしたプロセスに分けて解く（Linuxだけ）
+*/
+
+typedef struct BatchConfig 
+{
+	int width = 1024;
+	int height = 1024;
+	std::string generator = "random";
+	int wallPercent = 10;
+	int maxCost = 1;
+	unsigned int seed = 1;
+	std::string solver = "bfs";
+	int landmarks = 8;			// alt only
+	int processes = 4;			// sharded only
+	bool isAnalyzing = false;	// memory store only
+	int queries = 1000;
+	int threads = 1;
+	std::string store = "memory";
+	int memoryCapMb = 64;		// paged only, split between the chunk cache and the BFS
+	std::string storeDir = ".";
+	std::string outFile;
+};
+
+typedef struct QueryResult 
+{
+	double latencyUs;
+	long long pathLength;
+	long long expandedNodes;
+	bool isSolved;
+};
+
+static bool ApplyOption(BatchConfig& config, const std::string& key, const std::string& value)
+{
+	if (key == "width")					config.width = std::atoi(value.c_str());
+	else if (key == "height")			config.height = std::atoi(value.c_str());
+	else if (key == "generator")		config.generator = value;
+	else if (key == "wall-percent")		config.wallPercent = std::atoi(value.c_str());
+	else if (key == "max-cost")			config.maxCost = std::atoi(value.c_str());
+	else if (key == "seed")				config.seed = static_cast<unsigned int>(std::strtoul(value.c_str(), nullptr, 10));
+	else if (key == "solver")			config.solver = value;
+	else if (key == "landmarks")		config.landmarks = std::max(1, std::atoi(value.c_str()));
+	else if (key == "processes")		config.processes = std::max(1, std::atoi(value.c_str()));
+	else if (key == "analyze")			config.isAnalyzing = std::atoi(value.c_str()) != 0;
+	else if (key == "queries")			config.queries = std::atoi(value.c_str());
+	else if (key == "threads")			config.threads = std::max(1, std::atoi(value.c_str()));
+	else if (key == "store")			config.store = value;
+	else if (key == "memory-cap-mb")	config.memoryCapMb = std::max(1, std::atoi(value.c_str()));
+	else if (key == "store-dir")		config.storeDir = value;
+	else if (key == "out")				config.outFile = value;
+	else
+	{
+		std::cerr << "Unknown option: " << key << "\n";
+		return false;
+	}
+	return true;
+}
+
+static std::string Trim(const std::string& text)
+{
+	size_t first = text.find_first_not_of(" \t\r");
+	if (first == std::string::npos) return "";
+	size_t last = text.find_last_not_of(" \t\r");
+	return text.substr(first, last - first + 1);
+}
+
+static bool LoadConfigFile(BatchConfig& config, const std::string& filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cerr << "Failed to open config file " << filename << "\n";
+		return false;
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = Trim(line.substr(0, line.find('#')));
+		if (line.empty()) continue;
+
+		size_t equals = line.find('=');
+		if (equals == std::string::npos)
+		{
+			std::cerr << "Bad config line: " << line << "\n";
+			return false;
+		}
+		if (!ApplyOption(config, Trim(line.substr(0, equals)), Trim(line.substr(equals + 1)))) return false;
+	}
+	return true;
+}
+
+static bool ParseArgs(int argc, char* argv[], BatchConfig& config)
+{
+	// Config file first, so the other arguments override it
+	// まず設定ファイル、他の引数で上書きする
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (std::string(argv[i]) == "--config" && !LoadConfigFile(config, argv[i + 1])) return false;
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.rfind("--", 0) != 0 || i + 1 >= argc)
+		{
+			std::cerr << "Bad argument: " << arg << "\n";
+			return false;
+		}
+		std::string value = argv[++i];
+		if (arg == "--config") continue;
+		if (!ApplyOption(config, arg.substr(2), value)) return false;
+	}
+	return true;
+}
+
+static double Percentile(const std::vector<double>& sorted, double percentile)
+{
+	if (sorted.empty()) return 0.0;
+	size_t index = static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int main(int argc, char* argv[])
+{
+	using Clock = std::chrono::steady_clock;
+
+	BatchConfig config = {};
+	if (!ParseArgs(argc, argv, config)) return 1;
+
+	Maze maze;
+	if (config.generator == "random")				maze.SetGenerator(MazeGeneratorRandom);
+	else if (config.generator == "backtracker")		maze.SetGenerator(MazeGeneratorBacktracker);
+	else
+	{
+		std::cerr << "Unknown generator: " << config.generator << "\n";
+		return 1;
+	}
+	bool (Maze::*solve)(int, int, SearchWorkspace&, std::vector<int>&) const = nullptr;
+	if (config.solver == "bfs")					solve = &Maze::SolveBFS;
+	else if (config.solver == "dijkstra")		solve = &Maze::SolveDijkstra;
+	else if (config.solver == "dijkstra-heap")	solve = &Maze::SolveDijkstraHeap;
+	else if (config.solver == "astar")			solve = &Maze::SolveAStar;
+	else if (config.solver != "alt" && config.solver != "sharded")
+	{
+		std::cerr << "Unknown solver: " << config.solver << "\n";
+		return 1;
+	}
+	bool isPaged = (config.store == "paged");
+	if (config.store != "memory" && !isPaged)
+	{
+		std::cerr << "Unknown store: " << config.store << "\n";
+		return 1;
+	}
+	if (isPaged && (config.generator != "random" || config.solver != "bfs"))
+	{
+		std::cerr << "The paged store only supports the random generator with the bfs solver\n";
+		return 1;
+	}
+
+	// == Generate ==
+	// Cells are 1x1, so grid coords == "screen" coords
+	// セルは1x1なので、グリッド座標 == 画面座標
+	JobSystem jobs(config.threads);
+	size_t memoryCap = static_cast<size_t>(config.memoryCapMb) * 1024 * 1024;
+	std::string gridFile = PagedGrid::MakeWorkFileName(config.storeDir, "mazebatch_grid");
+	PagedGrid grid;
+	Clock::time_point generateStart = Clock::now();
+	if (isPaged)
+	{
+		// Same walls as GenerateMazeParallel, written straight to the file
+		// GenerateMazeParallelと同じ壁、ファイルに直接書く
+		if (!grid.Create(gridFile, config.width, config.height, memoryCap / 2)) return 1;
+		if (!grid.GenerateRandom(config.wallPercent, config.seed))
+		{
+			grid.Close();
+			std::remove(gridFile.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		maze.InitMaze(config.width, config.height, config.width, config.height);
+		maze.SetWallPercent(config.wallPercent);
+		maze.SetMaxCost(config.maxCost);
+		maze.GenerateMazeParallel(jobs, config.seed);
+	}
+	double generateMs = std::chrono::duration<double, std::milli>(Clock::now() - generateStart).count();
+
+	// == Difficulty stats of the generated maze ==
+	// == 作ったメイズの難しさ ==
+	MazeStats stats;
+	if (config.isAnalyzing && !isPaged)
+	{
+		MazeAnalytics analytics;
+		analytics.Analyze(jobs, maze, stats);
+	}
+
+	// == Landmark preprocessing, paid once for the whole batch ==
+	// == ランドマークの前処理、バッチ全体で１回 ==
+	LandmarkTable landmarks;
+	if (config.solver == "alt") landmarks.Build(maze, config.landmarks);
+
+	// == Random open start/goal pairs, fixed by the seed ==
+	// == ランダムな空きセルのペア、シードで固定 ==
+	// The paged grid can't list its open cells in memory, so it draws cells until one is open
+	// ページングしたグリッドは空きセルのリストを持てないので、空きが出るまで引く
+	std::mt19937 rng(config.seed);
+	std::vector<std::pair<long long, long long>> queries(config.queries);
+	if (isPaged)
+	{
+		std::uniform_int_distribution<long long> pickCell(0, grid.GetCellCount() - 1);
+		auto pickOpen = [&]()
+		{
+			long long cell = pickCell(rng);
+			while (grid.IsWall(cell)) cell = pickCell(rng);
+			return cell;
+		};
+		for (auto& query : queries)
+		{
+			long long start = pickOpen();
+			query = { start, pickOpen() };
+		}
+	}
+	else
+	{
+		std::vector<int> openCells;
+		for (int i = 0; i < maze.GetCellCount(); i++)
+		{
+			if (!maze.IsWall(i)) openCells.push_back(i);
+		}
+		std::uniform_int_distribution<size_t> pick(0, openCells.size() - 1);
+		for (auto& query : queries)
+		{
+			query = { openCells[pick(rng)], openCells[pick(rng)] };
+		}
+	}
+
+	// == Solve, queries are jobs and each worker keeps its own workspace ==
+	// == 解く、クエリはジョブで、各ワーカーが自分のワークスペースを持つ ==
+	std::vector<QueryResult> results(config.queries);
+	ExternalBFS externalSearch;
+	long long ioBytesRead = 0;
+	long long ioBytesWritten = 0;
+	ShardedSolver shardedSolver;
+	long long cellsExchanged = 0;
+	Clock::time_point solveStart = Clock::now();
+	if (isPaged)
+	{
+		// One query at a time, the grid's chunk cache isn't shared between threads
+		// １つずつ解く、グリッドのチャンクキャッシュはスレッド間で共有しない
+		externalSearch.SetWorkDirectory(config.storeDir);
+		externalSearch.SetMemoryCap(memoryCap / 2);
+		std::vector<long long> path;
+		for (int q = 0; q < config.queries; q++)
+		{
+			Clock::time_point start = Clock::now();
+			bool isSolved = externalSearch.Solve(grid, queries[q].first, queries[q].second, path);
+			double latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			// An I/O failure isn't an unreachable goal, stop instead of reporting it as one
+			// I/Oの失敗は到達できないのとは違うので、そう報告せずに止める
+			if (!externalSearch.IsGood())
+			{
+				grid.Close();
+				std::remove(gridFile.c_str());
+				return 1;
+			}
+			results[q] = { latencyUs, static_cast<long long>(path.size()), externalSearch.GetVisitedCount(), isSolved };
+			ioBytesRead += externalSearch.GetBytesRead();
+			ioBytesWritten += externalSearch.GetBytesWritten();
+		}
+		ioBytesRead += grid.GetBytesRead();
+		ioBytesWritten += grid.GetBytesWritten();
+		grid.Close();
+		std::remove(gridFile.c_str());
+	}
+	else if (config.solver == "sharded")
+	{
+		// Each query already spreads over the worker processes, so queries go one at a time
+		// クエリごとにプロセスに分けるので、クエリは１つずつ
+		shardedSolver.SetProcessCount(config.processes);
+		std::vector<int> path;
+		for (int q = 0; q < config.queries; q++)
+		{
+			Clock::time_point start = Clock::now();
+			bool isSolved = shardedSolver.Solve(maze, static_cast<int>(queries[q].first), static_cast<int>(queries[q].second), path);
+			double latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			results[q] = { latencyUs, static_cast<long long>(path.size()), 0, isSolved };
+			cellsExchanged += shardedSolver.GetCellsExchanged();
+		}
+	}
+	else jobs.ParallelFor(config.queries, 4, [&](int queryBegin, int queryEnd)
+	{
+		thread_local SearchWorkspace workspace;
+		thread_local std::vector<int> path;
+		for (int q = queryBegin; q < queryEnd; q++)
+		{
+			Clock::time_point start = Clock::now();
+			int startIndex = static_cast<int>(queries[q].first);
+			int endIndex = static_cast<int>(queries[q].second);
+			bool isSolved = (solve != nullptr) ? (maze.*solve)(startIndex, endIndex, workspace, path) :
+				maze.SolveAStar(startIndex, endIndex, landmarks, workspace, path);
+			double latencyUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+			results[q] = { latencyUs, static_cast<long long>(path.size()), workspace.expandedNodes, isSolved };
+		}
+	});
+	double solveMs = std::chrono::duration<double, std::milli>(Clock::now() - solveStart).count();
+
+	// == Stats ==
+	std::vector<double> latencies;
+	long long pathTotal = 0;
+	long long expandedTotal = 0;
+	long long pathMin = 0;
+	long long pathMax = 0;
+	int nSolved = 0;
+	for (const auto& result : results)
+	{
+		latencies.push_back(result.latencyUs);
+		expandedTotal += result.expandedNodes;
+		if (!result.isSolved) continue;
+		pathMin = (nSolved == 0) ? result.pathLength : std::min(pathMin, result.pathLength);
+		pathMax = std::max(pathMax, result.pathLength);
+		pathTotal += result.pathLength;
+		nSolved++;
+	}
+	std::sort(latencies.begin(), latencies.end());
+
+	std::ostringstream json;
+	json << "{\n"
+		<< "  \"config\": {\"width\": " << config.width << ", \"height\": " << config.height
+		<< ", \"generator\": \"" << config.generator << "\", \"wall_percent\": " << config.wallPercent << ", \"max_cost\": " << config.maxCost
+		<< ", \"seed\": " << config.seed << ", \"solver\": \"" << config.solver << "\", \"queries\": " << config.queries
+		<< ", \"threads\": " << config.threads << ", \"landmarks\": " << landmarks.GetLandmarkCount() << ", \"processes\": " << config.processes
+		<< ", \"store\": \"" << config.store << "\", \"memory_cap_mb\": " << config.memoryCapMb << "},\n"
+		<< "  \"generate_ms\": " << generateMs << ",\n";
+	if (config.isAnalyzing && !isPaged)
+	{
+		json << "  \"analytics\": {\"open_cells\": " << stats.openCells << ", \"dead_ends\": " << stats.deadEnds
+			<< ", \"junctions\": " << stats.junctions << ", \"components\": " << stats.components
+			<< ", \"largest_component\": " << stats.largestComponent << ", \"corridors\": " << stats.corridors
+			<< ", \"longest_corridor\": " << stats.longestCorridor << ", \"corridor_histogram_log2\": [";
+		int lastBin = MazeStats::kHistogramBins - 1;
+		while (lastBin > 0 && stats.corridorHistogram[lastBin] == 0) lastBin--;
+		for (int bin = 0; bin <= lastBin; bin++) json << (bin == 0 ? "" : ", ") << stats.corridorHistogram[bin];
+		json << "], \"diameter\": " << stats.diameter << ", \"pass_ms\": " << stats.passMs << ", \"diameter_ms\": " << stats.diameterMs << "},\n";
+	}
+	json
+		<< "  \"landmarks_ms\": " << landmarks.GetBuildMs() << ",\n"
+		<< "  \"landmarks_bytes\": " << landmarks.GetMemoryBytes() << ",\n"
+		<< "  \"solve_ms\": " << solveMs << ",\n"
+		<< "  \"throughput_qps\": " << (solveMs > 0.0 ? config.queries / (solveMs / 1000.0) : 0.0) << ",\n"
+		<< "  \"latency_us\": {\"p50\": " << Percentile(latencies, 50.0) << ", \"p90\": " << Percentile(latencies, 90.0)
+		<< ", \"p99\": " << Percentile(latencies, 99.0) << ", \"max\": " << (latencies.empty() ? 0.0 : latencies.back()) << "},\n"
+		<< "  \"solved\": " << nSolved << ",\n"
+		<< "  \"unreachable\": " << (config.queries - nSolved) << ",\n"
+		<< "  \"path_length\": {\"min\": " << pathMin << ", \"mean\": " << (nSolved > 0 ? static_cast<double>(pathTotal) / nSolved : 0.0)
+		<< ", \"max\": " << pathMax << "},\n"
+		<< "  \"expanded_nodes_mean\": " << (config.queries > 0 ? static_cast<double>(expandedTotal) / config.queries : 0.0) << ",\n"
+		<< "  \"io_bytes_read\": " << ioBytesRead << ",\n"
+		<< "  \"io_bytes_written\": " << ioBytesWritten << ",\n"
+		<< "  \"cells_exchanged\": " << cellsExchanged << ",\n"
+		<< "  \"peak_rss_bytes\": " << Profiler::GetPeakResidentBytes() << ",\n"
+		<< "  \"telemetry\": ";
+	Telemetry::GetInstance().WriteJson(json);
+	json << "\n}\n";
+
+	if (config.outFile.empty())
+	{
+		std::cout << json.str();
+	}
+	else
+	{
+		std::ofstream file(config.outFile);
+		file << json.str();
+		std::cerr << "Wrote " << config.outFile << "\n";
+	}
+	return 0;
+}
@@ -0,0 +1,1673 @@
+﻿#include "jobsystem.hpp"
+#include "arena.hpp"
+#include "cooperativeplanner.hpp"
+#include "externalbfs.hpp"
+#include "frameloop.hpp"
+#include "junctiongraph.hpp"
+#include "landmarks.hpp"
+#include "layoutgrid.hpp"
+#include "maze.hpp"
+#include "mazeanalytics.hpp"
+#include "mazeview.hpp"
+#include "paddedgrid.hpp"
+#include "pagedgrid.hpp"
+#include "profiler.hpp"
+#include "searchworkspace.hpp"
+#include "sessionlog.hpp"
+#include "shardedsolver.hpp"
+#include "simulation.hpp"
+#include "telemetry.hpp"
+#include "tilegeometry.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+	Micro-benchmark suite (headless, build with MAZE_HEADLESS)
+	Every case uses a fixed seed so the numbers can be diffed across commits.
+	Each family of cases is one Run...Bench function, main runs them in the order of kBenchFamilies.
+	マイクロベンチマーク（ヘッドレス、MAZE_HEADLESSでビルドする）
+	ケースのファミリーごとにRun...Bench関数が１つ、mainはkBenchFamiliesの順に実行する
+
+	mazebench [--out file.json] [--seed N] [--min-size N] [--max-size N] [--min-time-ms N] [--max-workers N] [--filter text]
+*/
+
+typedef struct BenchConfig 
+{
+	std::string outFile;
+	unsigned int seed = 1;
+	int minSize = 20;
+	int maxSize = 16384;
+	int minTimeMs = 200;
+	int maxIterations = 1000;
+	int maxWorkers = 64;
+	std::string filter;
+};
+
+typedef struct BenchResult 
+{
+	std::string name;
+	std::string solver;
+	int size = 0;
+	int wallPercent = 0;
+	float queryDistance = 0.0f;
+	int iterations = 0;
+	double minNs = 0.0;
+	double medianNs = 0.0;
+	double meanNs = 0.0;
+	double maxNs = 0.0;
+	long long items = 0;
+	long long pathLength = -1;		// -1 when the bench finds no path
+	int workers = 0;
+
+	// Any other quantity a bench reports, written to the JSON only when metric is set
+	// ベンチが出すその他の量、metricがある時だけJSONに書く
+	std::string metric = "";
+	double value = 0.0;
+	std::string unit = "";
+};
+
+typedef struct BenchSolver 
+{
+	const char* name;
+	std::function<long long(Maze&, int, int)> solve;	// returns the path length
+};
+
+static const int kGridSizes[] = { 20, 64, 256, 1024, 4096, 16384 };
+static const int kWallPercents[] = { 0, 10, 25 };
+static const float kQueryDistances[] = { 0.25f, 0.5f, 1.0f };
+
+// Nearest of K goals: one multi-goal traversal against K separate searches
+// K個のゴールで一番近いもの：１回の探索とK回の探索を比べる
+static const int kNearestGoalCounts[] = { 4, 16, 64 };
+
+// Agent simulation, ticks on one grid as the agent and worker counts grow
+// エージェントシミュレーション、エージェント数とワーカー数を増やす
+static const int kSimulationSize = 128;
+static const int kSimulationAgents[] = { 1000, 4000, 16000, 32000 };
+
+// Cooperative A*, one planning round for every agent on a 1024x1024 grid, the same round with so few
+// expansions that most agents have to wait, then the simulation's ticks with the round sliced over them
+// 協調A*、1024x1024で全エージェントの計画１回、ほとんどが待つほど展開の少ない同じ計画、
+// そしてスライスした計画を含むシミュレーションのティック
+static const int kCooperativeSize = 1024;
+static const int kCooperativeAgents[] = { 1000, 4000, 16000 };
+static const int kCooperativeWindow = 16;
+static const int kCooperativeTightExpansions = 24;
+static const int kCooperativeTicks = 4 * kCooperativeWindow;
+
+// Landmark (ALT) A* against Manhattan A* on a batch of random queries, twisty (backtracker)
+// and random-wall grids, preprocessing is timed separately
+// ランドマーク（ALT）A*とマンハッタンA*、曲がりくねったグリッドとランダムな壁のグリッド
+static const int kLandmarkSize = 1024;
+static const int kLandmarkCounts[] = { 4, 8, 16 };
+static const int kLandmarkQueries = 128;
+
+// Junction graph (dead-end filling + corridor contraction) against cell-grid Dijkstra,
+// on perfect mazes and on braided ones with a share of their walls knocked out
+// ジャンクショングラフとセルのDijkstra、完全なメイズと壁を少し抜いたメイズ
+static const int kJunctionSizes[] = { 1024, 2048 };
+static const int kJunctionBraidPercents[] = { 0, 2, 10 };
+static const int kJunctionQueries = 64;
+
+// Cell storage layouts, the same BFS / A* code on row-major, Morton and 8x8 tiled copies of the grid
+// Morton rounds up to a power-of-two square (4096² stays 4096², the border is outside it), sizes stop at 4096
+// セルの並べ方、同じBFS / A*を行優先、Morton、8x8タイルで
+static const int kLayoutMaxSize = 4096;
+
+// Out-of-core store and external-memory BFS, the grid and the BFS each get a small memory cap
+// so the chunk cache and the level files actually spill, the in-memory BFS is the baseline
+// ディスク上のグリッドと外部メモリBFS、メモリ上限を小さくしてちゃんとディスクに出す
+static const int kExternalSizes[] = { 1024, 4096 };
+static const size_t kExternalMemoryCap = 1024 * 1024;
+
+// Sharded BFS, one forked process per strip for 1, 2, 4 ... --max-workers processes
+// 帯ごとにプロセスを１つフォークするBFS、1, 2, 4 ... --max-workersプロセス
+static const int kShardedSizes[] = { 1024, 4096 };
+static const std::chrono::seconds kShardedKillTimeout(10);	// the killed-worker run counts as hung after this
+
+// FindPath path cache, a skewed stream of repeated start/goal pairs, then the same stream with
+// a wall dropped on the last solved path every few queries (only the paths crossing it are lost)
+// FindPathのパスキャッシュ、繰り返すペアの偏った流れ、数クエリごとに最後のパスに壁を置く版も
+static const int kPathCacheSize = 512;
+static const int kPathCachePairs = 32;
+static const int kPathCacheQueries = 256;
+static const int kPathCacheEditEvery = 8;
+
+// Steady state, FindPath (uncached and cache hits) and a render frame are warmed up once,
+// then every later pass has to get through without a single operator new
+// The frame is Canvas's: the visible quads of an 800x600 camera built on a real JobSystem, fitted
+// (built on the workers) and zoomed in (few enough quads to be built serially)
+// 定常状態、FindPath（キャッシュなし、ヒット）と描画フレームを１回温めたら、その後はoperator newなしで
+// フレームはCanvasと同じ、本物のJobSystemで800x600のカメラ（全体表示とズーム）に見える四角形を作る
+static const int kSteadyStateSize = 256;
+static const int kSteadyStateQueries = 64;
+static const int kSteadyStateWorkers = 4;
+
+// Session log, one minute at 60 Hz with a key press every 100 frames and a sliced regeneration,
+// written and read back (the events and digest have to survive the round trip)
+// セッションログ、60 Hzで１分、100フレームごとのキーとスライス生成、書いて読み戻す
+static const int kSessionFrames = 3600;
+
+// Frame loop, ten simulated seconds on a fake clock (60 Hz updates against 144 Hz and 30 Hz displays,
+// a 30 Hz render cap and a one second hitch), then real time in the uncapped mode with a null presenter,
+// stepped for at least kFrameLoopUncappedMinNs so the 60 Hz update rate is counted over a whole second
+// フレームループ、偽の時計で10秒（144 Hzと30 Hzのディスプレイに60 Hzの更新、30 Hzの描画上限、１秒の停止）、
+// そしてヌルプレゼンターの上限なしモードで実時間、更新のレートは最低１秒で数える
+static const int kFrameLoopSeconds = 10;
+static const int kFrameLoopUncappedSteps = 100000;
+static const int64_t kFrameLoopUncappedMinNs = 1000000000ll;
+
+// View, the cell pyramid of every size up to --max-size and the visible quads of an 800x600 camera
+// fitted and zoomed in, the quad count has to stay flat however big the maze gets
+// ビュー、--max-sizeまでの各サイズのセルピラミッドと800x600のカメラ（全体表示とズーム）の見える四角形、
+// 四角形の数はメイズが大きくなっても変わらないこと
+static const int kViewSizes[] = { 256, 1024, 4096, 16384 };
+static const int kViewScreenW = 800;
+static const int kViewScreenH = 600;
+static const float kViewZoomPixelsPerCell = 16.0f;
+
+// Every operator new in the process, counted for the steady-state case
+// プロセス全体のoperator new、定常状態のケース用に数える
+// Kept out of line: GCC inlines the deletes into std::allocator, then flags their free() against the
+// builtin operator new it assumes is still paired with them (-Wmismatched-new-delete)
+// インラインにしない：GCCはdeleteをstd::allocatorに展開して、組み込みのoperator newと合わないと警告する
+static std::atomic<long long> heapAllocations = 0;
+
+#if defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+BENCH_NOINLINE void* operator new(size_t size)
+{
+	heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* block = std::malloc(size > 0 ? size : 1)) return block;
+	throw std::bad_alloc();
+}
+
+BENCH_NOINLINE void operator delete(void* block) noexcept
+{
+	std::free(block);
+}
+
+BENCH_NOINLINE void operator delete(void* block, size_t) noexcept
+{
+	std::free(block);
+}
+
+// Every compile-time topology on the padded grid
+// パディング付きグリッドの全てのトポロジー
+typedef struct BenchTopology 
+{
+	const char* name;
+	MazeTopology topology;
+};
+
+static const BenchTopology kTopologies[] = 
+{
+	{ "4", MazeTopology4 },
+	{ "8", MazeTopology8 },
+	{ "8-corner-cut", MazeTopology8CornerCut },
+	{ "hex", MazeTopologyHex },
+};
+
+// Scaling cases run once per worker count (1, 2, 4 ... --max-workers)
+// スケーリングはワーカー数ごとに実行する
+static const int kScalingWallPercent = 10;
+static const int kScalingQueries = 64;
+static const int kScalingMaxVertexSize = 1024;
+
+// Every FindPath solver mode, cells are 1x1 so grid coords == "screen" coords
+// 全てのFindPathソルバーモード
+static SearchWorkspace benchWorkspace;
+static std::vector<int> benchPath;
+
+static const BenchSolver kSolvers[] = 
+{
+	{ "bfs", [](Maze& maze, int endX, int endY)
+		{
+			maze.FindPath(0, 0, endX, endY);
+			return static_cast<long long>(maze.GetPath()->size());
+		} },
+	{ "bfs-workspace", [](Maze& maze, int endX, int endY)
+		{
+			maze.SolveBFS(0, endY * maze.GetGridWidth() + endX, benchWorkspace, benchPath);
+			return static_cast<long long>(benchPath.size());
+		} },
+};
+
+// Weighted grids (floor cost 1..kWeightedMaxCost), the return value is the path cost
+// 重み付きグリッド、戻り値はパスのコスト
+static const int kWeightedMaxCost = 9;
+static const BenchSolver kWeightedSolvers[] = 
+{
+	{ "dijkstra-bucket", [](Maze& maze, int endX, int endY)
+		{
+			int endIndex = endY * maze.GetGridWidth() + endX;
+			return maze.SolveDijkstra(0, endIndex, benchWorkspace, benchPath) ? static_cast<long long>(benchWorkspace.GetDist(endIndex)) : -1ll;
+		} },
+	{ "dijkstra-heap", [](Maze& maze, int endX, int endY)
+		{
+			int endIndex = endY * maze.GetGridWidth() + endX;
+			return maze.SolveDijkstraHeap(0, endIndex, benchWorkspace, benchPath) ? static_cast<long long>(benchWorkspace.GetDist(endIndex)) : -1ll;
+		} },
+};
+
+static bool ParseArgs(int argc, char* argv[], BenchConfig& config)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		if (arg == "--out" && hasValue)					config.outFile = argv[++i];
+		else if (arg == "--seed" && hasValue)			config.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if (arg == "--min-size" && hasValue)		config.minSize = std::atoi(argv[++i]);
+		else if (arg == "--max-size" && hasValue)		config.maxSize = std::atoi(argv[++i]);
+		else if (arg == "--min-time-ms" && hasValue)	config.minTimeMs = std::atoi(argv[++i]);
+		else if (arg == "--max-iterations" && hasValue)	config.maxIterations = std::atoi(argv[++i]);
+		else if (arg == "--max-workers" && hasValue)	config.maxWorkers = std::max(1, std::atoi(argv[++i]));
+		else if (arg == "--filter" && hasValue)			config.filter = argv[++i];
+		else
+		{
+			std::cerr << "Unknown argument: " << arg << "\n"
+				<< "mazebench [--out file.json] [--seed N] [--min-size N] [--max-size N] [--min-time-ms N] [--max-iterations N] [--max-workers N] [--filter text]\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+// Runs body until minTimeMs has passed (at least once), keeps every sample
+// minTimeMsが経つまでbodyを実行する（最低１回）
+static void RunTimed(const BenchConfig& config, BenchResult& result, const std::function<void(void)>& body)
+{
+	using Clock = std::chrono::steady_clock;
+	std::vector<double> samples;
+	double totalNs = 0.0;
+
+	while (samples.empty() || (totalNs < config.minTimeMs * 1000000.0 && static_cast<int>(samples.size()) < config.maxIterations))
+	{
+		Clock::time_point start = Clock::now();
+		body();
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+		samples.push_back(ns);
+		totalNs += ns;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	result.iterations = static_cast<int>(samples.size());
+	result.minNs = samples.front();
+	result.maxNs = samples.back();
+	result.medianNs = samples[samples.size() / 2];
+	result.meanNs = totalNs / samples.size();
+}
+
+static void GenerateFixed(Maze& maze, int size, int wallPercent, unsigned int seed, int maxCost = 1)
+{
+	maze.InitMaze(size, size, size, size);
+	maze.SetWallPercent(wallPercent);
+	maze.SetMaxCost(maxCost);
+	srand(seed);
+	maze.GenerateMaze();
+}
+
+// 6 vertices for every cell of the grid, built in chunks on the job system, the path mask goes into the
+// frame arena. The app only builds the visible samples (BuildVisibleVertices), this is the whole-grid upper bound
+// 全てのセルに６頂点、ジョブシステムでチャンクごとに作る。アプリは見える分だけ作る（BuildVisibleVertices）
+static void BuildVertices(Maze& maze, JobSystem& jobs, int scrnW, int scrnH, std::vector<TileVertex>& vertices, MonotonicArena& frameArena)
+{
+	PROFILE_SCOPE("BuildVertices");
+
+	const char* pathMask = maze.BuildPathMask(frameArena);
+
+	const GridVector& cells = *maze.GetMaze();
+	int cellCount = static_cast<int>(cells.size());
+	float cellWidth = static_cast<float>(scrnW) / maze.GetGridWidth();
+	float cellHeight = static_cast<float>(scrnH) / maze.GetGridHeight();
+	vertices.resize(static_cast<size_t>(cellCount) * kTileVertexCount);
+
+	jobs.ParallelFor(cellCount, 4096, [&](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			const GridIndex& cell = cells[i];
+			BuildTileVertices(cell.x, cell.y, cellWidth, cellHeight, scrnW, scrnH,
+				cell.cost == kWallCost, pathMask[i] != 0, &vertices[static_cast<size_t>(i) * kTileVertexCount]);
+		}
+	});
+}
+
+// First open cell at or after the point queryDistance along the diagonal
+// 対角線上のqueryDistanceの位置から最初の空きセル
+static int FindOpenCell(Maze& maze, int size, float queryDistance)
+{
+	int target = static_cast<int>(queryDistance * (size - 1));
+	GridVector& cells = *maze.GetMaze();
+	for (int i = target * size + target; i < static_cast<int>(cells.size()); i++)
+	{
+		if (cells[i].cost != kWallCost) return i;
+	}
+	return 0;
+}
+
+static std::string ToJson(const BenchConfig& config, const std::vector<BenchResult>& results)
+{
+	std::ostringstream json;
+	json << "{\n  \"benchmark\": \"mazebench\",\n  \"seed\": " << config.seed << ",\n  \"results\": [";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const BenchResult& r = results[i];
+		double itemsPerSecond = (r.meanNs > 0.0) ? r.items / (r.meanNs / 1e9) : 0.0;
+		json << (i == 0 ? "\n" : ",\n")
+			<< "    {\"name\": \"" << r.name << "\", \"solver\": \"" << r.solver << "\", \"size\": " << r.size
+			<< ", \"wall_percent\": " << r.wallPercent << ", \"query_distance\": " << r.queryDistance
+			<< ", \"iterations\": " << r.iterations
+			<< ", \"min_ns\": " << static_cast<long long>(r.minNs) << ", \"median_ns\": " << static_cast<long long>(r.medianNs)
+			<< ", \"mean_ns\": " << static_cast<long long>(r.meanNs) << ", \"max_ns\": " << static_cast<long long>(r.maxNs)
+			<< ", \"items\": " << r.items << ", \"items_per_second\": " << static_cast<long long>(itemsPerSecond)
+			<< ", \"path_length\": " << r.pathLength << ", \"workers\": " << r.workers;
+		if (!r.metric.empty())
+		{
+			json << ", \"metric\": \"" << r.metric << "\", \"value\": " << r.value << ", \"unit\": \"" << r.unit << "\"";
+		}
+		json << "}";
+	}
+	json << "\n  ]\n}\n";
+	return json.str();
+}
+
+// Everything the bench families share: the options, the results so far and one Maze they all regenerate
+// 全てのベンチのファミリーが共有するもの：オプション、今までの結果、作り直して使うMaze１つ
+typedef struct BenchContext
+{
+	BenchConfig config;
+	std::vector<BenchResult> results;
+	Maze maze;
+};
+
+static bool IsSelected(const BenchContext& bench, const std::string& name)
+{
+	return bench.config.filter.empty() || name.find(bench.config.filter) != std::string::npos;
+}
+
+static void Report(BenchContext& bench, const BenchResult& r)
+{
+	std::cerr << r.name << " " << r.solver << " size=" << r.size << " wall=" << r.wallPercent
+		<< " dist=" << r.queryDistance << " workers=" << r.workers
+		<< " median=" << r.medianNs / 1000.0 << "us x" << r.iterations << "\n";
+	bench.results.push_back(r);
+}
+
+// Generation, every solver, extraction, vertices, nearest goals, layouts, topologies and weighted costs
+// on one grid size and wall percent
+// １つのグリッドサイズと壁の割合で生成、全てのソルバー、パスの抽出、頂点、一番近いゴール、並べ方、トポロジー、重み
+static bool RunWallBenches(BenchContext& bench, int size, int wallPercent)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+	long long cellCount = static_cast<long long>(size) * size;
+
+	// == GenerateMaze ==
+	if (IsSelected(bench, "generate"))
+	{
+		BenchResult r = { "generate", "", size, wallPercent };
+		r.items = cellCount;
+		RunTimed(config, r, [&]() { GenerateFixed(maze, size, wallPercent, config.seed); });
+		Report(bench, r);
+	}
+
+	GenerateFixed(maze, size, wallPercent, config.seed);
+
+	// == FindPath, every solver and query distance ==
+	for (float queryDistance : kQueryDistances)
+	{
+		int endIndex = FindOpenCell(maze, size, queryDistance);
+		int endX = endIndex % size;
+		int endY = endIndex / size;
+
+		for (const BenchSolver& solver : kSolvers)
+		{
+			if (!IsSelected(bench, std::string("solve/") + solver.name)) continue;
+
+			BenchResult r = { "solve", solver.name, size, wallPercent, queryDistance };
+			r.items = cellCount;
+			RunTimed(config, r, [&]() { r.pathLength = solver.solve(maze, endX, endY); });
+			Report(bench, r);
+		}
+
+		// == Path extraction (backtrack through parentIndex) ==
+		if (IsSelected(bench, "extract"))
+		{
+			kSolvers[0].solve(maze, endX, endY);
+			BenchResult r = { "extract", "", size, wallPercent, queryDistance };
+			r.pathLength = static_cast<long long>(maze.GetPath()->size());
+			r.items = r.pathLength;
+			if (r.pathLength > 0)
+			{
+				RunTimed(config, r, [&]() { maze.ExtractPath(endIndex); });
+				Report(bench, r);
+			}
+		}
+	}
+
+	// == Tile / vertex building, streamed through a fixed chunk ==
+	// == タイル／バーテックス作成、固定チャンクで流す ==
+	if (IsSelected(bench, "vertices"))
+	{
+		constexpr int kChunkCells = 4096;
+		std::vector<TileVertex> chunk(kChunkCells * kTileVertexCount);
+		std::vector<char> pathMask;
+		float cellWidth = 800.0f / size;
+		float cellHeight = 600.0f / size;
+
+		BenchResult r = { "vertices", "", size, wallPercent };
+		r.items = cellCount;
+		RunTimed(config, r, [&]()
+		{
+			GridVector& cells = *maze.GetMaze();
+			maze.BuildPathMask(pathMask);
+			for (size_t i = 0; i < cells.size(); i++)
+			{
+				BuildTileVertices(cells[i].x, cells[i].y, cellWidth, cellHeight, 800, 600,
+					cells[i].cost == kWallCost, pathMask[i] != 0, &chunk[(i % kChunkCells) * kTileVertexCount]);
+			}
+		});
+		Report(bench, r);
+	}
+
+	// == Nearest goal / multi-source, goals spread over the far half of the grid ==
+	// == 一番近いゴール／複数ソース、ゴールはグリッドの遠い半分に散らす ==
+	if (IsSelected(bench, "nearest"))
+	{
+		for (int goalCount : kNearestGoalCounts)
+		{
+			std::vector<int> goals(goalCount);
+			for (int g = 0; g < goalCount; g++)
+			{
+				goals[g] = FindOpenCell(maze, size, 0.5f + 0.5f * (g + 1) / goalCount);
+			}
+
+			BenchResult r = { "nearest", "k-" + std::to_string(goalCount) + "/single-pass", size, wallPercent };
+			r.items = cellCount;
+			RunTimed(config, r, [&]()
+			{
+				maze.FindNearestGoal(0, goals, benchWorkspace, benchPath);
+				r.pathLength = static_cast<long long>(benchPath.size());
+			});
+			Report(bench, r);
+
+			r = { "nearest", "k-" + std::to_string(goalCount) + "/separate", size, wallPercent };
+			r.items = cellCount;
+			RunTimed(config, r, [&]()
+			{
+				r.pathLength = -1;
+				for (int goal : goals)
+				{
+					if (maze.SolveBFS(0, goal, benchWorkspace, benchPath) && (r.pathLength == -1 || static_cast<long long>(benchPath.size()) < r.pathLength))
+					{
+						r.pathLength = static_cast<long long>(benchPath.size());
+					}
+				}
+			});
+			Report(bench, r);
+
+			// Goals as sources, distance field to the nearest one in one pass
+			// ゴールをソースにして、１回で一番近いものへの距離
+			r = { "nearest", "k-" + std::to_string(goalCount) + "/multi-source", size, wallPercent };
+			r.items = cellCount;
+			RunTimed(config, r, [&]()
+			{
+				maze.SolveMultiSourceBFS(goals, 0, benchWorkspace, benchPath);
+				r.pathLength = static_cast<long long>(benchPath.size());
+			});
+			Report(bench, r);
+		}
+	}
+
+	// == Cell layouts, from the corner to the last reachable cell so the search sweeps the whole grid ==
+	// == セルの並べ方、角から最後の到達できるセルまで ==
+	if (IsSelected(bench, "layout") && size <= kLayoutMaxSize)
+	{
+		GenerateFixed(maze, size, wallPercent, config.seed);
+		maze.SolveBFS(0, -1, benchWorkspace, benchPath);
+		int endIndex = maze.GetCellCount() - 1;
+		while (endIndex > 0 && benchWorkspace.GetDist(endIndex) == -1) endIndex--;
+		long long expectedLength = benchWorkspace.GetDist(endIndex) + 1;
+		auto runLayout = [&](const char* layoutName, auto& grid)
+		{
+			if (!grid.Build(maze)) return;
+			BenchResult r = { std::string("layout/") + layoutName, "bfs", size, wallPercent, 1.0f };
+			r.items = cellCount;
+			RunTimed(config, r, [&]()
+			{
+				grid.SolveBFS(0, endIndex, benchWorkspace, benchPath);
+				r.pathLength = static_cast<long long>(benchPath.size());
+			});
+			bool isPathOk = r.pathLength == expectedLength && benchPath.front() == 0 && benchPath.back() == endIndex;
+			std::cerr << "layout/" << layoutName << " size=" << size << ": " << (isPathOk ? "ok" : "WRONG PATH") << ", "
+				<< grid.GetStorageCount() << " slots for " << cellCount << " cells\n";
+			Report(bench, r);
+
+			r = { std::string("layout/") + layoutName, "astar", size, wallPercent, 1.0f };
+			r.items = cellCount;
+			RunTimed(config, r, [&]()
+			{
+				grid.SolveAStar(0, endIndex, benchWorkspace, benchPath);
+				r.pathLength = static_cast<long long>(benchPath.size());
+			});
+			Report(bench, r);
+		};
+
+		LayoutGrid<RowMajorLayout> rowMajorGrid;
+		LayoutGrid<MortonLayout> mortonGrid;
+		LayoutGrid<Tiled8Layout> tiledGrid;
+		if (IsSelected(bench, "layout/row-major")) runLayout("row-major", rowMajorGrid);
+		if (IsSelected(bench, "layout/morton")) runLayout("morton", mortonGrid);
+		if (IsSelected(bench, "layout/tiled-8")) runLayout("tiled-8", tiledGrid);
+	}
+
+	// == Padded grid, one solver instantiation per topology ==
+	// == パディング付きグリッド、トポロジーごとのソルバー ==
+	if (IsSelected(bench, "topology"))
+	{
+		PaddedGrid paddedGrid;
+		paddedGrid.Build(maze);
+		for (float queryDistance : kQueryDistances)
+		{
+			int endIndex = FindOpenCell(maze, size, queryDistance);
+			for (const BenchTopology& topology : kTopologies)
+			{
+				if (!IsSelected(bench, std::string("topology/") + topology.name)) continue;
+
+				BenchResult r = { "topology", topology.name, size, wallPercent, queryDistance };
+				r.items = cellCount;
+				RunTimed(config, r, [&]()
+				{
+					paddedGrid.SolveBFS(topology.topology, 0, endIndex, benchWorkspace, benchPath);
+					r.pathLength = static_cast<long long>(benchPath.size());
+				});
+				Report(bench, r);
+			}
+		}
+	}
+
+	// == Weighted grids, Dial's buckets vs binary heap on the same grid and queries ==
+	// == 重み付きグリッド、同じグリッドとクエリでバケットとヒープを比べる ==
+	if (IsSelected(bench, "solve-weighted"))
+	{
+		GenerateFixed(maze, size, wallPercent, config.seed, kWeightedMaxCost);
+		for (float queryDistance : kQueryDistances)
+		{
+			int endIndex = FindOpenCell(maze, size, queryDistance);
+			for (const BenchSolver& solver : kWeightedSolvers)
+			{
+				if (!IsSelected(bench, std::string("solve-weighted/") + solver.name)) continue;
+
+				BenchResult r = { "solve-weighted", solver.name, size, wallPercent, queryDistance };
+				r.items = cellCount;
+				RunTimed(config, r, [&]() { r.pathLength = solver.solve(maze, endIndex % size, endIndex / size); });
+				Report(bench, r);
+			}
+		}
+	}
+	return true;
+}
+
+// == Job system scaling: generation, batched BFS and vertex building ==
+// == ジョブシステムのスケーリング：生成、まとめたBFS、バーテックス作成 ==
+static bool RunScalingBenches(BenchContext& bench, int size)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+	long long cellCount = static_cast<long long>(size) * size;
+
+if (!IsSelected(bench, "parallel-generate") && !IsSelected(bench, "parallel-solve") && !IsSelected(bench, "parallel-bfs") &&
+	!IsSelected(bench, "parallel-vertices") && !IsSelected(bench, "parallel-analytics")) return true;
+MazeStats serialStats;
+for (int workers = 1; workers <= config.maxWorkers; workers *= 2)
+{
+	JobSystem jobs(workers);
+
+	if (IsSelected(bench, "parallel-generate"))
+	{
+		BenchResult r = { "parallel-generate", "", size, kScalingWallPercent };
+		r.items = cellCount;
+		r.workers = workers;
+		RunTimed(config, r, [&]()
+		{
+			maze.InitMaze(size, size, size, size);
+			maze.SetWallPercent(kScalingWallPercent);
+			maze.GenerateMazeParallel(jobs, config.seed);
+		});
+		Report(bench, r);
+	}
+
+	maze.InitMaze(size, size, size, size);
+	maze.SetWallPercent(kScalingWallPercent);
+	maze.GenerateMazeParallel(jobs, config.seed);
+
+	if (IsSelected(bench, "parallel-solve"))
+	{
+		// Goals spread along the diagonal, one workspace per worker
+		// 対角線上のゴール、ワーカーごとにワークスペース１つ
+		std::vector<int> goals(kScalingQueries);
+		for (int q = 0; q < kScalingQueries; q++)
+		{
+			goals[q] = FindOpenCell(maze, size, static_cast<float>(q + 1) / kScalingQueries);
+		}
+
+		BenchResult r = { "parallel-solve", "bfs-workspace", size, kScalingWallPercent };
+		r.items = cellCount * kScalingQueries;
+		r.workers = workers;
+		RunTimed(config, r, [&]()
+		{
+			jobs.ParallelFor(kScalingQueries, 1, [&](int begin, int end)
+			{
+				thread_local SearchWorkspace workspace;
+				thread_local std::vector<int> path;
+				for (int q = begin; q < end; q++) maze.SolveBFS(0, goals[q], workspace, path);
+			});
+		});
+		Report(bench, r);
+	}
+
+	if (IsSelected(bench, "parallel-bfs"))
+	{
+		// Full-grid distances have to match the serial solver before anything is timed
+		// 計測の前に全てのセルの距離がシリアル版と同じか確かめる
+		SearchWorkspace serialWorkspace;
+		FrontierWorkspace frontierWorkspace;
+		std::vector<int> path;
+		maze.SolveBFS(0, -1, serialWorkspace, path);
+		maze.SolveBFSParallel(jobs, 0, -1, frontierWorkspace, path);
+		for (int i = 0; i < maze.GetCellCount(); i++)
+		{
+			if (serialWorkspace.GetDist(i) != frontierWorkspace.GetDist(i))
+			{
+				std::cerr << "parallel-bfs: distance mismatch at cell " << i << " (size " << size << ", " << workers << " workers)\n";
+				return false;
+			}
+		}
+
+		int endIndex = FindOpenCell(maze, size, 1.0f);
+		BenchResult r = { "parallel-bfs", "bfs-parallel", size, kScalingWallPercent, 1.0f };
+		r.items = cellCount;
+		r.workers = workers;
+		RunTimed(config, r, [&]()
+		{
+			maze.SolveBFSParallel(jobs, 0, endIndex, frontierWorkspace, path);
+			r.pathLength = static_cast<long long>(path.size());
+		});
+		Report(bench, r);
+	}
+
+	if (IsSelected(bench, "parallel-analytics"))
+	{
+		// Every worker count has to give the same stats as the single worker
+		// 全てのワーカー数で１ワーカーと同じ結果になるか確かめる
+		MazeAnalytics analytics;
+		MazeStats stats;
+		BenchResult r = { "parallel-analytics", "", size, kScalingWallPercent };
+		r.items = cellCount;
+		r.workers = workers;
+		RunTimed(config, r, [&]() { analytics.Analyze(jobs, maze, stats); });
+		r.metric = "diameter";
+		r.value = static_cast<double>(stats.diameter);
+		r.unit = "cells";
+		if (workers == 1) serialStats = stats;
+		bool isSame = stats.openCells == serialStats.openCells && stats.deadEnds == serialStats.deadEnds &&
+			stats.junctions == serialStats.junctions && stats.components == serialStats.components &&
+			stats.corridors == serialStats.corridors && stats.corridorHistogram == serialStats.corridorHistogram &&
+			stats.diameter == serialStats.diameter;
+		std::cerr << "parallel-analytics size=" << size << " workers=" << workers << ": " << (isSame ? "" : "MISMATCH, ")
+			<< stats.openCells << " open, " << stats.deadEnds << " dead ends, " << stats.junctions << " junctions, "
+			<< stats.components << " components, " << stats.corridors << " corridors (longest " << stats.longestCorridor
+			<< "), diameter " << stats.diameter << ", pass " << stats.passMs << " ms + diameter " << stats.diameterMs << " ms\n";
+		if (!isSame) return false;
+		Report(bench, r);
+	}
+
+	if (IsSelected(bench, "parallel-vertices") && size <= kScalingMaxVertexSize)
+	{
+		std::vector<TileVertex> vertices;
+		MonotonicArena frameArena(TelemetryMemoryFrame);
+		BenchResult r = { "parallel-vertices", "", size, kScalingWallPercent };
+		r.items = cellCount;
+		r.workers = workers;
+		RunTimed(config, r, [&]()
+		{
+			frameArena.Reset();
+			BuildVertices(maze, jobs, 800, 600, vertices, frameArena);
+		});
+		Report(bench, r);
+	}
+}
+	return true;
+}
+
+// Every grid size from --min-size to --max-size: the wall percent cases, then job system scaling
+// --min-sizeから--max-sizeまでの全てのグリッドサイズ：壁の割合ごとのケース、そしてジョブシステムのスケーリング
+static bool RunGridBenches(BenchContext& bench)
+{
+	for (int size : kGridSizes)
+	{
+		if (size < bench.config.minSize || size > bench.config.maxSize) continue;
+		for (int wallPercent : kWallPercents)
+		{
+			if (!RunWallBenches(bench, size, wallPercent)) return false;
+		}
+		if (!RunScalingBenches(bench, size)) return false;
+	}
+	return true;
+}
+
+// == Agent simulation: one fixed tick per sample, items are agent steps per tick ==
+// == エージェントシミュレーション：サンプルごとに固定ティック１つ ==
+static bool RunSimulationBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	GenerateFixed(maze, kSimulationSize, kScalingWallPercent, config.seed);
+	for (int agentCount : kSimulationAgents)
+	{
+		for (int workers = 1; workers <= config.maxWorkers; workers *= 2)
+		{
+			JobSystem jobs(workers);
+			AgentSimulation simulation;
+			simulation.Reset(maze, agentCount, config.seed);
+			simulation.SetRepathBudget(agentCount);
+			simulation.Tick(jobs);	// first tick paths every agent
+
+			long long stepsBefore = simulation.GetAgentSteps();
+			BenchResult r = { "simulation", std::to_string(agentCount) + "-agents", kSimulationSize, kScalingWallPercent };
+			r.workers = workers;
+			RunTimed(config, r, [&]() { simulation.Tick(jobs); });
+			r.items = (simulation.GetAgentSteps() - stepsBefore) / r.iterations;
+			Report(bench, r);
+		}
+	}
+	return true;
+}
+
+// == Landmarks: build time per landmark count, then the same query batch with both heuristics ==
+// == ランドマーク：ランドマーク数ごとの作成時間、同じクエリを両方のヒューリスティックで ==
+static bool RunLandmarkBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+	if (kLandmarkSize > config.maxSize) return true;
+
+	struct LandmarkGrid { const char* name; MazeGeneratorType generator; int wallPercent; int maxCost; };
+	const LandmarkGrid grids[] = 
+	{
+		{ "backtracker", MazeGeneratorBacktracker, 0, 1 },
+		{ "random", MazeGeneratorRandom, 25, 1 },
+		{ "random-weighted", MazeGeneratorRandom, 10, kWeightedMaxCost },
+	};
+	for (const LandmarkGrid& grid : grids)
+	{
+		maze.SetGenerator(grid.generator);
+		GenerateFixed(maze, kLandmarkSize, grid.wallPercent, config.seed, grid.maxCost);
+		maze.SetGenerator(MazeGeneratorRandom);
+
+		// Queries between random open cells that are connected
+		// つながったランダムな空きセルの間のクエリ
+		std::vector<std::pair<int, int>> queries;
+		std::mt19937 rng(config.seed);
+		std::uniform_int_distribution<int> pickCell(0, maze.GetCellCount() - 1);
+		while (static_cast<int>(queries.size()) < kLandmarkQueries)
+		{
+			int start = pickCell(rng);
+			int goal = pickCell(rng);
+			if (maze.IsWall(start) || maze.IsWall(goal)) continue;
+			if (!maze.SolveDijkstra(start, goal, benchWorkspace, benchPath)) continue;
+			queries.push_back({ start, goal });
+		}
+
+		std::vector<int> expectedCost(kLandmarkQueries);
+		long long baselineExpanded = 0;
+		BenchResult r = { std::string("landmarks/") + grid.name, "manhattan", kLandmarkSize, grid.wallPercent };
+		r.items = kLandmarkQueries;
+		RunTimed(config, r, [&]()
+		{
+			baselineExpanded = 0;
+			for (int q = 0; q < kLandmarkQueries; q++)
+			{
+				maze.SolveAStar(queries[q].first, queries[q].second, benchWorkspace, benchPath);
+				expectedCost[q] = benchWorkspace.GetDist(queries[q].second);
+				baselineExpanded += benchWorkspace.expandedNodes;
+			}
+		});
+		double baselineNs = r.medianNs;
+		std::cerr << "landmarks " << grid.name << " manhattan: " << baselineExpanded / kLandmarkQueries << " expanded per query\n";
+		Report(bench, r);
+
+		for (int landmarkCount : kLandmarkCounts)
+		{
+			LandmarkTable landmarks;
+			r = { std::string("landmarks/") + grid.name, "build-k" + std::to_string(landmarkCount), kLandmarkSize, grid.wallPercent };
+			r.items = maze.GetCellCount();
+			RunTimed(config, r, [&]() { landmarks.Build(maze, landmarkCount); });
+			std::cerr << "landmarks " << grid.name << " k=" << landmarkCount << ": " << (landmarks.GetIsWide() ? 32 : 16) << "-bit, "
+				<< landmarks.GetMemoryBytes() / landmarks.GetLandmarkCount() << " bytes per landmark\n";
+			Report(bench, r);
+
+			long long altExpanded = 0;
+			int mismatches = 0;
+			r = { std::string("landmarks/") + grid.name, "alt-k" + std::to_string(landmarkCount), kLandmarkSize, grid.wallPercent };
+			r.items = kLandmarkQueries;
+			RunTimed(config, r, [&]()
+			{
+				altExpanded = 0;
+				mismatches = 0;
+				for (int q = 0; q < kLandmarkQueries; q++)
+				{
+					maze.SolveAStar(queries[q].first, queries[q].second, landmarks, benchWorkspace, benchPath);
+					mismatches += benchWorkspace.GetDist(queries[q].second) != expectedCost[q];
+					altExpanded += benchWorkspace.expandedNodes;
+				}
+			});
+			std::cerr << "landmarks " << grid.name << " alt k=" << landmarkCount << ": " << altExpanded / kLandmarkQueries
+				<< " expanded per query, " << mismatches << " cost mismatches, speedup x" << baselineNs / r.medianNs << "\n";
+			Report(bench, r);
+		}
+	}
+	return true;
+}
+
+// == Junction graph: build time and size, then the same query batch on the cells and on the graph ==
+// == ジャンクショングラフ：作成時間と大きさ、同じクエリをセルとグラフで ==
+static bool RunJunctionGraphBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	for (int size : kJunctionSizes)
+	{
+		if (size < config.minSize || size > config.maxSize) continue;
+		for (int braidPercent : kJunctionBraidPercents)
+		{
+			maze.SetGenerator(MazeGeneratorBacktracker);
+			GenerateFixed(maze, size, 0, config.seed);
+			maze.SetGenerator(MazeGeneratorRandom);
+			GridVector& cells = *maze.GetMaze();
+			std::mt19937 rng(config.seed);
+			for (GridIndex& cell : cells)
+			{
+				if (cell.cost == kWallCost && static_cast<int>(rng() % 100) < braidPercent) cell.cost = 1;
+			}
+
+			std::string name = "junction-graph/braid-" + std::to_string(braidPercent);
+			JunctionGraph graph;
+			BenchResult r = { name, "build", size, braidPercent };
+			r.items = maze.GetCellCount();
+			RunTimed(config, r, [&]() { graph.Build(maze); });
+			std::cerr << name << " size=" << size << ": " << graph.GetOpenCells() << " open cells, " << graph.GetFilledCells() << " filled, "
+				<< graph.GetNodeCount() << " nodes, " << graph.GetEdgeCount() << " edges (";
+			// A fully filled (tree) maze leaves no nodes at all, there is no ratio then
+			// 全て埋まった（木の）メイズはノードが残らない、その時は比がない
+			if (graph.GetNodeCount() > 0) std::cerr << "x" << static_cast<double>(graph.GetOpenCells()) / graph.GetNodeCount() << " fewer nodes";
+			else std::cerr << "reduction n/a";
+			std::cerr << "), " << graph.GetMemoryBytes() / 1024 << " KiB\n";
+			Report(bench, r);
+
+			std::vector<std::pair<int, int>> queries;
+			std::uniform_int_distribution<int> pickCell(0, maze.GetCellCount() - 1);
+			while (static_cast<int>(queries.size()) < kJunctionQueries)
+			{
+				int start = pickCell(rng);
+				int goal = pickCell(rng);
+				if (!maze.IsWall(start) && !maze.IsWall(goal)) queries.push_back({ start, goal });
+			}
+
+			std::vector<int> expectedCost(kJunctionQueries);
+			r = { name, "dijkstra-bucket", size, braidPercent };
+			r.items = kJunctionQueries;
+			RunTimed(config, r, [&]()
+			{
+				for (int q = 0; q < kJunctionQueries; q++)
+				{
+					bool isSolved = maze.SolveDijkstra(queries[q].first, queries[q].second, benchWorkspace, benchPath);
+					expectedCost[q] = isSolved ? benchWorkspace.GetDist(queries[q].second) : -1;
+				}
+			});
+			double baselineNs = r.medianNs;
+			Report(bench, r);
+
+			int mismatches = 0;
+			r = { name, "junction-graph", size, braidPercent };
+			r.items = kJunctionQueries;
+			RunTimed(config, r, [&]()
+			{
+				mismatches = 0;
+				for (int q = 0; q < kJunctionQueries; q++)
+				{
+					int pathCost = -1;
+					if (graph.Solve(queries[q].first, queries[q].second, benchWorkspace, benchPath))
+					{
+						pathCost = 0;
+						for (size_t i = 1; i < benchPath.size(); i++) pathCost += maze.GetCost(benchPath[i]);
+					}
+					mismatches += pathCost != expectedCost[q];
+				}
+			});
+			std::cerr << name << " size=" << size << ": " << mismatches << " cost mismatches, speedup x" << baselineNs / r.medianNs << "\n";
+			Report(bench, r);
+		}
+	}
+	return true;
+}
+
+// == Cooperative A*: items are agents planned per round, every plan is checked for collisions ==
+// == 協調A*：アイテムは１回で計画したエージェント数、全ての計画の衝突を確かめる ==
+static bool RunCooperativeBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	GenerateFixed(maze, kCooperativeSize, kScalingWallPercent, config.seed);
+	for (int agentCount : kCooperativeAgents)
+	{
+		AgentSimulation simulation;
+		simulation.Reset(maze, agentCount, config.seed);
+		std::vector<int> order(agentCount), starts(agentCount), goals(agentCount);
+		for (int agent = 0; agent < agentCount; agent++)
+		{
+			order[agent] = agent;
+			starts[agent] = simulation.GetPosition(agent);
+			goals[agent] = simulation.GetGoal(agent);
+		}
+
+		CooperativePlanner planner;
+		planner.SetWindow(kCooperativeWindow);
+		std::vector<std::vector<int>> paths;
+		BenchResult r = { "cooperative", "whca-" + std::to_string(kCooperativeWindow), kCooperativeSize, kScalingWallPercent };
+		r.items = agentCount;
+		RunTimed(config, r, [&]() { planner.PlanWindow(maze, order, starts, goals, paths); });
+
+		// Two agents on one cell at one tick is a vertex collision, counted from tick 1 on
+		// because random starts may already share a cell
+		// 同じティックに同じセルに２つのエージェントは衝突、ランダムなスタートは重なるかもしれないのでティック1から
+		SpaceTimeTable occupied;
+		auto countCollisions = [&]()
+		{
+			occupied.Clear(agentCount * (kCooperativeWindow + 1));
+			int collisions = 0;
+			for (int agent = 0; agent < agentCount; agent++)
+			{
+				for (int time = 1; time <= kCooperativeWindow; time++)
+				{
+					collisions += !occupied.Insert(paths[agent][time], time, agent);
+				}
+			}
+			return collisions;
+		};
+		int collisions = countCollisions();
+		std::cerr << "cooperative " << agentCount << " agents: " << planner.GetFailedAgents() << " waiting, "
+			<< collisions << " collisions, " << planner.GetExpandedNodes() << " expanded\n";
+		Report(bench, r);
+
+		// Starved of expansions most agents wait, the ones in their way give way, so the only collisions
+		// left are the conflicts the planner reports (two waiting agents on one start cell)
+		// 展開が足りないとほとんどが待つ、邪魔なエージェントは道を譲るので、残る衝突は報告された衝突だけ
+		planner.SetMaxExpansions(kCooperativeTightExpansions);
+		BenchResult tight = { "cooperative", "whca-" + std::to_string(kCooperativeWindow) + "-tight", kCooperativeSize, kScalingWallPercent };
+		tight.items = agentCount;
+		RunTimed(config, tight, [&]() { planner.PlanWindow(maze, order, starts, goals, paths); });
+		collisions = countCollisions();
+		std::cerr << "cooperative " << agentCount << " agents, " << kCooperativeTightExpansions << " expansions: "
+			<< (collisions == planner.GetConflicts() ? "ok" : "UNREPORTED COLLISIONS") << ", " << planner.GetFailedAgents() << " waiting, "
+			<< planner.GetDisplacedAgents() << " gave way, " << collisions << " collisions\n";
+		Report(bench, tight);
+
+		// The simulation slices every round over the window / 2 ticks before it, so its worst tick
+		// is a fraction of a whole round
+		// シミュレーションは各回をその前の window / 2 ティックに分けるので、一番遅いティックも１回の一部
+		JobSystem jobs(1);
+		simulation.GetPlanner().SetWindow(kCooperativeWindow);
+		simulation.SetIsCooperative(true);
+		BenchConfig tickConfig = config;
+		tickConfig.minTimeMs = std::numeric_limits<int>::max();
+		tickConfig.maxIterations = kCooperativeTicks;
+		BenchResult ticks = { "cooperative", "sim-tick", kCooperativeSize, kScalingWallPercent };
+		ticks.items = agentCount;
+		RunTimed(tickConfig, ticks, [&]() { simulation.Tick(jobs); });
+
+		// Agents follow their reservations, so after the first round no two share a cell
+		// エージェントは予約に従うので、最初の回の後は２つが同じセルにいることはない
+		int tickCollisions = 0;
+		for (int tick = 0; tick < kCooperativeWindow; tick++)
+		{
+			simulation.Tick(jobs);
+			occupied.Clear(agentCount);
+			for (int agent = 0; agent < agentCount; agent++)
+			{
+				tickCollisions += !occupied.Insert(simulation.GetPosition(agent), 0, agent);
+			}
+		}
+		std::cerr << "cooperative " << agentCount << " agents, simulation: worst tick " << ticks.maxNs / 1e6 << " ms against "
+			<< r.medianNs / 1e6 << " ms for a whole round, " << tickCollisions << " collisions\n";
+		Report(bench, ticks);
+	}
+	return true;
+}
+
+// == External-memory BFS: paged grid + level files against the in-memory BFS on the same walls ==
+// == 外部メモリBFS：同じ壁でページングしたグリッドとメモリ上のBFSを比べる ==
+static bool RunExternalBfsBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	for (int size : kExternalSizes)
+	{
+		if (size < config.minSize || size > config.maxSize) continue;
+		JobSystem jobs(1);
+		maze.InitMaze(size, size, size, size);
+		maze.SetWallPercent(kScalingWallPercent);
+		maze.GenerateMazeParallel(jobs, config.seed);
+		maze.SolveBFS(0, -1, benchWorkspace, benchPath);
+		int endIndex = maze.GetCellCount() - 1;
+		while (endIndex > 0 && benchWorkspace.GetDist(endIndex) == -1) endIndex--;
+
+		BenchResult r = { "external-bfs", "in-memory", size, kScalingWallPercent, 1.0f };
+		r.items = maze.GetCellCount();
+		RunTimed(config, r, [&]()
+		{
+			maze.SolveBFS(0, endIndex, benchWorkspace, benchPath);
+			r.pathLength = static_cast<long long>(benchPath.size());
+		});
+		long long expectedLength = r.pathLength;
+		Report(bench, r);
+
+		PagedGrid grid;
+		std::string gridName = PagedGrid::MakeWorkFileName(".", "mazebench_paged");
+		if (!grid.Create(gridName, size, size, kExternalMemoryCap)) continue;
+		if (!grid.GenerateRandom(kScalingWallPercent, config.seed))
+		{
+			grid.Close();
+			std::remove(gridName.c_str());
+			continue;
+		}
+
+		ExternalBFS search;
+		search.SetMemoryCap(kExternalMemoryCap);
+		std::vector<long long> externalPath;
+		r = { "external-bfs", "paged", size, kScalingWallPercent, 1.0f };
+		r.items = maze.GetCellCount();
+		long long gridReadBefore = grid.GetBytesRead();
+		RunTimed(config, r, [&]()
+		{
+			search.Solve(grid, 0, endIndex, externalPath);
+			r.pathLength = static_cast<long long>(externalPath.size());
+		});
+		std::cerr << "external-bfs size=" << size << ": " << (r.pathLength == expectedLength ? "length ok" : "LENGTH MISMATCH")
+			<< ", " << search.GetLevelCount() << " levels, " << search.GetVisitedCount() << " visited, level files "
+			<< search.GetBytesRead() / 1024 << " KiB read / " << search.GetBytesWritten() / 1024 << " KiB written, grid "
+			<< (grid.GetBytesRead() - gridReadBefore) / r.iterations / 1024 << " KiB read per solve ("
+			<< grid.GetResidentBytes() / 1024 << " KiB resident), peak RSS " << Profiler::GetPeakResidentBytes() / (1024 * 1024) << " MiB\n";
+		if (r.pathLength != expectedLength) return false;
+		Report(bench, r);
+		grid.Close();
+		std::remove(gridName.c_str());
+	}
+	return true;
+}
+
+// == Sharded BFS: every cell's distance is checked against SolveBFS, then a corner-to-far-corner query ==
+// == 帯に分けたBFS：全てのセルの距離をSolveBFSと比べてから、角から遠い角までのクエリ ==
+static bool RunShardedBfsBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	for (int size : kShardedSizes)
+	{
+		if (size < config.minSize || size > config.maxSize) continue;
+		GenerateFixed(maze, size, kScalingWallPercent, config.seed);
+		maze.SolveBFS(0, -1, benchWorkspace, benchPath);
+		int endIndex = maze.GetCellCount() - 1;
+		while (endIndex > 0 && benchWorkspace.GetDist(endIndex) == -1) endIndex--;
+
+		for (int processes = 1; processes <= config.maxWorkers && processes <= ShardedSolver::kMaxProcesses; processes *= 2)
+		{
+			ShardedSolver solver;
+			solver.SetProcessCount(processes);
+			std::vector<int> path;
+			solver.Solve(maze, 0, -1, path);
+			for (int i = 0; i < maze.GetCellCount(); i++)
+			{
+				if (solver.GetDist(i) != benchWorkspace.GetDist(i))
+				{
+					std::cerr << "sharded-bfs: distance mismatch at cell " << i << " (size " << size << ", " << processes << " processes)\n";
+					return false;
+				}
+			}
+
+			BenchResult r = { "sharded-bfs", "processes", size, kScalingWallPercent, 1.0f };
+			r.items = maze.GetCellCount();
+			r.workers = processes;
+			RunTimed(config, r, [&]()
+			{
+				solver.Solve(maze, 0, endIndex, path);
+				r.pathLength = static_cast<long long>(path.size());
+			});
+			std::cerr << "sharded-bfs size=" << size << " processes=" << processes << ": " << solver.GetLevelCount() << " levels, "
+				<< solver.GetCellsExchanged() << " cells exchanged, " << solver.GetSharedBytes() / 1024 << " KiB shared\n";
+			Report(bench, r);
+		}
+
+#ifdef MAZE_FAULT_INJECTION
+		// One worker dies after its first level, Solve has to return false instead of leaving the rest on the barrier
+		// A hang can't be cancelled, so the bench gives up on the whole run after kShardedKillTimeout
+		// １つのワーカーが最初のレベルの後に死ぬ、残りをバリアに置いたままにせずfalseを返すこと
+		int killProcesses = std::min({ 4, config.maxWorkers, ShardedSolver::kMaxProcesses });
+		if (killProcesses >= 2)
+		{
+			ShardedSolver solver;
+			solver.SetProcessCount(killProcesses);
+			solver.SetFailingWorker(1);
+			std::vector<int> path;
+			auto start = std::chrono::steady_clock::now();
+			std::future<bool> solved = std::async(std::launch::async, [&]() { return solver.Solve(maze, 0, endIndex, path); });
+			if (solved.wait_for(kShardedKillTimeout) != std::future_status::ready)
+			{
+				std::cerr << "sharded-bfs: Solve hung after worker 1 was killed (size " << size << ", " << killProcesses << " processes)\n";
+				std::_Exit(1);
+			}
+			if (solved.get())
+			{
+				std::cerr << "sharded-bfs: Solve succeeded although worker 1 was killed (size " << size << ")\n";
+				return false;
+			}
+			std::cerr << "sharded-bfs size=" << size << " processes=" << killProcesses << ": worker 1 killed, Solve returned false after "
+				<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+		}
+#endif
+	}
+	return true;
+}
+
+// == Path cache: FindPath on a repeated query stream with the cache off, on, and on with wall edits ==
+// == パスキャッシュ：繰り返すクエリをキャッシュなし、あり、壁の編集ありで ==
+static bool RunPathCacheBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+	if (kPathCacheSize > config.maxSize) return true;
+
+	GenerateFixed(maze, kPathCacheSize, kScalingWallPercent, config.seed);
+	std::mt19937 rng(config.seed);
+	std::uniform_int_distribution<int> pickCell(0, maze.GetCellCount() - 1);
+	std::vector<std::pair<int, int>> pairs;
+	while (static_cast<int>(pairs.size()) < kPathCachePairs)
+	{
+		int start = pickCell(rng);
+		int goal = pickCell(rng);
+		if (!maze.IsWall(start) && !maze.IsWall(goal)) pairs.push_back({ start, goal });
+	}
+
+	// Low pair numbers come up more often (min of two uniform draws)
+	// 小さい番号のペアが多く出る（２回引いた小さい方）
+	std::uniform_int_distribution<int> pickPair(0, kPathCachePairs - 1);
+	std::vector<int> order(kPathCacheQueries);
+	for (int& pair : order) pair = std::min(pickPair(rng), pickPair(rng));
+
+	// Walls added during a pass are opened again at the end, which bumps the version
+	// 途中で置いた壁は最後に開ける、バージョンが上がる
+	auto runQueries = [&](bool isEditing)
+	{
+		long long totalLength = 0;
+		std::vector<int> addedWalls;
+		for (int q = 0; q < kPathCacheQueries; q++)
+		{
+			auto [start, goal] = pairs[order[q]];
+			maze.FindPath(start % kPathCacheSize, start / kPathCacheSize, goal % kPathCacheSize, goal / kPathCacheSize);
+			GridVector& path = *maze.GetPath();
+			totalLength += static_cast<long long>(path.size());
+			if (isEditing && q % kPathCacheEditEvery == kPathCacheEditEvery - 1 && path.size() > 2)
+			{
+				const GridIndex& cell = path[path.size() / 2];
+				addedWalls.push_back(cell.y * kPathCacheSize + cell.x);
+				maze.SetWall(addedWalls.back(), true);
+			}
+		}
+		for (int cell : addedWalls) maze.SetWall(cell, false);
+		return totalLength;
+	};
+
+	for (bool isEditing : { false, true })
+	{
+		std::string variant = isEditing ? "-edits" : "";
+		PathCache& cache = maze.GetPathCache();
+		cache.SetCapacity(0);
+		long long expectedLength = 0;
+		BenchResult r = { "path-cache", "uncached" + variant, kPathCacheSize, kScalingWallPercent };
+		r.items = kPathCacheQueries;
+		RunTimed(config, r, [&]() { expectedLength = runQueries(isEditing); });
+		r.pathLength = expectedLength;
+		Report(bench, r);
+
+		cache.SetCapacity(256);
+		long long cachedLength = 0;
+		long long hitsBefore = cache.GetHits();
+		long long missesBefore = cache.GetMisses();
+		long long invalidationsBefore = cache.GetInvalidations();
+		r = { "path-cache", "cached" + variant, kPathCacheSize, kScalingWallPercent };
+		r.items = kPathCacheQueries;
+		RunTimed(config, r, [&]()
+		{
+			cache.Clear();
+			cachedLength = runQueries(isEditing);
+		});
+		r.pathLength = cachedLength;
+		std::cerr << "path-cache" << variant << ": " << (cachedLength == expectedLength ? "lengths ok" : "LENGTH MISMATCH") << ", "
+			<< (cache.GetHits() - hitsBefore) / r.iterations << " hits / " << (cache.GetMisses() - missesBefore) / r.iterations << " misses / "
+			<< (cache.GetInvalidations() - invalidationsBefore) / r.iterations << " invalidated per pass\n";
+		if (cachedLength != expectedLength) return false;
+		Report(bench, r);
+	}
+	maze.GetPathCache().SetCapacity(0);
+	return true;
+}
+
+// == Steady state: heap allocations per pass once FindPath and the frame temporaries are warmed up ==
+// == 定常状態：温めた後のFindPathとフレームの一時データのパスごとのアロケーション ==
+static bool RunSteadyStateBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+	if (kSteadyStateSize > config.maxSize) return true;
+
+	GenerateFixed(maze, kSteadyStateSize, kScalingWallPercent, config.seed);
+	std::mt19937 rng(config.seed);
+	std::uniform_int_distribution<int> pickCell(0, maze.GetCellCount() - 1);
+	std::vector<std::pair<int, int>> pairs;
+	while (static_cast<int>(pairs.size()) < kSteadyStateQueries)
+	{
+		int start = pickCell(rng);
+		int goal = pickCell(rng);
+		if (!maze.IsWall(start) && !maze.IsWall(goal)) pairs.push_back({ start, goal });
+	}
+
+	// A frame as Canvas::RenderGraphics draws it: the camera between two updates, the visible quads
+	// built by BuildVisibleVertices on the job workers, and the window title in the frame arena
+	// Canvas::RenderGraphicsと同じフレーム：２つの更新の間のカメラ、ワーカーで作る見える四角形、タイトルはアリーナ
+	constexpr size_t kTitleLength = 256;
+	JobSystem frameJobs(kSteadyStateWorkers);
+	MonotonicArena frameArena(TelemetryMemoryFrame);
+	maze.FindPath(0, 0, kSteadyStateSize / 2, kSteadyStateSize * 2 / 3);
+	CellPyramid framePyramid;
+	framePyramid.Build(frameJobs, maze);
+	MazeCamera fitCamera;
+	fitCamera.SetScreenSize(800, 600);
+	fitCamera.Fit(kSteadyStateSize, kSteadyStateSize);
+	MazeCamera zoomCamera = fitCamera;
+	zoomCamera.Zoom(kViewZoomPixelsPerCell / fitCamera.GetPixelsPerCell(), 400.0f, 300.0f);
+	MazeCamera frameCamera;
+	MazeCamera previousCamera;
+	std::vector<TileVertex> frameVertices;
+
+	long long totalLength = 0;
+	auto runPass = [&](bool isFrame)
+	{
+		totalLength = 0;
+		if (isFrame)
+		{
+			frameArena.Reset();
+			MazeCamera camera = MazeCamera::Lerp(previousCamera, frameCamera, 0.5);
+			int level = BuildVisibleVertices(frameJobs, camera, framePyramid, frameVertices);
+			char* title = frameArena.AllocateArray<char>(kTitleLength);
+			snprintf(title, kTitleLength, "mazebench - frame p50 %.2f ms / p99 %.2f ms - level %d, %zu quads",
+				0.0, 0.0, level, frameVertices.size() / kTileVertexCount);
+			totalLength = static_cast<long long>(frameVertices.size() / kTileVertexCount);
+			return;
+		}
+		for (auto [start, goal] : pairs)
+		{
+			maze.FindPath(start % kSteadyStateSize, start / kSteadyStateSize, goal % kSteadyStateSize, goal / kSteadyStateSize);
+			totalLength += static_cast<long long>(maze.GetPath()->size());
+		}
+	};
+
+	for (const char* variant : { "find-path", "find-path-cached", "frame", "frame-zoomed" })
+	{
+		bool isFrame = std::string(variant).compare(0, 5, "frame") == 0;
+		frameCamera = (std::string(variant) == "frame-zoomed") ? zoomCamera : fitCamera;
+		previousCamera = frameCamera;
+		previousCamera.Pan(-8.0f, -8.0f);
+		maze.GetPathCache().SetCapacity(std::string(variant) == "find-path-cached" ? kSteadyStateQueries : 0);
+
+		// Two warm-up passes: the first sizes the arenas (and fills the cache), the second's Reset grows them to fit
+		// 温めは２回：１回目でアリーナの大きさが決まる（キャッシュも埋まる）、２回目のResetで大きくなる
+		runPass(isFrame);
+		runPass(isFrame);
+
+		long long allocations = 0;
+		BenchResult r = { "steady-state", variant, kSteadyStateSize, kScalingWallPercent };
+		r.items = isFrame ? static_cast<long long>(frameVertices.size() / kTileVertexCount) : kSteadyStateQueries;
+		RunTimed(config, r, [&]()
+		{
+			long long before = heapAllocations.load(std::memory_order_relaxed);
+			runPass(isFrame);
+			allocations += heapAllocations.load(std::memory_order_relaxed) - before;
+		});
+		if (!isFrame) r.pathLength = totalLength;
+		std::cerr << "steady-state " << variant << ": " << (allocations == 0 ? "ok" : "ALLOCATED") << ", "
+			<< allocations << " operator new in " << r.iterations << " passes\n";
+		Report(bench, r);
+	}
+	maze.GetPathCache().SetCapacity(0);
+	return true;
+}
+
+// == Session log: encode and decode a recorded session ==
+// == セッションログ：記録したセッションのエンコードとデコード ==
+static bool RunSessionBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+
+	SessionLog session;
+	SessionHeader header;
+	header.seed = config.seed;
+	header.screenWidth = 800;
+	header.screenHeight = 600;
+	header.simulationAgents = 10000;
+	header.sliceBudgetMicroseconds = 4000;
+	header.mazeCells = 2048;
+	session.SetHeader(header);
+
+	std::mt19937 rng(config.seed);
+	std::uniform_int_distribution<int> jitter(-500, 500);
+	long long timeMicroseconds = 0;
+	for (int frame = 0; frame < kSessionFrames; frame++)
+	{
+		if (frame % 100 == 50) session.Append(frame, timeMicroseconds, SessionEventKeyDown, 's');
+		if (frame == 600) session.Append(frame, timeMicroseconds, SessionEventKeyHeld, 10);
+		if (frame >= 600 && frame < 660) session.Append(frame, timeMicroseconds, SessionEventSlices, 40 + jitter(rng) / 50);
+		if (frame == 660) session.Append(frame, timeMicroseconds, SessionEventMazeSwap);
+		int frameMicroseconds = 16667 + jitter(rng);
+		session.Append(frame, timeMicroseconds, SessionEventFrame, frameMicroseconds);
+		timeMicroseconds += frameMicroseconds;
+	}
+	session.SetDigest(0x0123456789ABCDEFull);
+
+	SessionLog loaded;
+	BenchResult r = { "session", "save-load", kSessionFrames };
+	r.items = static_cast<long long>(session.GetEvents().size());
+	bool isSame = false;
+	RunTimed(config, r, [&]()
+	{
+		isSame = session.Save("mazebench_session.bin") && loaded.Load("mazebench_session.bin");
+	});
+	const std::vector<SessionEvent>& written = session.GetEvents();
+	const std::vector<SessionEvent>& read = loaded.GetEvents();
+	isSame = isSame && read.size() == written.size() && loaded.GetDigest() == session.GetDigest() &&
+		loaded.GetHeader().seed == header.seed && loaded.GetHeader().sliceBudgetMicroseconds == header.sliceBudgetMicroseconds &&
+		loaded.GetHeader().mazeCells == header.mazeCells;
+	for (size_t i = 0; isSame && i < written.size(); i++)
+	{
+		isSame = read[i].frame == written[i].frame && read[i].timeMicroseconds == written[i].timeMicroseconds &&
+			read[i].type == written[i].type && read[i].value == written[i].value;
+	}
+	size_t bytes = session.GetEncodedBytes();
+	std::cerr << "session: " << (isSame ? "round trip ok" : "ROUND TRIP MISMATCH") << ", " << written.size() << " events in "
+		<< bytes << " bytes (" << static_cast<double>(bytes) / kSessionFrames << " bytes per frame)\n";
+	std::remove("mazebench_session.bin");
+	if (!isSame) return false;
+	r.metric = "encoded_size";
+	r.value = static_cast<double>(bytes);
+	r.unit = "bytes";
+	Report(bench, r);
+	return true;
+}
+
+// == Frame loop: fixed updates against different display rates, then uncapped ==
+// == フレームループ：色々なディスプレイのレートに固定の更新、そして上限なし ==
+static bool RunFrameLoopBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+
+	// Steps the loop every stepNs for kFrameLoopSeconds, the way a display of that rate would
+	// kFrameLoopSeconds秒の間、stepNsごとにループを進める（そのレートのディスプレイのように）
+	auto simulate = [](FrameLoop& loop, int64_t stepNs, int64_t hitchAtNs = -1)
+	{
+		const int64_t endNs = kFrameLoopSeconds * 1000000000ll;
+		bool isHitched = false;
+		for (int64_t nowNs = 0; nowNs <= endNs; nowNs += stepNs)
+		{
+			if (hitchAtNs >= 0 && nowNs >= hitchAtNs && !isHitched)
+			{
+				nowNs += 1000000000ll;
+				isHitched = true;
+			}
+			loop.Step(nowNs);
+		}
+	};
+	// The update step is rounded to whole nanoseconds, so the last update may land just past the end
+	// 更新のステップはナノ秒に丸めるので、最後の更新は終わりのすぐ後になることがある
+	auto isAbout = [](long long count, long long expected) { return std::abs(count - expected) <= 1; };
+
+	FrameLoopConfig loopConfig;
+	long long updates = 0;
+	double minAlpha = 1.0;
+	double maxAlpha = 0.0;
+	FrameLoop loop;
+	loop.SetConfig(loopConfig);
+	loop.SetUpdate([&updates](double) { updates++; });
+	loop.SetRender([&minAlpha, &maxAlpha](double alpha) { minAlpha = std::min(minAlpha, alpha); maxAlpha = std::max(maxAlpha, alpha); });
+
+	// 144 Hz display: ~2.4 renders per update, every render sees an alpha inside [0, 1)
+	// 144 Hzのディスプレイ：更新１回に約2.4回の描画、alphaは全て[0, 1)の中
+	simulate(loop, 1000000000ll / 144);
+	bool isFastOk = isAbout(loop.GetUpdateCount(), kFrameLoopSeconds * 60) && loop.GetRenderCount() == kFrameLoopSeconds * 144 + 1 &&
+		updates == loop.GetUpdateCount() && minAlpha >= 0.0 && maxAlpha < 1.0;
+	std::cerr << "frame-loop: 144 Hz display " << (isFastOk ? "ok" : "WRONG") << ", " << loop.GetUpdateCount() << " updates, "
+		<< loop.GetRenderCount() << " frames, measured " << loop.GetUpdateRate() << " / " << loop.GetRenderRate() << " per second\n";
+
+	// 30 Hz display: two updates per render
+	// 30 Hzのディスプレイ：描画１回に更新２回
+	loop.Reset();
+	simulate(loop, 1000000000ll / 30);
+	bool isSlowOk = isAbout(loop.GetUpdateCount(), kFrameLoopSeconds * 60) && loop.GetRenderCount() == kFrameLoopSeconds * 30 + 1;
+	std::cerr << "frame-loop: 30 Hz display " << (isSlowOk ? "ok" : "WRONG") << ", " << loop.GetUpdateCount() << " updates, "
+		<< loop.GetRenderCount() << " frames\n";
+
+	// 30 Hz render cap, stepped at 1 kHz: the render rate follows the cap, not the stepping
+	// 30 Hzの描画上限、1 kHzで進める：描画レートは進める速さでなく上限に従う
+	loopConfig.renderHz = 30.0;
+	loop.SetConfig(loopConfig);
+	loop.Reset();
+	simulate(loop, 1000000);
+	bool isCappedOk = isAbout(loop.GetUpdateCount(), kFrameLoopSeconds * 60) && loop.GetRenderCount() == kFrameLoopSeconds * 30 + 1;
+	std::cerr << "frame-loop: 30 Hz cap " << (isCappedOk ? "ok" : "WRONG") << ", " << loop.GetUpdateCount() << " updates, "
+		<< loop.GetRenderCount() << " frames\n";
+
+	// One second hitch: the clamp lets 250 ms of the 61 ticks through, 8 updates catch up and the other 7 are dropped
+	// １秒の停止：61ティックのうち250 msだけ入れて、８回の更新で追いつき、残りの７回は捨てる
+	loopConfig.renderHz = 0.0;
+	loop.SetConfig(loopConfig);
+	loop.Reset();
+	simulate(loop, 1000000000ll / 60, 3000000000ll);
+	bool isHitchOk = loop.GetDroppedUpdates() == 7 && isAbout(loop.GetUpdateCount(), kFrameLoopSeconds * 60 - 61 + 8);
+	std::cerr << "frame-loop: hitch " << (isHitchOk ? "ok" : "WRONG") << ", " << loop.GetUpdateCount() << " updates, "
+		<< loop.GetDroppedUpdates() << " dropped\n";
+
+	// Uncapped (benchmark mode) on the real clock, with the loop doing nothing else the rates are its own overhead
+	// 上限なし（ベンチマークモード）を実時間で、ループだけなのでレートはループ自体のコスト
+	FrameLoop uncapped;
+	uncapped.SetIsUncapped(true);
+	long long presents = 0;
+	uncapped.SetUpdate([](double) {});
+	uncapped.SetPresent([&presents](bool isVsync) { presents += isVsync ? 0 : 1; });
+	BenchResult r = { "frame-loop", "uncapped", 0 };
+	r.items = kFrameLoopUncappedSteps;
+	int64_t startNs = Profiler::Now();
+	RunTimed(config, r, [&]()
+	{
+		for (int i = 0; i < kFrameLoopUncappedSteps; i++) uncapped.Step(Profiler::Now());
+	});
+
+	// The timed batches can be over in a few ms, far too few 60 Hz updates for a rate, so the loop
+	// keeps stepping until a second has passed and the rates are counted over the whole run
+	// 計測は数msで終わることがあり、60 Hzの更新ではレートにならないので、１秒経つまで進めて全体で数える
+	while (Profiler::Now() - startNs < kFrameLoopUncappedMinNs)
+	{
+		for (int i = 0; i < kFrameLoopUncappedSteps; i++) uncapped.Step(Profiler::Now());
+	}
+	double seconds = (Profiler::Now() - startNs) / 1e9;
+	double renderRate = uncapped.GetRenderCount() / seconds;
+	bool isUpdateRateOk = isAbout(uncapped.GetUpdateCount(), static_cast<long long>(seconds * 60.0));
+	std::cerr << "frame-loop: uncapped over " << seconds << " s, " << uncapped.GetUpdateCount() / seconds << " updates/s ("
+		<< (isUpdateRateOk ? "fixed rate ok" : "NOT 60 Hz") << "), " << renderRate << " frames/s, "
+		<< (presents == uncapped.GetRenderCount() ? "every present without vsync" : "VSYNC'D PRESENT") << "\n";
+	r.metric = "render_rate";
+	r.value = renderRate;
+	r.unit = "frames/s";
+	Report(bench, r);
+	return true;
+}
+
+// == View: pyramid build and visible quads, the frame cost follows the screen and not the maze ==
+// == ビュー：ピラミッドの作成と見える四角形、フレームのコストはメイズでなく画面に従う ==
+static bool RunViewBench(BenchContext& bench)
+{
+	const BenchConfig& config = bench.config;
+	Maze& maze = bench.maze;
+
+	// One worker per hardware thread like Canvas, at most --max-workers
+	// Canvasと同じくハードウェアスレッドごとに１つ、最大--max-workers
+	JobSystem jobs(std::min(config.maxWorkers, std::max(1, static_cast<int>(std::thread::hardware_concurrency()))));
+	CellPyramid pyramid;
+	std::vector<TileVertex> vertices;
+	// Every visible sample is at least kMinSamplePixels wide, plus a partly visible one on each edge
+	// 見えるサンプルは全てkMinSamplePixels以上、それに両端の一部見えるもの
+	const size_t maxQuads = static_cast<size_t>(kViewScreenW / MazeCamera::kMinSamplePixels + 2) *
+		static_cast<size_t>(kViewScreenH / MazeCamera::kMinSamplePixels + 2);
+
+	for (int size : kViewSizes)
+	{
+		if (size < config.minSize || size > config.maxSize) continue;
+		GenerateFixed(maze, size, kScalingWallPercent, config.seed);
+		int goal = FindOpenCell(maze, size, 0.9f);
+		maze.FindPath(0, 0, goal % size, goal / size);
+		long long cellCount = static_cast<long long>(size) * size;
+
+		BenchResult build = { "view", "build", size, kScalingWallPercent };
+		build.items = cellCount;
+		build.workers = jobs.GetWorkerCount();
+		RunTimed(config, build, [&]() { pyramid.Build(jobs, maze); });
+		Report(bench, build);
+
+		// The single top sample is the wall share of the whole grid, give or take a rounding per level
+		// 一番上のサンプルはグリッド全体の壁の割合、レベルごとの丸めの分だけずれてもいい
+		long long walls = 0;
+		for (int i = 0; i < maze.GetCellCount(); i++) walls += maze.IsWall(i) ? 1 : 0;
+		int expectedWall = static_cast<int>((walls * 255 + cellCount / 2) / cellCount);
+		const CellLevel& top = pyramid.GetLevel(pyramid.GetLevelCount() - 1);
+		bool isTopOk = top.width == 1 && top.height == 1 &&
+			std::abs(top.samples[0].wall - expectedWall) <= pyramid.GetLevelCount() &&
+			(top.samples[0].path != 0) == !maze.GetPath()->empty();
+
+		MazeCamera camera;
+		camera.SetScreenSize(kViewScreenW, kViewScreenH);
+		camera.Fit(size, size);
+		MazeCamera zoomed = camera;
+		zoomed.Zoom(kViewZoomPixelsPerCell / camera.GetPixelsPerCell(), kViewScreenW * 0.5f, kViewScreenH * 0.5f);
+
+		for (auto [variant, view] : { std::pair<const char*, const MazeCamera*>{ "fit", &camera }, { "zoom", &zoomed } })
+		{
+			int level = 0;
+			BenchResult r = { "view", variant, size, kScalingWallPercent };
+			r.workers = jobs.GetWorkerCount();
+			RunTimed(config, r, [&]() { level = BuildVisibleVertices(jobs, *view, pyramid, vertices); });
+			size_t quads = vertices.size() / kTileVertexCount;
+			r.items = static_cast<long long>(quads);
+			r.metric = "level";
+			r.value = level;
+			r.unit = "pyramid level";
+			std::cerr << "view " << variant << " " << size << ": " << (quads <= maxQuads ? "ok" : "TOO MANY QUADS") << ", "
+				<< quads << " quads at level " << level << " (" << view->GetPixelsPerCell() << " px per cell)";
+			if (std::string(variant) == "fit") std::cerr << ", top sample " << (isTopOk ? "ok" : "WRONG");
+			std::cerr << "\n";
+			Report(bench, r);
+		}
+	}
+	return true;
+}
+
+// Every bench family in the order they run, each returns false when one of its checks fails
+// A family with a filter only runs when --filter matches it, the grid family filters its own cases
+// 全てのベンチのファミリーを実行する順に、チェックが失敗したらfalseを返す
+// filterのあるファミリーは--filterが合う時だけ実行する、グリッドのファミリーは自分でケースを選ぶ
+typedef struct BenchFamily
+{
+	const char* filter;
+	bool (*run)(BenchContext& bench);
+};
+
+static const BenchFamily kBenchFamilies[] =
+{
+	{ nullptr, RunGridBenches },
+	{ "simulation", RunSimulationBench },
+	{ "landmarks", RunLandmarkBench },
+	{ "junction-graph", RunJunctionGraphBench },
+	{ "cooperative", RunCooperativeBench },
+	{ "external-bfs", RunExternalBfsBench },
+	{ "sharded-bfs", RunShardedBfsBench },
+	{ "path-cache", RunPathCacheBench },
+	{ "steady-state", RunSteadyStateBench },
+	{ "session", RunSessionBench },
+	{ "frame-loop", RunFrameLoopBench },
+	{ "view", RunViewBench },
+};
+
+int main(int argc, char* argv[])
+{
+	BenchContext bench;
+	if (!ParseArgs(argc, argv, bench.config)) return 1;
+
+	// FindPath is timed as a fresh search, the path-cache case turns the cache on for itself
+	// FindPathは毎回探索として計測する、path-cacheだけキャッシュを使う
+	bench.maze.GetPathCache().SetCapacity(0);
+	for (const BenchFamily& family : kBenchFamilies)
+	{
+		if (family.filter != nullptr && !IsSelected(bench, family.filter)) continue;
+		if (!family.run(bench)) return 1;
+	}
+
+	// Counters of every solver and subsystem the cases touched, on stderr so stdout stays JSON
+	// 全てのケースが使ったソルバーとサブシステムのカウンター、stdoutはJSONのままにする
+	Telemetry::GetInstance().Dump(std::cerr);
+
+	std::string json = ToJson(bench.config, bench.results);
+	if (bench.config.outFile.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(bench.config.outFile);
+		file << json;
+		std::cerr << "Wrote " << bench.results.size() << " results to " << bench.config.outFile << "\n";
+	}
+	return 0;
+}
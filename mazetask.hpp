@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
+
+/*
+	Resumable maze job (C++20 coroutine)
+	Suspends itself with co_await std::suspend_always{} every N cells, Resume() runs it to the next suspend point
+	再開できるメイズジョブ（C++20 コルーチン）
+*/
+
+class MazeTask 
+{
+public:
+	struct promise_type 
+	{
+		MazeTask get_return_object(void) 
+		{
+			return MazeTask(std::coroutine_handle<promise_type>::from_promise(*this));
+		}
+		std::suspend_always initial_suspend(void) noexcept { return {}; }
+		std::suspend_always final_suspend(void) noexcept { return {}; }
+		void return_void(void) {}
+		void unhandled_exception(void) { std::terminate(); }
+
+		// Frames are recycled per thread, so a FindPath / GenerateMaze call in steady state reuses
+		// the frame of the last call instead of allocating one
+		// フレームはスレッドごとに使い回す、定常状態のFindPath / GenerateMazeは前の呼び出しのフレームを使う
+		static void* operator new(size_t size)
+		{
+			for (FrameSlot& slot : GetFrameCache().slots)
+			{
+				if (slot.frame != nullptr && slot.size == size) return std::exchange(slot.frame, nullptr);
+			}
+			return ::operator new(size);
+		}
+
+		static void operator delete(void* frame, size_t size) noexcept
+		{
+			for (FrameSlot& slot : GetFrameCache().slots)
+			{
+				if (slot.frame != nullptr) continue;
+				slot.frame = frame;
+				slot.size = size;
+				return;
+			}
+			::operator delete(frame);
+		}
+	};
+
+	MazeTask(void) = default;
+	MazeTask(const MazeTask&) = delete;
+	MazeTask& operator=(const MazeTask&) = delete;
+
+	MazeTask(MazeTask&& other) noexcept 
+		: _handle(std::exchange(other._handle, nullptr))
+	{}
+
+	MazeTask& operator=(MazeTask&& other) noexcept 
+	{
+		if (this != &other) 
+		{
+			Destroy();
+			_handle = std::exchange(other._handle, nullptr);
+		}
+		return *this;
+	}
+
+	~MazeTask(void) 
+	{
+		Destroy();
+	}
+
+	// Runs until the next suspend point, returns false once the task has finished
+	// 次のサスペンドまで実行する、終わったらfalseを返す
+	bool Resume(void) 
+	{
+		if (IsDone()) return false;
+		_handle.resume();
+		return !_handle.done();
+	}
+
+	bool IsDone(void) const 
+	{
+		return !_handle || _handle.done();
+	}
+
+private:
+	// One slot per coroutine kind that can be alive at the same time (generate, solve, tiles, spare)
+	// 同時に生きられるコルーチンの種類ごとに１つ
+	typedef struct FrameSlot
+	{
+		void* frame = nullptr;
+		size_t size = 0;
+	};
+
+	struct FrameCache
+	{
+		FrameSlot slots[4];
+
+		~FrameCache(void)
+		{
+			for (FrameSlot& slot : slots) ::operator delete(slot.frame);
+		}
+	};
+
+	static FrameCache& GetFrameCache(void)
+	{
+		thread_local FrameCache cache;
+		return cache;
+	}
+
+	explicit MazeTask(std::coroutine_handle<promise_type> handle) 
+		: _handle(handle)
+	{}
+
+	void Destroy(void) 
+	{
+		if (_handle) 
+		{
+			_handle.destroy();
+			_handle = nullptr;
+		}
+	}
+
+	std::coroutine_handle<promise_type> _handle = nullptr;
+};
@@ -0,0 +1,382 @@
+﻿#include "mazeview.hpp"
+#include "jobsystem.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Fewer visible quads than this are built on the calling thread, waking the workers costs more
+// これより少ない四角形は呼んだスレッドで作る、ワーカーを起こす方が高い
+static constexpr size_t kParallelQuads = 4096;
+
+
+// ======= Public ==========
+CellPyramid::CellPyramid()
+{}
+
+CellPyramid::~CellPyramid()
+{}
+
+void CellPyramid::Build(JobSystem& jobs, Maze& maze)
+{
+	PROFILE_SCOPE("CellPyramid::Build");
+
+	int width = maze.GetGridWidth();
+	int height = maze.GetGridHeight();
+	if (maze.GetCellCount() == 0 || maze.GetCellCount() != width * height)
+	{
+		Clear();
+		return;
+	}
+
+	Resize(width, height);
+	FillBaseRows(jobs, maze, 0, height);
+	CellLevel& base = _levels[0];
+	for (const GridIndex& cell : *maze.GetPath())
+	{
+		base.samples[static_cast<size_t>(cell.y) * width + cell.x].path = 255;
+	}
+	for (int level = 1; level < _levelCount; level++)
+	{
+		DownsampleRows(jobs, level, 0, _levels[level].height);
+	}
+}
+
+void CellPyramid::UpdateRows(JobSystem& jobs, Maze& maze, int rowBegin, int rowEnd)
+{
+	PROFILE_SCOPE("CellPyramid::UpdateRows");
+
+	int width = maze.GetGridWidth();
+	int height = maze.GetGridHeight();
+	if (width <= 0 || height <= 0)
+	{
+		Clear();
+		return;
+	}
+
+	// A new grid size starts over from the whole grid, the rows not generated yet are floor
+	// 新しいグリッドのサイズはグリッド全体から、まだ作っていない行は床
+	if (_levelCount == 0 || _levels[0].width != width || _levels[0].height != height)
+	{
+		Resize(width, height);
+		rowBegin = 0;
+		rowEnd = height;
+	}
+	rowBegin = std::clamp(rowBegin, 0, height);
+	rowEnd = std::clamp(rowEnd, rowBegin, height);
+	if (rowBegin == rowEnd) return;
+
+	// Level n only has to redo the samples over rows [rowBegin >> n, (rowEnd - 1) >> n]
+	// レベルnは行[rowBegin >> n, (rowEnd - 1) >> n]の上のサンプルだけ作り直す
+	FillBaseRows(jobs, maze, rowBegin, rowEnd);
+	for (int level = 1; level < _levelCount; level++)
+	{
+		DownsampleRows(jobs, level, rowBegin >> level, ((rowEnd - 1) >> level) + 1);
+	}
+}
+
+void CellPyramid::Clear(void)
+{
+	for (CellLevel& level : _levels)
+	{
+		level.width = 0;
+		level.height = 0;
+		level.samples.clear();
+	}
+	_levelCount = 0;
+}
+
+void CellPyramid::Swap(CellPyramid& other)
+{
+	_levels.swap(other._levels);
+	std::swap(_levelCount, other._levelCount);
+}
+
+bool CellPyramid::IsEmpty(void) const
+{
+	return _levelCount == 0;
+}
+
+int CellPyramid::GetLevelCount(void) const
+{
+	return _levelCount;
+}
+
+const CellLevel& CellPyramid::GetLevel(int level) const
+{
+	return _levels[level];
+}
+
+int CellPyramid::GetWidth(void) const
+{
+	return (_levelCount > 0) ? _levels[0].width : 0;
+}
+
+int CellPyramid::GetHeight(void) const
+{
+	return (_levelCount > 0) ? _levels[0].height : 0;
+}
+
+MazeCamera::MazeCamera()
+{}
+
+MazeCamera::~MazeCamera()
+{}
+
+void MazeCamera::SetScreenSize(int scrnW, int scrnH)
+{
+	_scrnW = std::max(scrnW, 1);
+	_scrnH = std::max(scrnH, 1);
+}
+
+void MazeCamera::Fit(int gridW, int gridH)
+{
+	_gridW = std::max(gridW, 1);
+	_gridH = std::max(gridH, 1);
+	_pixelsPerCell = std::min(static_cast<float>(_scrnW) / _gridW, static_cast<float>(_scrnH) / _gridH);
+	_minPixelsPerCell = _pixelsPerCell / 4.0f;
+	_centerX = _gridW / 2.0f;
+	_centerY = _gridH / 2.0f;
+}
+
+void MazeCamera::Pan(float dxPixels, float dyPixels)
+{
+	_centerX += dxPixels / _pixelsPerCell;
+	_centerY += dyPixels / _pixelsPerCell;
+	ClampCenter();
+}
+
+void MazeCamera::Zoom(float factor, float anchorX, float anchorY)
+{
+	float cellX = ScreenToCellX(anchorX);
+	float cellY = ScreenToCellY(anchorY);
+	_pixelsPerCell = std::clamp(_pixelsPerCell * factor, _minPixelsPerCell, std::max(kMaxPixelsPerCell, _minPixelsPerCell));
+	_centerX = cellX - (anchorX - _scrnW * 0.5f) / _pixelsPerCell;
+	_centerY = cellY - (anchorY - _scrnH * 0.5f) / _pixelsPerCell;
+	ClampCenter();
+}
+
+MazeCamera MazeCamera::Lerp(const MazeCamera& from, const MazeCamera& to, double alpha)
+{
+	// A new grid (Fit) jumps instead of sliding over from the old one
+	// 新しいグリッド（Fit）は前のから滑らずに飛ぶ
+	MazeCamera camera = to;
+	if (from._gridW != to._gridW || from._gridH != to._gridH) return camera;
+
+	float t = static_cast<float>(std::clamp(alpha, 0.0, 1.0));
+	camera._centerX = from._centerX + (to._centerX - from._centerX) * t;
+	camera._centerY = from._centerY + (to._centerY - from._centerY) * t;
+	camera._pixelsPerCell = from._pixelsPerCell + (to._pixelsPerCell - from._pixelsPerCell) * t;
+	return camera;
+}
+
+int MazeCamera::ChooseLevel(int levelCount) const
+{
+	int level = 0;
+	float samplePixels = _pixelsPerCell;
+	while (samplePixels < kMinSamplePixels && level + 1 < levelCount)
+	{
+		samplePixels *= 2.0f;
+		level++;
+	}
+	return level;
+}
+
+float MazeCamera::CellToScreenX(float cellX) const
+{
+	return (cellX - _centerX) * _pixelsPerCell + _scrnW * 0.5f;
+}
+
+float MazeCamera::CellToScreenY(float cellY) const
+{
+	return (cellY - _centerY) * _pixelsPerCell + _scrnH * 0.5f;
+}
+
+float MazeCamera::ScreenToCellX(float screenX) const
+{
+	return (screenX - _scrnW * 0.5f) / _pixelsPerCell + _centerX;
+}
+
+float MazeCamera::ScreenToCellY(float screenY) const
+{
+	return (screenY - _scrnH * 0.5f) / _pixelsPerCell + _centerY;
+}
+
+int MazeCamera::GetScreenWidth(void) const
+{
+	return _scrnW;
+}
+
+int MazeCamera::GetScreenHeight(void) const
+{
+	return _scrnH;
+}
+
+int MazeCamera::GetGridWidth(void) const
+{
+	return _gridW;
+}
+
+int MazeCamera::GetGridHeight(void) const
+{
+	return _gridH;
+}
+
+float MazeCamera::GetCenterX(void) const
+{
+	return _centerX;
+}
+
+float MazeCamera::GetCenterY(void) const
+{
+	return _centerY;
+}
+
+float MazeCamera::GetPixelsPerCell(void) const
+{
+	return _pixelsPerCell;
+}
+
+int BuildVisibleVertices(JobSystem& jobs, const MazeCamera& camera, const CellPyramid& pyramid, std::vector<TileVertex>& vertices)
+{
+	PROFILE_SCOPE("BuildVisibleVertices");
+	if (pyramid.IsEmpty())
+	{
+		vertices.clear();
+		return 0;
+	}
+
+	int level = camera.ChooseLevel(pyramid.GetLevelCount());
+	const CellLevel& samples = pyramid.GetLevel(level);
+	int scale = 1 << level;
+	int gridW = pyramid.GetWidth();
+	int gridH = pyramid.GetHeight();
+	int scrnW = camera.GetScreenWidth();
+	int scrnH = camera.GetScreenHeight();
+
+	// Samples that touch the screen, in sample coordinates of the level
+	// 画面に触れるサンプル、そのレベルのサンプル座標で
+	int x0 = std::max(0, static_cast<int>(std::floor(camera.ScreenToCellX(0.0f) / scale)));
+	int y0 = std::max(0, static_cast<int>(std::floor(camera.ScreenToCellY(0.0f) / scale)));
+	int x1 = std::min(samples.width, static_cast<int>(std::floor(camera.ScreenToCellX(static_cast<float>(scrnW)) / scale)) + 1);
+	int y1 = std::min(samples.height, static_cast<int>(std::floor(camera.ScreenToCellY(static_cast<float>(scrnH)) / scale)) + 1);
+	if (x1 <= x0 || y1 <= y0)
+	{
+		vertices.clear();
+		return level;
+	}
+
+	int columns = x1 - x0;
+	size_t quadCount = static_cast<size_t>(columns) * (y1 - y0);
+	vertices.resize(quadCount * kTileVertexCount);
+	auto buildRows = [&](int rowBegin, int rowEnd)
+	{
+		for (int row = rowBegin; row < rowEnd; row++)
+		{
+			// The last sample of a row / column may hang over the grid's edge, cut it there
+			// 行／列の最後のサンプルはグリッドの端からはみ出すかもしれない、そこで切る
+			int y = y0 + row;
+			float top = camera.CellToScreenY(static_cast<float>(y * scale));
+			float bottom = camera.CellToScreenY(static_cast<float>(std::min((y + 1) * scale, gridH)));
+			for (int column = 0; column < columns; column++)
+			{
+				int x = x0 + column;
+				float left = camera.CellToScreenX(static_cast<float>(x * scale));
+				float right = camera.CellToScreenX(static_cast<float>(std::min((x + 1) * scale, gridW)));
+
+				// Same colours as BuildTileVertices at level 0, walls shade in by their share above it
+				// レベル0ではBuildTileVerticesと同じ色、上のレベルでは壁の割合で色を混ぜる
+				const CellSample& sample = samples.samples[static_cast<size_t>(y) * samples.width + x];
+				float r = 1.0f, g = 1.0f, b = 1.0f;
+				if (sample.path != 0)	{ r = 0.0f; g = 1.0f; b = 0.0f; }
+				else					{ g = b = 1.0f - sample.wall / 255.0f; }
+
+				BuildQuadVertices(left, top, right - left, bottom - top, scrnW, scrnH, r, g, b,
+					&vertices[(static_cast<size_t>(row) * columns + column) * kTileVertexCount]);
+			}
+		}
+	};
+	if (quadCount < kParallelQuads) buildRows(0, y1 - y0);
+	else jobs.ParallelFor(y1 - y0, 16, buildRows);
+	return level;
+}
+// =======================================
+
+
+// ====== Private ======
+void CellPyramid::Resize(int width, int height)
+{
+	// One level per halving until a single sample covers the whole grid
+	// 半分にするごとに１レベル、１つのサンプルがグリッド全体になるまで
+	int levelCount = 1;
+	for (int w = width, h = height; w > 1 || h > 1; w = (w + 1) / 2, h = (h + 1) / 2) levelCount++;
+	if (static_cast<int>(_levels.size()) < levelCount) _levels.resize(levelCount);
+	_levelCount = levelCount;
+
+	for (int level = 0; level < levelCount; level++)
+	{
+		CellLevel& cellLevel = _levels[level];
+		cellLevel.width = (level == 0) ? width : (_levels[level - 1].width + 1) / 2;
+		cellLevel.height = (level == 0) ? height : (_levels[level - 1].height + 1) / 2;
+		cellLevel.samples.resize(static_cast<size_t>(cellLevel.width) * cellLevel.height);
+	}
+}
+
+void CellPyramid::FillBaseRows(JobSystem& jobs, Maze& maze, int rowBegin, int rowEnd)
+{
+	// Cells past the maze's cell count are not generated yet
+	// メイズのセル数より後のセルはまだ作られていない
+	CellLevel& base = _levels[0];
+	int width = base.width;
+	int cellCount = maze.GetCellCount();
+	jobs.ParallelFor(rowEnd - rowBegin, 64, [&maze, &base, width, rowBegin, cellCount](int begin, int end)
+	{
+		int cellEnd = std::min((rowBegin + end) * width, cellCount);
+		for (int i = (rowBegin + begin) * width; i < (rowBegin + end) * width; i++)
+		{
+			base.samples[i] = { static_cast<unsigned char>((i < cellEnd && maze.IsWall(i)) ? 255 : 0), 0 };
+		}
+	});
+}
+
+void CellPyramid::DownsampleRows(JobSystem& jobs, int level, int rowBegin, int rowEnd)
+{
+	// Every sample from the up to 2x2 below it (the last row / column may have only one)
+	// 下の最大2x2からサンプルを作る（最後の行／列は１つだけのこともある）
+	const CellLevel& child = _levels[level - 1];
+	CellLevel& parent = _levels[level];
+	rowEnd = std::min(rowEnd, parent.height);
+	jobs.ParallelFor(rowEnd - rowBegin, 64, [&child, &parent, rowBegin](int begin, int end)
+	{
+		for (int y = rowBegin + begin; y < rowBegin + end; y++)
+		{
+			int childY1 = std::min(y * 2 + 2, child.height);
+			for (int x = 0; x < parent.width; x++)
+			{
+				int childX1 = std::min(x * 2 + 2, child.width);
+				int wallSum = 0;
+				int count = 0;
+				unsigned char path = 0;
+				for (int cy = y * 2; cy < childY1; cy++)
+				{
+					for (int cx = x * 2; cx < childX1; cx++)
+					{
+						const CellSample& sample = child.samples[static_cast<size_t>(cy) * child.width + cx];
+						wallSum += sample.wall;
+						path = std::max(path, sample.path);
+						count++;
+					}
+				}
+				parent.samples[static_cast<size_t>(y) * parent.width + x] = { static_cast<unsigned char>((wallSum + count / 2) / count), path };
+			}
+		}
+	});
+}
+
+void MazeCamera::ClampCenter(void)
+{
+	_centerX = std::clamp(_centerX, 0.0f, static_cast<float>(_gridW));
+	_centerY = std::clamp(_centerY, 0.0f, static_cast<float>(_gridH));
+}
+// =====================
@@ -0,0 +1,133 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "telemetry.hpp"
+#include "tilegeometry.hpp"
+
+class JobSystem;
+class Maze;
+
+/*
+	What the renderer draws of a maze, no DirectX needed
+	CellPyramid is a mip pyramid over the cell states: level 0 is one sample per cell, every level above
+	covers 2x2 samples of the one below. MazeCamera pans and zooms over the grid, and BuildVisibleVertices
+	picks the finest level whose samples are still kMinSamplePixels wide on screen and emits a quad for each
+	visible sample of it. That is at most about (screen / kMinSamplePixels)² quads whatever the maze size
+	メイズの描画する部分（DirectXは要らない）
+	CellPyramidはセルの状態のミップピラミッド、レベル0はセルごと、上のレベルは下の2x2をまとめる
+	MazeCameraはグリッドをパン／ズームする、BuildVisibleVerticesは画面でkMinSamplePixels以上の一番細かいレベルで
+	見えるサンプルだけの四角形を作る、メイズの大きさに関係なく最大で約(画面 / kMinSamplePixels)²個
+*/
+
+// Share of the cells under one sample, 0-255
+// 1つのサンプルの下のセルの割合、0-255
+typedef struct CellSample
+{
+	unsigned char wall;		// Average, so a zoomed-out wall field shades from white to red
+	unsigned char path;		// Maximum, a one-cell path still shows at every level
+};
+
+// Samples of one level, row-major
+// 1つのレベルのサンプル、行優先
+typedef struct CellLevel
+{
+	int width = 0;
+	int height = 0;
+	TrackedVector<CellSample, TelemetryMemoryTile> samples;
+};
+
+class CellPyramid
+{
+public:
+	CellPyramid(void);
+	~CellPyramid(void);
+
+	// Rebuilds every level from the maze's grid and path, rows in parallel, storage is reused
+	// メイズのグリッドとパスから全てのレベルを作り直す、行ごとに並列、領域は再利用する
+	void Build(JobSystem& jobs, Maze& maze);
+	// Redoes only the grid rows [rowBegin, rowEnd) and the samples above them, for a maze that is still being
+	// generated: cells past its cell count are floor and the path is left out. A new grid size redoes everything
+	// グリッドの行[rowBegin, rowEnd)とその上のサンプルだけ作り直す、生成中のメイズ用：セル数より後は床、パスはなし
+	void UpdateRows(JobSystem& jobs, Maze& maze, int rowBegin, int rowEnd);
+	void Clear(void);
+	void Swap(CellPyramid& other);
+
+	bool IsEmpty(void) const;
+	int GetLevelCount(void) const;
+	const CellLevel& GetLevel(int level) const;
+	// The grid size, level 0
+	// グリッドのサイズ、レベル0
+	int GetWidth(void) const;
+	int GetHeight(void) const;
+
+private:
+	std::vector<CellLevel> _levels;
+	int _levelCount = 0;
+
+	// Sizes every level for a width x height grid, the samples are left as they were
+	// 全てのレベルをwidth x heightのグリッドに合わせる、サンプルはそのまま
+	void Resize(int width, int height);
+	void FillBaseRows(JobSystem& jobs, Maze& maze, int rowBegin, int rowEnd);
+	void DownsampleRows(JobSystem& jobs, int level, int rowBegin, int rowEnd);
+};
+
+class MazeCamera
+{
+public:
+	MazeCamera(void);
+	~MazeCamera(void);
+
+	void SetScreenSize(int scrnW, int scrnH);
+	// Whole grid on screen, centred
+	// グリッド全体を画面の真ん中に
+	void Fit(int gridW, int gridH);
+	// By screen pixels, the centre stays inside the grid
+	// 画面のピクセルで動かす、中心はグリッドの中に留まる
+	void Pan(float dxPixels, float dyPixels);
+	// The cell under the anchor pixel stays under it, clamped between a quarter of Fit and kMaxPixelsPerCell
+	// アンカーのピクセルの下のセルは動かない、Fitの４分の１からkMaxPixelsPerCellまで
+	void Zoom(float factor, float anchorX, float anchorY);
+
+	// Between two update states, for the frame loop's interpolation alpha
+	// ２つの更新の状態の間、フレームループの補間のalpha用
+	static MazeCamera Lerp(const MazeCamera& from, const MazeCamera& to, double alpha);
+
+	// Finest level whose samples are at least kMinSamplePixels on screen
+	// 画面でkMinSamplePixels以上になる一番細かいレベル
+	int ChooseLevel(int levelCount) const;
+
+	float CellToScreenX(float cellX) const;
+	float CellToScreenY(float cellY) const;
+	float ScreenToCellX(float screenX) const;
+	float ScreenToCellY(float screenY) const;
+
+	int GetScreenWidth(void) const;
+	int GetScreenHeight(void) const;
+	int GetGridWidth(void) const;
+	int GetGridHeight(void) const;
+	float GetCenterX(void) const;
+	float GetCenterY(void) const;
+	float GetPixelsPerCell(void) const;
+
+	static constexpr float kMinSamplePixels = 4.0f;
+	static constexpr float kMaxPixelsPerCell = 256.0f;
+
+private:
+	void ClampCenter(void);
+
+	int _scrnW = 800;
+	int _scrnH = 600;
+	int _gridW = 0;
+	int _gridH = 0;
+	float _centerX = 0.0f;		// In cells
+	float _centerY = 0.0f;
+	float _pixelsPerCell = 1.0f;
+	float _minPixelsPerCell = 1.0f;
+};
+
+// Quads of the samples the camera sees at the level it chooses, rows built in parallel (a zoomed-in view
+// with only a few thousand quads is built serially), returns the level
+// vertices keeps its capacity, so a steady view doesn't allocate
+// カメラが選んだレベルで見えるサンプルの四角形、行ごとに並列（数千個までは直列）、レベルを返す
+int BuildVisibleVertices(JobSystem& jobs, const MazeCamera& camera, const CellPyramid& pyramid, std::vector<TileVertex>& vertices);
@@ -0,0 +1,235 @@
+﻿#include "paddedgrid.hpp"
+#include "maze.hpp"
+
+#include <algorithm>
+#include <utility>
+
+// Checks one neighbour (I is the compile-time slot in the topology's offset table)
+// １つの隣を確認する（Iはトポロジーのオフセット表のコンパイル時のスロット）
+template <typename Topology, int I, typename Visit>
+static inline void VisitNeighbor(const unsigned char* costs, int currIndex, int stride, int rowParity, Visit& visit)
+{
+	int dx = Topology::kHasRowParity ? Topology::kDx[rowParity][I] : Topology::kDx[0][I];
+	int dy = Topology::kHasRowParity ? Topology::kDy[rowParity][I] : Topology::kDy[0][I];
+	int nextIndex = currIndex + dy * stride + dx;
+	if (costs[nextIndex] == kWallCost) return;
+
+	// Diagonal square moves look at the two cells they slip past
+	// 斜めの移動は横の２つのセルを見る
+	if constexpr (Topology::kCornerRule != CornerRuleNone && Topology::kDx[0][I] != 0 && Topology::kDy[0][I] != 0)
+	{
+		bool isSideOpenX = costs[currIndex + dx] != kWallCost;
+		bool isSideOpenY = costs[currIndex + dy * stride] != kWallCost;
+		if constexpr (Topology::kCornerRule == CornerRuleBothOpen)
+		{
+			if (!isSideOpenX || !isSideOpenY) return;
+		}
+		else
+		{
+			if (!isSideOpenX && !isSideOpenY) return;
+		}
+	}
+	visit(nextIndex);
+}
+
+// Unrolled over every slot of the topology, no loop and no bounds checks thanks to the border
+// トポロジーの全スロットに展開する、枠があるのでループも範囲チェックもない
+template <typename Topology, typename Visit>
+static inline void ForEachNeighbor(const unsigned char* costs, int currIndex, int stride, Visit&& visit)
+{
+	// Padded row is y + 1, so the parity of y is flipped
+	// パディング付きの行はy + 1なので、yの偶奇は逆
+	int rowParity = Topology::kHasRowParity ? ((currIndex / stride + 1) & 1) : 0;
+	[&]<int... I>(std::integer_sequence<int, I...>)
+	{
+		(VisitNeighbor<Topology, I>(costs, currIndex, stride, rowParity, visit), ...);
+	}(std::make_integer_sequence<int, Topology::kNeighborCount>{});
+}
+
+
+// ======= Public ==========
+PaddedGrid::PaddedGrid()
+{}
+
+PaddedGrid::~PaddedGrid()
+{}
+
+void PaddedGrid::Build(const Maze& maze)
+{
+	_width = maze.GetGridWidth();
+	_height = maze.GetGridHeight();
+	_stride = _width + 2;
+	_costs.assign(static_cast<size_t>(_stride) * (_height + 2), kWallCost);
+
+	for (int y = 0; y < _height; y++)
+	{
+		for (int x = 0; x < _width; x++)
+		{
+			_costs[static_cast<size_t>(y + 1) * _stride + x + 1] = maze.GetCost(y * _width + x);
+		}
+	}
+}
+
+template <typename Topology>
+bool PaddedGrid::SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverPaddedBFS, workspace, path);
+	int cellCount = _width * _height;
+	path.clear();
+	workspace.Prepare(GetPaddedCellCount());
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+
+	int paddedStart = ToPadded(startIndex);
+	int paddedEnd = ToPadded(endIndex);
+	if (_costs[paddedEnd] == kWallCost) return false;
+
+	const unsigned char* costs = _costs.data();
+	SearchVector<int>& queue = workspace.queue;
+	queue.push_back(paddedStart);
+	workspace.Visit(paddedStart, -1, 0);
+	size_t peakQueue = 0;
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int currIndex = queue[head];
+		workspace.expandedNodes++;
+		peakQueue = std::max(peakQueue, queue.size() - head);
+
+		if (currIndex == paddedEnd)
+		{
+			workspace.enqueuedNodes = static_cast<long long>(queue.size());
+			workspace.peakQueue = static_cast<long long>(peakQueue);
+			ExtractPath(paddedEnd, workspace, path);
+			return true;
+		}
+
+		int nextDist = workspace.GetDist(currIndex) + 1;
+		ForEachNeighbor<Topology>(costs, currIndex, _stride, [&](int nextIndex)
+		{
+			if (workspace.IsVisited(nextIndex)) return;
+			workspace.Visit(nextIndex, currIndex, nextDist);
+			queue.push_back(nextIndex);
+		});
+	}
+
+	workspace.enqueuedNodes = static_cast<long long>(queue.size());
+	workspace.peakQueue = static_cast<long long>(peakQueue);
+	return false;
+}
+
+template <typename Topology>
+bool PaddedGrid::SolveDijkstra(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	SearchTelemetryScope telemetry(TelemetrySolverPaddedDijkstra, workspace, path);
+	int cellCount = _width * _height;
+	path.clear();
+	workspace.Prepare(GetPaddedCellCount());
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < 0 || endIndex >= cellCount) return false;
+
+	int paddedStart = ToPadded(startIndex);
+	int paddedEnd = ToPadded(endIndex);
+	if (_costs[paddedEnd] == kWallCost) return false;
+
+	// Same Dial's bucket queue as Maze::SolveDijkstra
+	// Maze::SolveDijkstraと同じDialのバケットキュー
+	constexpr int kBucketCount = kMaxCellCost + 1;
+	SearchVector<SearchVector<int>>& buckets = workspace.buckets;
+	if (buckets.size() < kBucketCount) buckets.resize(kBucketCount);
+	for (auto& bucket : buckets) bucket.clear();
+
+	const unsigned char* costs = _costs.data();
+	buckets[0].push_back(paddedStart);
+	workspace.Visit(paddedStart, -1, 0);
+	int pending = 1;
+	workspace.enqueuedNodes = 1;
+	workspace.peakQueue = 1;
+
+	for (int currDist = 0; pending > 0; currDist++)
+	{
+		SearchVector<int>& bucket = buckets[currDist % kBucketCount];
+		while (!bucket.empty())
+		{
+			int currIndex = bucket.back();
+			bucket.pop_back();
+			pending--;
+
+			if (workspace.GetDist(currIndex) != currDist) continue;
+			workspace.expandedNodes++;
+
+			if (currIndex == paddedEnd)
+			{
+				ExtractPath(paddedEnd, workspace, path);
+				return true;
+			}
+
+			ForEachNeighbor<Topology>(costs, currIndex, _stride, [&](int nextIndex)
+			{
+				int nextDist = currDist + costs[nextIndex];
+				if (workspace.IsVisited(nextIndex) && workspace.GetDist(nextIndex) <= nextDist) return;
+				workspace.Visit(nextIndex, currIndex, nextDist);
+				buckets[nextDist % kBucketCount].push_back(nextIndex);
+				pending++;
+				workspace.enqueuedNodes++;
+				workspace.peakQueue = std::max(workspace.peakQueue, static_cast<long long>(pending));
+			});
+		}
+	}
+
+	return false;
+}
+
+template bool PaddedGrid::SolveBFS<Topology4>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveBFS<Topology8<false>>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveBFS<Topology8<true>>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveBFS<TopologyHex>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveDijkstra<Topology4>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveDijkstra<Topology8<false>>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveDijkstra<Topology8<true>>(int, int, SearchWorkspace&, std::vector<int>&) const;
+template bool PaddedGrid::SolveDijkstra<TopologyHex>(int, int, SearchWorkspace&, std::vector<int>&) const;
+
+bool PaddedGrid::SolveBFS(MazeTopology topology, int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	switch (topology)
+	{
+	case MazeTopology4:				return SolveBFS<Topology4>(startIndex, endIndex, workspace, path);
+	case MazeTopology8:				return SolveBFS<Topology8<false>>(startIndex, endIndex, workspace, path);
+	case MazeTopology8CornerCut:	return SolveBFS<Topology8<true>>(startIndex, endIndex, workspace, path);
+	case MazeTopologyHex:			return SolveBFS<TopologyHex>(startIndex, endIndex, workspace, path);
+	}
+	return false;
+}
+
+bool PaddedGrid::SolveDijkstra(MazeTopology topology, int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	switch (topology)
+	{
+	case MazeTopology4:				return SolveDijkstra<Topology4>(startIndex, endIndex, workspace, path);
+	case MazeTopology8:				return SolveDijkstra<Topology8<false>>(startIndex, endIndex, workspace, path);
+	case MazeTopology8CornerCut:	return SolveDijkstra<Topology8<true>>(startIndex, endIndex, workspace, path);
+	case MazeTopologyHex:			return SolveDijkstra<TopologyHex>(startIndex, endIndex, workspace, path);
+	}
+	return false;
+}
+
+int PaddedGrid::GetWidth() const
+{
+	return _width;
+}
+
+int PaddedGrid::GetHeight() const
+{
+	return _height;
+}
+
+int PaddedGrid::GetPaddedCellCount() const
+{
+	return _stride * (_height + 2);
+}
+// =======================================
+
+// ====== Private ======
+void PaddedGrid::ExtractPath(int paddedEnd, const SearchWorkspace& workspace, std::vector<int>& path) const
+{
+	workspace.ExtractPath(paddedEnd, path);
+	for (int& index : path) index = FromPadded(index);
+}
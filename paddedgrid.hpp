@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "searchworkspace.hpp"
+#include "telemetry.hpp"
+#include "topology.hpp"
+
+class Maze;
+
+/*
+	Copy of the cell costs with a one-cell wall border, so neighbour offsets never leave the array
+	and the solvers' inner loops have no bounds checks at all
+	Indices going in and out of the solvers are plain Maze indices, only the workspace sees padded ones
+	壁の枠を１セル付けたコストのコピー、隣のオフセットが配列の外に出ないので範囲チェックが要らない
+*/
+
+class PaddedGrid 
+{
+public:
+	PaddedGrid(void);
+	~PaddedGrid(void);
+
+	// Copies the costs out of the maze, call again after the maze changes
+	// メイズからコストをコピーする、メイズが変わったらもう一度呼ぶ
+	void Build(const Maze& maze);
+
+	// One instantiation per topology, neighbour offsets are unrolled at compile time
+	// トポロジーごとにインスタンス化する、隣のオフセットはコンパイル時に展開される
+	template <typename Topology>
+	bool SolveBFS(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+	template <typename Topology>
+	bool SolveDijkstra(int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	// Runtime dispatch onto the instantiations above
+	// 上のインスタンスへの実行時の振り分け
+	bool SolveBFS(MazeTopology topology, int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+	bool SolveDijkstra(MazeTopology topology, int startIndex, int endIndex, SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int ToPadded(int index) const { return (index / _width + 1) * _stride + index % _width + 1; }
+	int FromPadded(int paddedIndex) const { return (paddedIndex / _stride - 1) * _width + paddedIndex % _stride - 1; }
+
+	int GetWidth(void) const;
+	int GetHeight(void) const;
+	int GetPaddedCellCount(void) const;
+
+private:
+	// Turns the padded parent chain into a Maze index path
+	// パディング付きの親のチェーンをMazeのインデックスのパスにする
+	void ExtractPath(int paddedEnd, const SearchWorkspace& workspace, std::vector<int>& path) const;
+
+	int _width = 0;
+	int _height = 0;
+	int _stride = 0;
+	TrackedVector<unsigned char, TelemetryMemoryStorage> _costs;
+};
@@ -0,0 +1,296 @@
+﻿#include "pagedgrid.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+
+// ======= Public ==========
+PagedGrid::PagedGrid()
+{}
+
+PagedGrid::~PagedGrid()
+{
+	Close();
+}
+
+bool PagedGrid::Create(const std::string& filename, long long width, long long height, size_t memoryCap)
+{
+	Close();
+	_file.open(filename, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!_file)
+	{
+		std::cerr << "Cannot create paged grid file: " << filename << "\n";
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+	_chunksPerRow = (width + kChunkSide - 1) >> kChunkShift;
+	_maxSlots = static_cast<int>(std::max<size_t>(1, memoryCap / kChunkBytes));
+	_bytesRead = 0;
+	_bytesWritten = 0;
+	_chunkLoads = 0;
+	_isFailed = false;
+	return true;
+}
+
+void PagedGrid::Close()
+{
+	if (!_file.is_open()) return;
+	Flush();
+	_file.close();
+	_slots.clear();
+	_slotOfChunk.clear();
+	_lruHead = -1;
+	_lruTail = -1;
+	_lastChunk = -1;
+	_lastSlot = -1;
+}
+
+std::string PagedGrid::MakeWorkFileName(const std::string& directory, const std::string& stem)
+{
+	static std::atomic<int> counter = 0;
+#ifdef _WIN32
+	long long processId = _getpid();
+#else
+	long long processId = getpid();
+#endif
+	return directory + "/" + stem + "_" + std::to_string(processId) + "_" + std::to_string(counter++) + ".bin";
+}
+
+bool PagedGrid::GenerateRandom(int wallPercent, unsigned int seed)
+{
+	// Resident chunks are about to be overwritten on disk, drop them without writing back
+	// 常駐しているチャンクはディスク上で上書きされるので、書き戻さずに捨てる
+	_slots.clear();
+	_slotOfChunk.clear();
+	_lruHead = -1;
+	_lruTail = -1;
+	_lastChunk = -1;
+	_lastSlot = -1;
+
+	ChunkBits bits(kChunkWords);
+	long long chunkRows = (_height + kChunkSide - 1) >> kChunkShift;
+	for (long long chunkY = 0; chunkY < chunkRows; chunkY++)
+	{
+		for (long long chunkX = 0; chunkX < _chunksPerRow; chunkX++)
+		{
+			std::fill(bits.begin(), bits.end(), 0);
+			for (int localY = 0; localY < kChunkSide; localY++)
+			{
+				long long y = (chunkY << kChunkShift) + localY;
+				if (y >= _height) break;
+				for (int localX = 0; localX < kChunkSide; localX++)
+				{
+					long long x = (chunkX << kChunkShift) + localX;
+					if (x >= _width) break;
+					long long index = y * _width + x;
+
+					// SplitMix64 finalizer on (seed, index), as in Maze::GenerateMazeParallel
+					// (seed, index) の SplitMix64、Maze::GenerateMazeParallelと同じ
+					uint64_t hash = (static_cast<uint64_t>(seed) << 32) ^ static_cast<uint64_t>(index);
+					hash += 0x9E3779B97F4A7C15ull;
+					hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+					hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+					hash ^= hash >> 31;
+
+					if (index == 0 || static_cast<int>(hash % 100) >= wallPercent) continue;
+					int bit = (localY << kChunkShift) | localX;
+					bits[bit >> 6] |= 1ull << (bit & 63);
+				}
+			}
+			if (!WriteChunk(chunkY * _chunksPerRow + chunkX, bits)) return false;
+		}
+	}
+	return true;
+}
+
+bool PagedGrid::IsWall(long long index)
+{
+	int bit = 0;
+	const ChunkSlot& slot = Touch(index, bit);
+	return (slot.bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+void PagedGrid::SetWall(long long index, bool isWall)
+{
+	int bit = 0;
+	ChunkSlot& slot = Touch(index, bit);
+	if (isWall) slot.bits[bit >> 6] |= 1ull << (bit & 63);
+	else slot.bits[bit >> 6] &= ~(1ull << (bit & 63));
+	slot.isDirty = true;
+}
+
+bool PagedGrid::Flush()
+{
+	for (ChunkSlot& slot : _slots)
+	{
+		if (!slot.isDirty) continue;
+		if (!WriteChunk(slot.chunk, slot.bits)) return false;
+		slot.isDirty = false;
+	}
+	_file.flush();
+	if (!_file.good() && !_isFailed)
+	{
+		std::cerr << "PagedGrid: Flushing the grid file failed\n";
+		_isFailed = true;
+	}
+	return !_isFailed;
+}
+
+bool PagedGrid::IsGood() const
+{
+	return !_isFailed;
+}
+
+long long PagedGrid::GetWidth() const
+{
+	return _width;
+}
+
+long long PagedGrid::GetHeight() const
+{
+	return _height;
+}
+
+long long PagedGrid::GetCellCount() const
+{
+	return _width * _height;
+}
+
+size_t PagedGrid::GetResidentBytes() const
+{
+	return _slots.size() * kChunkBytes;
+}
+
+long long PagedGrid::GetBytesRead() const
+{
+	return _bytesRead;
+}
+
+long long PagedGrid::GetBytesWritten() const
+{
+	return _bytesWritten;
+}
+
+long long PagedGrid::GetChunkLoads() const
+{
+	return _chunkLoads;
+}
+// =======================================
+
+
+// ====== Private ======
+PagedGrid::ChunkSlot& PagedGrid::Touch(long long index, int& bit)
+{
+	long long y = index / _width;
+	long long x = index % _width;
+	long long chunk = (y >> kChunkShift) * _chunksPerRow + (x >> kChunkShift);
+	bit = static_cast<int>(((y & (kChunkSide - 1)) << kChunkShift) | (x & (kChunkSide - 1)));
+
+	// Neighbouring cells mostly share a chunk, so the map is only hit on a chunk change
+	// 隣のセルはだいたい同じチャンクなので、マップはチャンクが変わった時だけ
+	if (chunk != _lastChunk)
+	{
+		auto it = _slotOfChunk.find(chunk);
+		int slot = (it != _slotOfChunk.end()) ? it->second : LoadChunk(chunk);
+		if (slot != _lruHead)
+		{
+			Unlink(slot);
+			PushFront(slot);
+		}
+		_lastChunk = chunk;
+		_lastSlot = slot;
+	}
+	return _slots[_lastSlot];
+}
+
+int PagedGrid::LoadChunk(long long chunk)
+{
+	int slot = -1;
+	if (static_cast<int>(_slots.size()) < _maxSlots)
+	{
+		slot = static_cast<int>(_slots.size());
+		_slots.push_back({ -1, false, -1, -1, ChunkBits(kChunkWords) });
+	}
+	else
+	{
+		// Evict the least recently used chunk
+		// 一番長く使われていないチャンクを追い出す
+		slot = _lruTail;
+		ChunkSlot& victim = _slots[slot];
+		if (victim.isDirty) WriteChunk(victim.chunk, victim.bits);
+		_slotOfChunk.erase(victim.chunk);
+		Unlink(slot);
+	}
+
+	// Chunks past the end of the file were never written, they read as open cells
+	// ファイルの終わりより後のチャンクは書かれていない、空きセルとして読む
+	ChunkSlot& loaded = _slots[slot];
+	loaded.chunk = chunk;
+	loaded.isDirty = false;
+	_file.clear();
+	_file.seekg(chunk * static_cast<long long>(kChunkBytes));
+	_file.read(reinterpret_cast<char*>(loaded.bits.data()), kChunkBytes);
+	std::streamsize got = _file.gcount();
+	if (_file.bad() && !_isFailed)
+	{
+		std::cerr << "PagedGrid: Reading chunk " << chunk << " failed\n";
+		_isFailed = true;
+	}
+	_file.clear();
+	if (got < static_cast<std::streamsize>(kChunkBytes))
+	{
+		std::fill(reinterpret_cast<char*>(loaded.bits.data()) + got, reinterpret_cast<char*>(loaded.bits.data()) + kChunkBytes, 0);
+	}
+	_bytesRead += got;
+	_chunkLoads++;
+
+	_slotOfChunk[chunk] = slot;
+	PushFront(slot);
+	return slot;
+}
+
+bool PagedGrid::WriteChunk(long long chunk, const ChunkBits& bits)
+{
+	_file.seekp(chunk * static_cast<long long>(kChunkBytes));
+	_file.write(reinterpret_cast<const char*>(bits.data()), kChunkBytes);
+	_bytesWritten += kChunkBytes;
+
+	// The failure sticks, a lost chunk would otherwise read back later as open cells
+	// 失敗は残す、失くしたチャンクは後で空きセルとして読まれてしまう
+	if (!_file.good() && !_isFailed)
+	{
+		std::cerr << "PagedGrid: Writing chunk " << chunk << " failed\n";
+		_isFailed = true;
+	}
+	return !_isFailed;
+}
+
+void PagedGrid::Unlink(int slot)
+{
+	ChunkSlot& node = _slots[slot];
+	if (node.prev != -1) _slots[node.prev].next = node.next;
+	else if (_lruHead == slot) _lruHead = node.next;
+	if (node.next != -1) _slots[node.next].prev = node.prev;
+	else if (_lruTail == slot) _lruTail = node.prev;
+	node.prev = -1;
+	node.next = -1;
+}
+
+void PagedGrid::PushFront(int slot)
+{
+	ChunkSlot& node = _slots[slot];
+	node.prev = -1;
+	node.next = _lruHead;
+	if (_lruHead != -1) _slots[_lruHead].prev = slot;
+	_lruHead = slot;
+	if (_lruTail == -1) _lruTail = slot;
+}
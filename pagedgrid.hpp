@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "telemetry.hpp"
+
+/*
+	Out-of-core wall bitmap for grids bigger than RAM
+	Cells are grouped in 256x256 chunks (one bit each, 8 KiB per chunk) kept in a backing file,
+	at most memoryCap bytes of chunks stay resident and the least recently used one is written back
+	(if dirty) and dropped when another has to come in
+	RAMより大きいグリッド用の壁のビットマップ、256x256のチャンクをファイルに置く
+	メモリ上限までチャンクを持って、一番長く使われていないものを書き戻して捨てる
+*/
+
+class PagedGrid
+{
+public:
+	static constexpr int kChunkShift = 8;
+	static constexpr int kChunkSide = 1 << kChunkShift;
+	static constexpr int kChunkWords = kChunkSide * kChunkSide / 64;
+	static constexpr size_t kChunkBytes = kChunkWords * sizeof(uint64_t);
+
+	PagedGrid(void);
+	PagedGrid(const PagedGrid&) = delete;
+	PagedGrid& operator=(const PagedGrid&) = delete;
+	~PagedGrid(void);
+
+	// Creates (truncates) the backing file, every cell starts open
+	// Returns false if the file can't be opened
+	// 裏のファイルを作る（空にする）、全てのセルは空きから始まる
+	bool Create(const std::string& filename, long long width, long long height, size_t memoryCap);
+	void Close(void);
+
+	// directory/stem_<process id>_<counter>.bin, so runs sharing a directory don't clobber each other's files
+	// プロセスIDとカウンターを付けた名前、同じディレクトリの他の実行のファイルを上書きしない
+	static std::string MakeWorkFileName(const std::string& directory, const std::string& stem);
+
+	// Same walls as Maze::GenerateMazeParallel with the same seed (SplitMix64 per cell),
+	// written chunk by chunk straight to the file, false if a write failed
+	// 同じシードのMaze::GenerateMazeParallelと同じ壁、チャンクごとにファイルに直接書く
+	bool GenerateRandom(int wallPercent, unsigned int seed);
+
+	bool IsWall(long long index);
+	void SetWall(long long index, bool isWall);
+	bool Flush(void);
+
+	// False once a chunk write or read has failed (disk full, ...), cells read after that aren't trustworthy
+	// Only Create clears it
+	// チャンクの書き込みか読み込みが一度失敗したらfalse、その後に読んだセルは信用できない
+	bool IsGood(void) const;
+
+	long long GetWidth(void) const;
+	long long GetHeight(void) const;
+	long long GetCellCount(void) const;
+	size_t GetResidentBytes(void) const;
+	long long GetBytesRead(void) const;
+	long long GetBytesWritten(void) const;
+	long long GetChunkLoads(void) const;
+
+private:
+	// Chunk buffers (the ones being written too) are counted under TelemetryMemoryStorage
+	// チャンクのバッファはTelemetryMemoryStorageとして数える
+	using ChunkBits = TrackedVector<uint64_t, TelemetryMemoryStorage>;
+
+	// Resident chunk, linked into the LRU list (head is the most recently used)
+	// 常駐しているチャンク、LRUリストにつながっている（先頭が一番最近）
+	typedef struct ChunkSlot
+	{
+		long long chunk;
+		bool isDirty;
+		int prev;
+		int next;
+		ChunkBits bits;
+	};
+
+	// Returns the slot holding the chunk of the cell, paging it in if needed, bit is the cell in the chunk
+	// セルのチャンクを持つスロットを返す、必要ならページインする
+	ChunkSlot& Touch(long long index, int& bit);
+	int LoadChunk(long long chunk);
+	bool WriteChunk(long long chunk, const ChunkBits& bits);
+	void Unlink(int slot);
+	void PushFront(int slot);
+
+	std::fstream _file;
+	long long _width = 0;
+	long long _height = 0;
+	long long _chunksPerRow = 0;
+	int _maxSlots = 1;
+
+	std::vector<ChunkSlot> _slots;
+	std::unordered_map<long long, int> _slotOfChunk;
+	int _lruHead = -1;
+	int _lruTail = -1;
+	long long _lastChunk = -1;		// one-entry cache in front of the map
+	int _lastSlot = -1;
+
+	long long _bytesRead = 0;
+	long long _bytesWritten = 0;
+	long long _chunkLoads = 0;
+	bool _isFailed = false;
+};
@@ -0,0 +1,167 @@
+﻿#include "pathcache.hpp"
+
+#include <algorithm>
+#include <climits>
+
+
+// ======= Public ==========
+PathCache::PathCache()
+{}
+
+PathCache::~PathCache()
+{}
+
+void PathCache::SetCapacity(int capacity)
+{
+	_capacity = std::max(capacity, 0);
+	while (static_cast<int>(_slotOfKey.size()) > _capacity) Remove(_lruTail);
+}
+
+bool PathCache::Find(uint64_t version, int startIndex, int goalIndex, std::vector<int>& path)
+{
+	auto it = _slotOfKey.find({ version, startIndex, goalIndex });
+	if (it == _slotOfKey.end())
+	{
+		_misses++;
+		return false;
+	}
+
+	int slot = it->second;
+	if (slot != _lruHead)
+	{
+		Unlink(slot);
+		PushFront(slot);
+	}
+	path = _entries[slot].path;
+	_hits++;
+	return true;
+}
+
+void PathCache::Insert(uint64_t version, int startIndex, int goalIndex, const std::vector<int>& path, int gridWidth)
+{
+	if (_capacity == 0) return;
+
+	CacheKey key = { version, startIndex, goalIndex };
+	auto it = _slotOfKey.find(key);
+	if (it != _slotOfKey.end()) Remove(it->second);
+	if (static_cast<int>(_slotOfKey.size()) >= _capacity) Remove(_lruTail);
+
+	int slot = -1;
+	if (!_freeSlots.empty())
+	{
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<int>(_entries.size());
+		_entries.push_back({});
+	}
+
+	CacheEntry& entry = _entries[slot];
+	entry.key = key;
+	entry.path = path;
+	entry.minX = INT_MAX;
+	entry.minY = INT_MAX;
+	entry.maxX = INT_MIN;
+	entry.maxY = INT_MIN;
+	for (int index : path)
+	{
+		int x = index % gridWidth;
+		int y = index / gridWidth;
+		entry.minX = std::min(entry.minX, x);
+		entry.minY = std::min(entry.minY, y);
+		entry.maxX = std::max(entry.maxX, x);
+		entry.maxY = std::max(entry.maxY, y);
+	}
+	_slotOfKey[key] = slot;
+	PushFront(slot);
+}
+
+void PathCache::InvalidateCell(int index, int gridWidth)
+{
+	int x = index % gridWidth;
+	int y = index / gridWidth;
+	for (int slot = _lruHead; slot != -1;)
+	{
+		const CacheEntry& entry = _entries[slot];
+		int next = entry.next;
+
+		// The box rejects most entries without looking at their cells
+		// ボックスでほとんどのエントリはセルを見ずに外せる
+		if (x >= entry.minX && x <= entry.maxX && y >= entry.minY && y <= entry.maxY &&
+			std::find(entry.path.begin(), entry.path.end(), index) != entry.path.end())
+		{
+			Remove(slot);
+			_invalidations++;
+		}
+		slot = next;
+	}
+}
+
+void PathCache::Clear()
+{
+	_entries.clear();
+	_freeSlots.clear();
+	_slotOfKey.clear();
+	_lruHead = -1;
+	_lruTail = -1;
+}
+
+int PathCache::GetCapacity() const
+{
+	return _capacity;
+}
+
+int PathCache::GetSize() const
+{
+	return static_cast<int>(_slotOfKey.size());
+}
+
+long long PathCache::GetHits() const
+{
+	return _hits;
+}
+
+long long PathCache::GetMisses() const
+{
+	return _misses;
+}
+
+long long PathCache::GetInvalidations() const
+{
+	return _invalidations;
+}
+// =======================================
+
+
+// ====== Private ======
+void PathCache::Remove(int slot)
+{
+	CacheEntry& entry = _entries[slot];
+	_slotOfKey.erase(entry.key);
+	Unlink(slot);
+	entry.path.clear();
+	_freeSlots.push_back(slot);
+}
+
+void PathCache::Unlink(int slot)
+{
+	CacheEntry& entry = _entries[slot];
+	if (entry.prev != -1) _entries[entry.prev].next = entry.next;
+	else if (_lruHead == slot) _lruHead = entry.next;
+	if (entry.next != -1) _entries[entry.next].prev = entry.prev;
+	else if (_lruTail == slot) _lruTail = entry.prev;
+	entry.prev = -1;
+	entry.next = -1;
+}
+
+void PathCache::PushFront(int slot)
+{
+	CacheEntry& entry = _entries[slot];
+	entry.prev = -1;
+	entry.next = _lruHead;
+	if (_lruHead != -1) _entries[_lruHead].prev = slot;
+	_lruHead = slot;
+	if (_lruTail == -1) _lruTail = slot;
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*
+	Bounded LRU cache of solved paths keyed by (maze version, start cell, goal cell)
+	Maze bumps its version whenever a cell opens up (or the maze is regenerated), since that can make
+	any route shorter, so old entries simply stop matching and age out. A new wall only breaks the
+	paths that step on it, InvalidateCell drops just those (bounding box first, then the cells)
+	Unreachable results are cached as empty paths, a new wall can't make them reachable
+	解いたパスのLRUキャッシュ、キーは（メイズのバージョン、スタート、ゴール）
+	セルが開いたらバージョンが上がる、新しい壁はその上を通るパスだけを消す
+*/
+
+class PathCache
+{
+public:
+	PathCache(void);
+	~PathCache(void);
+
+	// 0 turns the cache off, shrinking drops the least recently used entries
+	// 0でキャッシュを切る
+	void SetCapacity(int capacity);
+
+	// On a hit copies the cached cell indices (start -> goal, empty if unreachable) into path
+	// ヒットしたらキャッシュしたセルのインデックスをpathにコピーする
+	bool Find(uint64_t version, int startIndex, int goalIndex, std::vector<int>& path);
+	void Insert(uint64_t version, int startIndex, int goalIndex, const std::vector<int>& path, int gridWidth);
+
+	// A wall went up on the cell, drops the entries whose path crosses it
+	// セルに壁ができた、その上を通るパスを消す
+	void InvalidateCell(int index, int gridWidth);
+	void Clear(void);
+
+	int GetCapacity(void) const;
+	int GetSize(void) const;
+	long long GetHits(void) const;
+	long long GetMisses(void) const;
+	long long GetInvalidations(void) const;
+
+private:
+	typedef struct CacheKey
+	{
+		uint64_t version;
+		int startIndex;
+		int goalIndex;
+
+		bool operator==(const CacheKey& other) const
+		{
+			return version == other.version && startIndex == other.startIndex && goalIndex == other.goalIndex;
+		}
+	};
+
+	struct CacheKeyHash
+	{
+		size_t operator()(const CacheKey& key) const
+		{
+			uint64_t hash = key.version * 0x9E3779B97F4A7C15ull;
+			hash ^= (static_cast<uint64_t>(static_cast<uint32_t>(key.startIndex)) << 32) | static_cast<uint32_t>(key.goalIndex);
+			hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+			return static_cast<size_t>(hash ^ (hash >> 31));
+		}
+	};
+
+	// Entry linked into the LRU list (head is the most recently used), the box bounds the path's cells
+	// LRUリストにつながったエントリ、ボックスはパスのセルを囲む
+	typedef struct CacheEntry
+	{
+		CacheKey key;
+		std::vector<int> path;
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		int prev;
+		int next;
+	};
+
+	void Remove(int slot);
+	void Unlink(int slot);
+	void PushFront(int slot);
+
+	int _capacity = 256;
+	std::vector<CacheEntry> _entries;
+	std::vector<int> _freeSlots;
+	std::unordered_map<CacheKey, int, CacheKeyHash> _slotOfKey;
+	int _lruHead = -1;
+	int _lruTail = -1;
+
+	long long _hits = 0;
+	long long _misses = 0;
+	long long _invalidations = 0;
+};
@@ -0,0 +1,209 @@
+﻿#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+
+// ======= Public ==========
+Profiler::~Profiler()
+{}
+
+int64_t Profiler::Now(void)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+size_t Profiler::GetPeakResidentBytes(void)
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	// Linux: VmHWM is the high-water mark of the resident set, in kB
+	// Linux：VmHWMは常駐メモリの最高水位（kB）
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+	{
+		if (line.compare(0, 6, "VmHWM:") != 0) continue;
+		std::istringstream fields(line.substr(6));
+		size_t kilobytes = 0;
+		fields >> kilobytes;
+		return kilobytes * 1024;
+	}
+	return 0;
+#endif
+}
+
+void Profiler::Record(const char* name, int64_t startNs, int64_t endNs)
+{
+	ThreadRing* ring = GetThreadRing();
+	if (ring == nullptr) return;
+
+	// Oldest events get overwritten once the ring is full
+	// The fence makes an exporter that sees any of the new fields also see writeIndex at this slot
+	// リングがいっぱいになったら古いイベントを上書きする
+	// フェンスで、新しい値を見たエクスポートはwriteIndexがこのスロットにあるのも見る
+	uint64_t index = ring->writeIndex.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	ProfileEvent& event = ring->events[index & (kRingSize - 1)];
+	std::atomic_ref<const char*>(event.name).store(name, std::memory_order_relaxed);
+	std::atomic_ref<int64_t>(event.startNs).store(startNs, std::memory_order_relaxed);
+	std::atomic_ref<int64_t>(event.endNs).store(endNs, std::memory_order_relaxed);
+	ring->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::MarkFrame(void)
+{
+	int64_t nowNs = Now();
+	if (_lastFrameNs != 0)
+	{
+		_frameTimesMs[_frameCount % kFrameWindow] = static_cast<float>(nowNs - _lastFrameNs) / 1000000.0f;
+		_frameCount++;
+	}
+	_lastFrameNs = nowNs;
+}
+
+float Profiler::GetFrameTimePercentile(float percentile) const
+{
+	int count = std::min(_frameCount, kFrameWindow);
+	if (count == 0) return 0.0f;
+
+	// Sort a copy on the stack, the window is small
+	// スタックのコピーをソートする、ウィンドウは小さい
+	std::array<float, kFrameWindow> sorted = _frameTimesMs;
+	int nth = std::clamp(static_cast<int>(percentile / 100.0f * (count - 1) + 0.5f), 0, count - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + nth, sorted.begin() + count);
+	return sorted[nth];
+}
+
+int Profiler::GetFrameCount(void) const
+{
+	return _frameCount;
+}
+
+void Profiler::NameThread(const char* name)
+{
+	if (ThreadRing* ring = GetThreadRing()) ring->threadName.store(name, std::memory_order_relaxed);
+}
+
+bool Profiler::ExportChromeTrace(const std::string& filename)
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cerr << "Profiler: Failed to open " << filename << "\n";
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(_ringsMutex);
+
+	// trace_event JSON, timestamps in microseconds
+	// trace_event JSON、タイムスタンプはマイクロ秒
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool isFirst = true;
+	int nEvents = 0;
+	std::vector<ProfileEvent> events;
+	for (const auto& ring : _rings)
+	{
+		const char* threadName = ring->threadName.load(std::memory_order_relaxed);
+		file << (isFirst ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->threadId
+			<< ",\"args\":{\"name\":\"" << (threadName ? threadName : "thread " + std::to_string(ring->threadId)) << "\"}}";
+		isFirst = false;
+
+		// Copy what the ring holds, then keep only the events its thread can't have reached since:
+		// the slot at writeIndex (which wraps onto the oldest) may be half written, so it is never taken
+		// リングの中身をコピーして、その間にスレッドが届かなかったイベントだけを残す
+		// writeIndexのスロット（一番古いのと重なる）は書きかけかもしれないので使わない
+		uint64_t end = ring->writeIndex.load(std::memory_order_acquire);
+		uint64_t begin = (end >= kRingSize) ? end - kRingSize + 1 : 0;
+		events.clear();
+		for (uint64_t i = begin; i < end; i++)
+		{
+			ProfileEvent& event = ring->events[i & (kRingSize - 1)];
+			events.push_back({ std::atomic_ref<const char*>(event.name).load(std::memory_order_relaxed),
+				std::atomic_ref<int64_t>(event.startNs).load(std::memory_order_relaxed),
+				std::atomic_ref<int64_t>(event.endNs).load(std::memory_order_relaxed) });
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t endAfter = ring->writeIndex.load(std::memory_order_relaxed);
+		uint64_t firstIntact = (endAfter >= kRingSize) ? endAfter - kRingSize + 1 : 0;
+
+		for (uint64_t i = std::max(begin, firstIntact); i < end; i++)
+		{
+			const ProfileEvent& event = events[i - begin];
+			file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"maze\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->threadId
+				<< ",\"ts\":" << (event.startNs - _epochNs) / 1000.0
+				<< ",\"dur\":" << (event.endNs - event.startNs) / 1000.0 << "}";
+			nEvents++;
+		}
+	}
+	file << "\n]}\n";
+
+	std::cout << "Profiler: Wrote " << nEvents << " events to " << filename << "\n";
+	return true;
+}
+// =======================================
+
+// ====== Private ======
+Profiler::Profiler()
+{
+	_epochNs = Now();
+	_rings.reserve(kMaxRings);
+	_freeRings.reserve(kMaxRings);
+}
+
+Profiler::ThreadRingLease::~ThreadRingLease()
+{
+	if (ring != nullptr) Profiler::GetInstance().ReleaseThreadRing(ring);
+}
+
+Profiler::ThreadRing* Profiler::GetThreadRing(void)
+{
+	// Only the first event on a thread locks, and allocates unless a ring is free
+	// スレッドの最初のイベントだけがロックする、空いたリングがなければアロケーションもする
+	thread_local ThreadRingLease lease;
+	if (lease.ring == nullptr && !lease.isOverLimit)
+	{
+		std::lock_guard<std::mutex> lock(_ringsMutex);
+		if (!_freeRings.empty())
+		{
+			lease.ring = _freeRings.back();
+			_freeRings.pop_back();
+		}
+		else if (static_cast<int>(_rings.size()) < kMaxRings)
+		{
+			_rings.push_back(std::make_unique<ThreadRing>());
+			lease.ring = _rings.back().get();
+			lease.ring->threadId = static_cast<int>(_rings.size()) - 1;
+		}
+		else
+		{
+			std::cerr << "Profiler: More than " << kMaxRings << " threads recording at once, this one records nothing\n";
+			lease.isOverLimit = true;
+		}
+	}
+	return lease.ring;
+}
+
+void Profiler::ReleaseThreadRing(ThreadRing* ring)
+{
+	// The name belonged to the old thread, its events stay until the next owner overwrites them
+	// 名前は前のスレッドのもの、イベントは次の持ち主が上書きするまで残る
+	ring->threadName.store(nullptr, std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(_ringsMutex);
+	_freeRings.push_back(ring);
+}
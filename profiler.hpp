@@ -0,0 +1,129 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+	Scoped-timer profiler
+	Every thread writes into its own fixed-size ring buffer, so recording never allocates or locks.
+	A ring goes back to a free list when its thread exits and the next new thread takes it over, so short-lived
+	threads don't pile up rings; past kMaxRings live threads the extra ones record nothing.
+	Events can be exported as Chrome trace_event JSON (chrome://tracing, Perfetto).
+	スコープタイマーのプロファイラー
+	スレッドごとのリングバッファに書くので、記録中はアロケーションもロックもない
+	スレッドが終わるとリングは空きリストに戻り、次の新しいスレッドが使う
+*/
+
+typedef struct ProfileEvent 
+{
+	const char* name;
+	int64_t startNs;
+	int64_t endNs;
+};
+
+class Profiler 
+{
+public:
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+
+	// Meyers' Singleton
+	static Profiler& GetInstance(void)
+	{
+		static Profiler instance;
+		return instance;
+	}
+	~Profiler(void);
+
+	static int64_t Now(void);
+
+	// Peak resident set of the process so far in bytes (0 where the platform can't tell)
+	// プロセスの今までの最大常駐メモリ（バイト）
+	static size_t GetPeakResidentBytes(void);
+
+	// name must be a string literal (only the pointer is stored)
+	// nameは文字列リテラルだけ（ポインタだけを保存する）
+	void Record(const char* name, int64_t startNs, int64_t endNs);
+
+	// Call once per frame, feeds the rolling frame-time window
+	// １フレームに１回呼ぶ
+	void MarkFrame(void);
+	float GetFrameTimePercentile(float percentile) const;
+	int GetFrameCount(void) const;
+
+	// Label for the calling thread in the exported trace
+	// エクスポートするトレースでのスレッド名
+	void NameThread(const char* name);
+
+	// Safe while other threads are still recording, events overwritten during the export are left out
+	// 他のスレッドが記録中でもいい、エクスポート中に上書きされたイベントは出さない
+	bool ExportChromeTrace(const std::string& filename);
+
+private:
+	Profiler(void);
+
+	static constexpr int kRingSize = 1 << 15;
+	static constexpr int kMaxRings = 64;
+	static constexpr int kFrameWindow = 240;
+
+	struct ThreadRing 
+	{
+		int threadId;
+		std::atomic<const char*> threadName = nullptr;
+		std::atomic<uint64_t> writeIndex = 0;
+		std::array<ProfileEvent, kRingSize> events;
+	};
+
+	// Held in a thread_local, hands the ring back when its thread exits
+	// thread_localで持つ、スレッドが終わるとリングを返す
+	struct ThreadRingLease 
+	{
+		ThreadRing* ring = nullptr;
+		bool isOverLimit = false;
+		~ThreadRingLease(void);
+	};
+
+	ThreadRing* GetThreadRing(void);
+	void ReleaseThreadRing(ThreadRing* ring);
+
+	// Rings are owned here so they outlive their (worker) threads, a freed ring keeps its events and tid
+	// リングはここで持つので、ワーカースレッドが終わっても残る、空いたリングはイベントとtidを残す
+	std::mutex _ringsMutex;
+	std::vector<std::unique_ptr<ThreadRing>> _rings;
+	std::vector<ThreadRing*> _freeRings;
+
+	int64_t _epochNs;
+	int64_t _lastFrameNs = 0;
+	int _frameCount = 0;
+	std::array<float, kFrameWindow> _frameTimesMs = {};
+};
+
+class ProfileScope 
+{
+public:
+	explicit ProfileScope(const char* name)
+		: _name(name), _startNs(Profiler::Now())
+	{}
+
+	~ProfileScope(void) 
+	{
+		Profiler::GetInstance().Record(_name, _startNs, Profiler::Now());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* _name;
+	int64_t _startNs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
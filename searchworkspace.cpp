@@ -0,0 +1,82 @@
+﻿#include "searchworkspace.hpp"
+
+#include <algorithm>
+
+
+// ======= Public ==========
+SearchWorkspace::SearchWorkspace()
+{}
+
+SearchWorkspace::~SearchWorkspace()
+{}
+
+void SearchWorkspace::Prepare(int cellCount)
+{
+	if (static_cast<int>(_visitStamp.size()) < cellCount)
+	{
+		_visitStamp.assign(cellCount, 0);
+		_parent.resize(cellCount);
+		_dist.resize(cellCount);
+		_targetStamp.assign(cellCount, 0);
+		_targetId.resize(cellCount);
+		_stamp = 0;
+	}
+
+	// Stamp wrapped around, old stamps could look visited again
+	// スタンプが一周した、古いスタンプをクリアする
+	if (++_stamp == 0)
+	{
+		std::fill(_visitStamp.begin(), _visitStamp.end(), 0);
+		std::fill(_targetStamp.begin(), _targetStamp.end(), 0);
+		_stamp = 1;
+	}
+
+	queue.clear();
+	expandedNodes = 0;
+	enqueuedNodes = 0;
+	peakQueue = 0;
+}
+
+void SearchWorkspace::ExtractPath(int endIndex, std::vector<int>& path) const
+{
+	path.clear();
+	if (!IsVisited(endIndex)) return;
+
+	for (int index = endIndex; index != -1; index = _parent[index])
+	{
+		path.push_back(index);
+	}
+	std::reverse(path.begin(), path.end());
+}
+
+
+FrontierWorkspace::FrontierWorkspace()
+{}
+
+FrontierWorkspace::~FrontierWorkspace()
+{}
+
+void FrontierWorkspace::Prepare(int cellCount, int chunkCount)
+{
+	if (static_cast<int>(_dist.size()) < cellCount)
+	{
+		_dist.resize(cellCount);
+		_visited.resize((static_cast<size_t>(cellCount) + 63) / 64);
+	}
+	if (static_cast<int>(nextChunks.size()) < chunkCount) nextChunks.resize(chunkCount);
+
+	frontier.clear();
+	levels = 0;
+	topDownLevels = 0;
+	bottomUpLevels = 0;
+	expandedNodes = 0;
+	enqueuedNodes = 0;
+	peakQueue = 0;
+}
+
+void FrontierWorkspace::ClearRange(int begin, int end)
+{
+	std::fill(_dist.begin() + begin, _dist.begin() + end, -1);
+	std::fill(_visited.begin() + begin / 64, _visited.begin() + (end + 63) / 64, 0);
+}
+// =======================================
@@ -0,0 +1,132 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "telemetry.hpp"
+
+/*
+	Per-query search scratch, kept outside the grid so several threads can solve on the same Maze
+	Visited flags use a stamp, so starting a new query is O(1) instead of clearing every cell
+	検索用のスクラッチ、グリッドの外にあるので複数のスレッドが同じMazeで解ける
+*/
+
+// Scratch arrays are counted under TelemetryMemorySearch
+// スクラッチのアレイはTelemetryMemorySearchとして数える
+template <typename T>
+using SearchVector = TrackedVector<T, TelemetryMemorySearch>;
+
+class SearchWorkspace 
+{
+public:
+	SearchWorkspace(void);
+	~SearchWorkspace(void);
+
+	// Grows the arrays if needed and invalidates the previous query
+	// 必要ならアレイを大きくして、前のクエリを無効にする
+	void Prepare(int cellCount);
+
+	// Hot path, kept inline
+	// ホットパスなのでインライン
+	bool IsVisited(int index) const { return _visitStamp[index] == _stamp; }
+	int GetParent(int index) const { return _parent[index]; }
+	int GetDist(int index) const { return IsVisited(index) ? _dist[index] : -1; }
+	void Visit(int index, int parentIndex, int dist) 
+	{
+		_visitStamp[index] = _stamp;
+		_parent[index] = parentIndex;
+		_dist[index] = dist;
+	}
+
+	// Per-query marks for multi-source / multi-goal searches, id is the index in the caller's list
+	// 複数ソース／複数ゴール用のクエリごとの印、idは呼び出し元のリストのインデックス
+	void MarkTarget(int index, int id) 
+	{
+		_targetStamp[index] = _stamp;
+		_targetId[index] = id;
+	}
+	int GetTarget(int index) const { return (_targetStamp[index] == _stamp) ? _targetId[index] : -1; }
+
+	// Walks the parents back from endIndex, path comes out start -> end
+	// endIndexから親をたどる、パスは初め -> 果て
+	void ExtractPath(int endIndex, std::vector<int>& path) const;
+
+	SearchVector<int> queue;
+	SearchVector<SearchVector<int>> buckets;		// SolveDijkstra
+	SearchVector<std::pair<int, int>> heap;		// SolveDijkstraHeap
+
+	// Counters of the last query, reset by Prepare and added to Telemetry when the solver returns
+	// 最後のクエリのカウンター、Prepareでリセットしてソルバーが戻る時にTelemetryに足す
+	long long expandedNodes = 0;
+	long long enqueuedNodes = 0;
+	long long peakQueue = 0;
+
+private:
+	SearchVector<unsigned int> _visitStamp;
+	SearchVector<int> _parent;
+	SearchVector<int> _dist;
+	SearchVector<unsigned int> _targetStamp;
+	SearchVector<int> _targetId;
+	unsigned int _stamp = 0;
+};
+
+
+/*
+	Scratch for the level-synchronous parallel BFS (Maze::SolveBFSParallel)
+	Visited is a bitmap set with atomic OR, distances are read/written with relaxed atomics
+	because a bottom-up level reads neighbours that other workers may be writing
+	並列BFS用のスクラッチ、訪問済みはアトミックORのビットマップ
+*/
+
+class FrontierWorkspace 
+{
+public:
+	FrontierWorkspace(void);
+	~FrontierWorkspace(void);
+
+	// Grows the arrays if needed, the solver clears them in parallel
+	// 必要ならアレイを大きくする、クリアはソルバーが並列でする
+	void Prepare(int cellCount, int chunkCount);
+
+	// Hot path, kept inline
+	// ホットパスなのでインライン
+	bool IsVisited(int index) const 
+	{
+		uint64_t word = std::atomic_ref<uint64_t>(const_cast<uint64_t&>(_visited[index >> 6])).load(std::memory_order_relaxed);
+		return (word >> (index & 63)) & 1;
+	}
+	// Returns true only for the one caller that set the bit
+	// ビットを立てた呼び出し元だけがtrue
+	bool TryVisit(int index) 
+	{
+		uint64_t bit = 1ull << (index & 63);
+		return (std::atomic_ref<uint64_t>(_visited[index >> 6]).fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+	}
+	int GetDist(int index) const 
+	{
+		return std::atomic_ref<int>(const_cast<int&>(_dist[index])).load(std::memory_order_relaxed);
+	}
+	void SetDist(int index, int dist) 
+	{
+		std::atomic_ref<int>(_dist[index]).store(dist, std::memory_order_relaxed);
+	}
+
+	// Clears [begin, end) of the cells (dist = -1, not visited), begin must be a multiple of 64
+	// [begin, end)のセルをクリアする、beginは64の倍数
+	void ClearRange(int begin, int end);
+
+	SearchVector<int> frontier;
+	SearchVector<SearchVector<int>> nextChunks;	// one per chunk, concatenated into frontier after each level
+	int levels = 0;
+	int topDownLevels = 0;
+	int bottomUpLevels = 0;
+	long long expandedNodes = 0;
+	long long enqueuedNodes = 0;
+	long long peakQueue = 0;					// largest frontier
+
+private:
+	SearchVector<uint64_t> _visited;
+	SearchVector<int> _dist;
+};
@@ -0,0 +1,238 @@
+﻿#include "sessionlog.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+
+// ======= Public ==========
+SessionLog::SessionLog()
+{}
+
+SessionLog::~SessionLog()
+{}
+
+void SessionLog::Clear(void)
+{
+	_header = {};
+	_events.clear();
+	_digest = 0;
+	_cursor = 0;
+}
+
+void SessionLog::SetHeader(const SessionHeader& header)
+{
+	_header = header;
+}
+
+const SessionHeader& SessionLog::GetHeader(void) const
+{
+	return _header;
+}
+
+void SessionLog::Append(uint32_t frame, int64_t timeMicroseconds, SessionEventType type, int32_t value)
+{
+	_events.push_back({ frame, timeMicroseconds, type, value });
+}
+
+void SessionLog::SetDigest(uint64_t digest)
+{
+	_digest = digest;
+}
+
+uint64_t SessionLog::GetDigest(void) const
+{
+	return _digest;
+}
+
+bool SessionLog::Save(const std::string& filename) const
+{
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "SessionLog: Cannot create " << filename << "\n";
+		return false;
+	}
+
+	// Fixed-size header in the machine's byte order (x86 / x64 only), then the varint events
+	// 固定サイズのヘッダー（マシンのバイト順）、そしてvarintのイベント
+	std::string out;
+	auto writeRaw = [&out](const void* data, size_t bytes) { out.append(static_cast<const char*>(data), bytes); };
+	writeRaw(&kMagic, sizeof(kMagic));
+	writeRaw(&kVersion, sizeof(kVersion));
+	writeRaw(&_header.seed, sizeof(_header.seed));
+	writeRaw(&_header.screenWidth, sizeof(_header.screenWidth));
+	writeRaw(&_header.screenHeight, sizeof(_header.screenHeight));
+	writeRaw(&_header.simulationAgents, sizeof(_header.simulationAgents));
+	writeRaw(&_header.sliceBudgetMicroseconds, sizeof(_header.sliceBudgetMicroseconds));
+	writeRaw(&_header.mazeCells, sizeof(_header.mazeCells));
+	writeRaw(&_digest, sizeof(_digest));
+	WriteVarint(out, _events.size());
+	EncodeEvents(out);
+
+	file.write(out.data(), static_cast<std::streamsize>(out.size()));
+	if (!file)
+	{
+		std::cerr << "SessionLog: Failed to write " << filename << "\n";
+		return false;
+	}
+	return true;
+}
+
+bool SessionLog::Load(const std::string& filename)
+{
+	Clear();
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "SessionLog: Cannot open " << filename << "\n";
+		return false;
+	}
+	std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	size_t offset = 0;
+	auto readRaw = [&in, &offset](void* data, size_t bytes)
+	{
+		if (offset + bytes > in.size()) return false;
+		memcpy(data, in.data() + offset, bytes);
+		offset += bytes;
+		return true;
+	};
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	if (!readRaw(&magic, sizeof(magic)) || magic != kMagic || !readRaw(&version, sizeof(version)) || version != kVersion)
+	{
+		std::cerr << "SessionLog: " << filename << " is not a version " << kVersion << " session file\n";
+		return false;
+	}
+
+	uint64_t eventCount = 0;
+	bool isValid = readRaw(&_header.seed, sizeof(_header.seed)) &&
+		readRaw(&_header.screenWidth, sizeof(_header.screenWidth)) &&
+		readRaw(&_header.screenHeight, sizeof(_header.screenHeight)) &&
+		readRaw(&_header.simulationAgents, sizeof(_header.simulationAgents)) &&
+		readRaw(&_header.sliceBudgetMicroseconds, sizeof(_header.sliceBudgetMicroseconds)) &&
+		readRaw(&_header.mazeCells, sizeof(_header.mazeCells)) &&
+		readRaw(&_digest, sizeof(_digest)) &&
+		ReadVarint(in, offset, eventCount);
+
+	// Every event record is at least 4 bytes, so a bad count can't make us reserve gigabytes
+	// イベントは最低４バイト、壊れた数で巨大な領域を確保しない
+	if (isValid && eventCount <= (in.size() - offset) / 4) _events.reserve(eventCount);
+
+	uint32_t frame = 0;
+	int64_t timeMicroseconds = 0;
+	for (uint64_t i = 0; isValid && i < eventCount; i++)
+	{
+		if (offset >= in.size() || static_cast<unsigned char>(in[offset]) >= SessionEventCount)
+		{
+			isValid = false;
+			break;
+		}
+		SessionEventType type = static_cast<SessionEventType>(in[offset++]);
+
+		uint64_t frameDelta = 0;
+		uint64_t timeDelta = 0;
+		uint64_t zigzag = 0;
+		isValid = ReadVarint(in, offset, frameDelta) && ReadVarint(in, offset, timeDelta) && ReadVarint(in, offset, zigzag);
+		frame += static_cast<uint32_t>(frameDelta);
+		timeMicroseconds += static_cast<int64_t>(timeDelta);
+		uint32_t bits = static_cast<uint32_t>(zigzag);
+		int32_t value = static_cast<int32_t>((bits >> 1) ^ (0u - (bits & 1)));
+		_events.push_back({ frame, timeMicroseconds, type, value });
+	}
+
+	if (!isValid)
+	{
+		std::cerr << "SessionLog: " << filename << " is truncated or corrupt\n";
+		Clear();
+		return false;
+	}
+	return true;
+}
+
+void SessionLog::Rewind(void)
+{
+	_cursor = 0;
+}
+
+bool SessionLog::Peek(SessionEvent& event) const
+{
+	if (_cursor >= _events.size()) return false;
+	event = _events[_cursor];
+	return true;
+}
+
+bool SessionLog::Next(uint32_t frame, SessionEvent& event)
+{
+	if (_cursor >= _events.size() || _events[_cursor].frame != frame) return false;
+	event = _events[_cursor++];
+	return true;
+}
+
+bool SessionLog::IsFinished(void) const
+{
+	return _cursor >= _events.size();
+}
+
+const std::vector<SessionEvent>& SessionLog::GetEvents(void) const
+{
+	return _events;
+}
+
+size_t SessionLog::GetEncodedBytes(void) const
+{
+	std::string out;
+	EncodeEvents(out);
+	return out.size();
+}
+
+const char* SessionLog::GetEventName(SessionEventType type)
+{
+	static const char* const kNames[SessionEventCount] = { "frame", "key_down", "key_held", "quit", "slices", "maze_swap" };
+	return kNames[type];
+}
+// =======================================
+
+
+// ====== Private ======
+void SessionLog::WriteVarint(std::string& out, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+bool SessionLog::ReadVarint(const std::string& in, size_t& offset, uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64 && offset < in.size(); shift += 7)
+	{
+		unsigned char byte = static_cast<unsigned char>(in[offset++]);
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) return true;
+	}
+	return false;
+}
+
+void SessionLog::EncodeEvents(std::string& out) const
+{
+	// Frames and times only go forward, so both are stored as deltas to the previous event
+	// フレームと時間は増えるだけなので、前のイベントとの差を保存する
+	uint32_t frame = 0;
+	int64_t timeMicroseconds = 0;
+	for (const SessionEvent& event : _events)
+	{
+		out.push_back(static_cast<char>(event.type));
+		WriteVarint(out, event.frame - frame);
+		WriteVarint(out, static_cast<uint64_t>(event.timeMicroseconds - timeMicroseconds));
+		WriteVarint(out, (static_cast<uint32_t>(event.value) << 1) ^ static_cast<uint32_t>(event.value >> 31));
+		frame = event.frame;
+		timeMicroseconds = event.timeMicroseconds;
+	}
+}
@@ -0,0 +1,100 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+	Session record / replay log
+	The seed and config of a run plus every input it consumed, tagged with the frame number and the time
+	since the session started. Besides the keys it logs the things that depend on wall-clock time or on
+	another thread: the update delta of every frame, how many sliced-task resumes fitted into the frame
+	budget, and the frame the worker's maze set was swapped in. Replaying the events on those frames
+	gives the same maze, path and simulation, the digest written at the end checks it.
+	File: "MZSL" magic, version, header, then one record per event (type byte, varint frame and time
+	deltas, zigzag varint value), a frame with no input costs about 8 bytes
+	セッションの記録／再生ログ
+	実行のシードと設定、使った全ての入力をフレーム番号とセッション開始からの時間付きで記録する
+	キーの他に、実時間や他のスレッドに依存するもの（フレームの更新時間、フレーム予算に入ったスライス数、
+	ワーカーのメイズを交換したフレーム）も記録するので、再生すると同じメイズ、パス、シミュレーションになる
+*/
+
+typedef enum SessionEventType
+{
+	SessionEventFrame,			// value: update delta of the frame in microseconds
+	SessionEventKeyDown,		// value: SDL keycode of a key press
+	SessionEventKeyHeld,		// value: SDL scancode polled down this frame (F / G regenerate)
+	SessionEventQuit,			// window closed
+	SessionEventSlices,			// value: sliced-task resumes that fitted into the frame budget
+	SessionEventMazeSwap,		// the finished maze set was swapped in on this frame
+	SessionEventCount
+};
+
+typedef struct SessionEvent
+{
+	uint32_t frame;
+	int64_t timeMicroseconds;	// Since the session started
+	SessionEventType type;
+	int32_t value;
+};
+
+// Everything main and Canvas read before the first frame
+// 最初のフレームの前にmainとCanvasが読む全て
+typedef struct SessionHeader
+{
+	uint32_t seed = 0;
+	int32_t screenWidth = 0;
+	int32_t screenHeight = 0;
+	int32_t simulationAgents = 0;
+	int64_t sliceBudgetMicroseconds = 0;
+	int32_t mazeCells = 20;
+};
+
+class SessionLog
+{
+public:
+	SessionLog(void);
+	~SessionLog(void);
+
+	void Clear(void);
+	void SetHeader(const SessionHeader& header);
+	const SessionHeader& GetHeader(void) const;
+	void Append(uint32_t frame, int64_t timeMicroseconds, SessionEventType type, int32_t value = 0);
+
+	// Hash of the end state (maze, path, simulation) of the recorded run, 0 if none was set
+	// 記録した実行の最後の状態のハッシュ、なければ0
+	void SetDigest(uint64_t digest);
+	uint64_t GetDigest(void) const;
+
+	bool Save(const std::string& filename) const;
+	bool Load(const std::string& filename);
+
+	// Replay cursor, events come back in the order they were appended
+	// Next only hands out an event of the given frame, so a frame can't run ahead of the log
+	// 再生のカーソル、追加した順に返す。Nextは指定したフレームのイベントだけを返す
+	void Rewind(void);
+	bool Peek(SessionEvent& event) const;
+	bool Next(uint32_t frame, SessionEvent& event);
+	bool IsFinished(void) const;
+
+	const std::vector<SessionEvent>& GetEvents(void) const;
+	// Size of the event records in the file, the header and digest excluded
+	// ファイルのイベント部分のバイト数、ヘッダーとダイジェストは除く
+	size_t GetEncodedBytes(void) const;
+
+	static const char* GetEventName(SessionEventType type);
+
+private:
+	static constexpr uint32_t kMagic = 0x4C535A4D;	// "MZSL"
+	static constexpr uint32_t kVersion = 1;
+
+	static void WriteVarint(std::string& out, uint64_t value);
+	static bool ReadVarint(const std::string& in, size_t& offset, uint64_t& value);
+	void EncodeEvents(std::string& out) const;
+
+	SessionHeader _header;
+	std::vector<SessionEvent> _events;
+	uint64_t _digest = 0;
+	size_t _cursor = 0;
+};
@@ -0,0 +1,393 @@
+﻿#include "shardedsolver.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <thread>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Start of the shared mapping, written by every worker at the level barriers
+// Flags are double-buffered by level parity so nobody overwrites them while a slower worker still reads
+// 共有メモリの先頭、フラグはレベルの偶奇で２つ持つ
+struct ShardHeader
+{
+	pthread_barrier_t barrier;
+	int isActive[2][ShardedSolver::kMaxProcesses];
+	int isFound[2][ShardedSolver::kMaxProcesses];
+	long long cellsSent[ShardedSolver::kMaxProcesses];
+	long long expandedNodes[ShardedSolver::kMaxProcesses];
+	long long enqueuedNodes[ShardedSolver::kMaxProcesses];
+	long long peakFrontier[ShardedSolver::kMaxProcesses];
+	int levelCount;
+};
+
+// Single-producer / single-consumer ring of cell indices, the cells follow the struct
+// One level sends at most one cell per boundary column, so a capacity of the grid width never fills up
+// SPSCのセルのリング、１レベルで送るのは境界の列ごとに最大１セルなので、幅の容量で溢れない
+struct ShardRing
+{
+	alignas(64) std::atomic<uint32_t> head;
+	alignas(64) std::atomic<uint32_t> tail;
+};
+
+static constexpr size_t kSharedAlign = 64;
+static constexpr int kReapPollMicroseconds = 100;		// between rounds of non-blocking waits on the workers
+
+static size_t AlignUp(size_t bytes)
+{
+	return (bytes + kSharedAlign - 1) & ~(kSharedAlign - 1);
+}
+#endif
+
+
+// ======= Public ==========
+ShardedSolver::ShardedSolver()
+{}
+
+ShardedSolver::~ShardedSolver()
+{
+	Release();
+}
+
+void ShardedSolver::SetProcessCount(int processCount)
+{
+	_processCount = std::clamp(processCount, 1, kMaxProcesses);
+}
+
+#ifdef MAZE_FAULT_INJECTION
+void ShardedSolver::SetFailingWorker(int worker)
+{
+	_failingWorker = worker;
+}
+#endif
+
+bool ShardedSolver::Solve(const Maze& maze, int startIndex, int endIndex, std::vector<int>& path)
+{
+	PROFILE_SCOPE("ShardedSolver::Solve");
+	SearchTelemetryScope telemetry(TelemetrySolverSharded, _counters, path);
+	path.clear();
+	Release();
+	_counters = {};
+
+	_width = maze.GetGridWidth();
+	_height = maze.GetGridHeight();
+	int cellCount = maze.GetCellCount();
+	if (startIndex < 0 || startIndex >= cellCount || endIndex < -1 || endIndex >= cellCount) return false;
+	if (maze.IsWall(startIndex) || (endIndex != -1 && maze.IsWall(endIndex))) return false;
+
+#ifdef __linux__
+	int processCount = std::min(_processCount, _height);
+
+	// Header, distances, then two rings (up / down) per worker
+	// ヘッダー、距離、ワーカーごとにリング２つ（上／下）
+	_ringCapacity = 1;
+	while (_ringCapacity < static_cast<unsigned int>(_width)) _ringCapacity <<= 1;
+	size_t headerBytes = AlignUp(sizeof(ShardHeader));
+	size_t distBytes = AlignUp(static_cast<size_t>(cellCount) * sizeof(int));
+	size_t ringBytes = AlignUp(sizeof(ShardRing) + _ringCapacity * sizeof(uint32_t));
+	_sharedBytes = headerBytes + distBytes + ringBytes * 2 * processCount;
+
+	_shared = mmap(nullptr, _sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (_shared == MAP_FAILED)
+	{
+		std::cerr << "ShardedSolver: Failed to map " << _sharedBytes << " bytes of shared memory\n";
+		_shared = nullptr;
+		_sharedBytes = 0;
+		return false;
+	}
+	char* base = static_cast<char*>(_shared);
+	ShardHeader* header = new (base) ShardHeader();
+	_dist = reinterpret_cast<int*>(base + headerBytes);
+	for (int ring = 0; ring < 2 * processCount; ring++)
+	{
+		new (base + headerBytes + distBytes + ringBytes * ring) ShardRing();
+	}
+
+	pthread_barrierattr_t barrierAttr;
+	pthread_barrierattr_init(&barrierAttr);
+	pthread_barrierattr_setpshared(&barrierAttr, PTHREAD_PROCESS_SHARED);
+	pthread_barrier_init(&header->barrier, &barrierAttr, processCount);
+	pthread_barrierattr_destroy(&barrierAttr);
+
+	// Buffered output would be written once per process otherwise
+	// バッファの出力がプロセスごとに書かれないように
+	std::cout.flush();
+	std::cerr.flush();
+	std::fflush(nullptr);
+
+	// Workers still running may be blocked on a barrier that can never fill, kill them before reaping
+	// まだ動いているワーカーは満たされないバリアで止まっているかもしれない、殺してから回収する
+	auto killWorkers = [](std::vector<pid_t>& running)
+	{
+		for (pid_t pid : running) kill(pid, SIGKILL);
+		for (pid_t pid : running)
+		{
+			while (waitpid(pid, nullptr, 0) == -1 && errno == EINTR) {}
+		}
+		running.clear();
+	};
+
+	std::vector<pid_t> workers;
+	for (int worker = 0; worker < processCount; worker++)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			RunWorker(maze, worker, startIndex, endIndex);
+			_exit(0);
+		}
+		if (pid < 0)
+		{
+			// The barrier expects every worker, the ones already started can't finish
+			// バリアは全てのワーカーを待つので、もう始まったものは終われない
+			std::cerr << "ShardedSolver: fork failed for worker " << worker << "\n";
+			killWorkers(workers);
+			Release();
+			return false;
+		}
+		workers.push_back(pid);
+	}
+
+	// Poll every worker instead of blocking on them in fork order, so the first one to die is seen while
+	// the others wait for it at the barrier. Only the recorded pids are waited on, other children of the
+	// calling process are left to it
+	// フォークの順に待たずに全てのワーカーを見て回る、最初に死んだものを他がバリアで待っている間に見つける
+	// 待つのは記録したpidだけ、呼んだプロセスの他の子には触らない
+	bool isWorkerFailed = false;
+	while (!workers.empty() && !isWorkerFailed)
+	{
+		bool isAnyReaped = false;
+		for (size_t i = 0; i < workers.size() && !isWorkerFailed; )
+		{
+			int status = 0;
+			pid_t reaped = waitpid(workers[i], &status, WNOHANG);
+			if (reaped == 0 || (reaped == -1 && errno == EINTR))
+			{
+				i++;
+				continue;
+			}
+			pid_t pid = workers[i];
+			workers.erase(workers.begin() + i);
+			isAnyReaped = true;
+			if (reaped == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			{
+				std::cerr << "ShardedSolver: Worker process " << pid << " failed, stopping the others\n";
+				isWorkerFailed = true;
+			}
+		}
+		if (!isAnyReaped) std::this_thread::sleep_for(std::chrono::microseconds(kReapPollMicroseconds));
+	}
+	if (isWorkerFailed) killWorkers(workers);
+	// pthread_barrier_destroy waits for the killed waiters to leave, which they never do,
+	// so after a failure the barrier just goes away with the mapping
+	// 失敗の後のpthread_barrier_destroyは殺した待ち手を待ち続けるので、マッピングと一緒に捨てる
+	if (isWorkerFailed)
+	{
+		Release();
+		return false;
+	}
+	pthread_barrier_destroy(&header->barrier);
+
+	_levelCount = header->levelCount;
+	_cellsExchanged = 0;
+	for (int worker = 0; worker < processCount; worker++)
+	{
+		_cellsExchanged += header->cellsSent[worker];
+		_counters.expandedNodes += header->expandedNodes[worker];
+		_counters.enqueuedNodes += header->enqueuedNodes[worker];
+		_counters.peakQueue = std::max(_counters.peakQueue, header->peakFrontier[worker]);
+	}
+	if (endIndex == -1 || _dist[endIndex] == -1) return false;
+
+	// Coordinator: step back to any neighbour one closer to the start
+	// コーディネーター：スタートに１歩近い隣に戻っていく
+	path.resize(_dist[endIndex] + 1);
+	int cellIndex = endIndex;
+	for (int dist = _dist[endIndex]; dist > 0; dist--)
+	{
+		path[dist] = cellIndex;
+		int x = cellIndex % _width;
+		if (x > 0 && _dist[cellIndex - 1] == dist - 1) cellIndex = cellIndex - 1;
+		else if (x < _width - 1 && _dist[cellIndex + 1] == dist - 1) cellIndex = cellIndex + 1;
+		else if (cellIndex >= _width && _dist[cellIndex - _width] == dist - 1) cellIndex = cellIndex - _width;
+		else cellIndex = cellIndex + _width;
+	}
+	path[0] = cellIndex;
+	return true;
+#else
+	std::cerr << "ShardedSolver: Multi-process solving needs Linux (fork and shared memory)\n";
+	return false;
+#endif
+}
+
+int ShardedSolver::GetDist(int index) const
+{
+	return (_dist != nullptr) ? _dist[index] : -1;
+}
+
+int ShardedSolver::GetProcessCount() const
+{
+	return _processCount;
+}
+
+int ShardedSolver::GetLevelCount() const
+{
+	return _levelCount;
+}
+
+long long ShardedSolver::GetCellsExchanged() const
+{
+	return _cellsExchanged;
+}
+
+size_t ShardedSolver::GetSharedBytes() const
+{
+	return _sharedBytes;
+}
+// =======================================
+
+
+// ====== Private ======
+void ShardedSolver::RunWorker(const Maze& maze, int worker, int startIndex, int endIndex)
+{
+#ifdef __linux__
+	int processCount = std::min(_processCount, _height);
+	char* base = static_cast<char*>(_shared);
+	ShardHeader* header = reinterpret_cast<ShardHeader*>(base);
+	size_t distBytes = AlignUp(static_cast<size_t>(_width) * _height * sizeof(int));
+	size_t ringBytes = AlignUp(sizeof(ShardRing) + _ringCapacity * sizeof(uint32_t));
+	char* ringBase = base + AlignUp(sizeof(ShardHeader)) + distBytes;
+	auto getRing = [&](int ring) { return reinterpret_cast<ShardRing*>(ringBase + ringBytes * ring); };
+	auto getCells = [&](ShardRing* ring) { return reinterpret_cast<uint32_t*>(ring + 1); };
+	uint32_t ringMask = _ringCapacity - 1;
+
+	// Rings 2w (going up) and 2w + 1 (going down) belong to worker w as the producer
+	// リング2w（上へ）と2w + 1（下へ）はワーカーwが書く
+	ShardRing* sendUp = (worker > 0) ? getRing(2 * worker) : nullptr;
+	ShardRing* sendDown = (worker < processCount - 1) ? getRing(2 * worker + 1) : nullptr;
+	ShardRing* receiveFromBelow = (worker < processCount - 1) ? getRing(2 * (worker + 1)) : nullptr;
+	ShardRing* receiveFromAbove = (worker > 0) ? getRing(2 * (worker - 1) + 1) : nullptr;
+
+	int beginIndex = static_cast<int>(static_cast<long long>(_height) * worker / processCount) * _width;
+	int endCell = static_cast<int>(static_cast<long long>(_height) * (worker + 1) / processCount) * _width;
+	std::fill(_dist + beginIndex, _dist + endCell, -1);
+
+	std::vector<int> frontier;
+	std::vector<int> next;
+	if (startIndex >= beginIndex && startIndex < endCell)
+	{
+		_dist[startIndex] = 0;
+		frontier.push_back(startIndex);
+	}
+	long long expandedNodes = 0;
+	long long enqueuedNodes = static_cast<long long>(frontier.size());
+	long long peakFrontier = enqueuedNodes;
+	bool isEndOwned = (endIndex >= beginIndex && endIndex < endCell);
+	long long cellsSent = 0;
+	pthread_barrier_wait(&header->barrier);
+
+	auto send = [&](ShardRing* ring, int cellIndex)
+	{
+		uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+		getCells(ring)[tail & ringMask] = static_cast<uint32_t>(cellIndex);
+		ring->tail.store(tail + 1, std::memory_order_release);
+		cellsSent++;
+	};
+
+	for (int level = 0; ; level++)
+	{
+		int parity = level & 1;
+		int nextDist = level + 1;
+		auto visit = [&](int nextIndex)
+		{
+			if (_dist[nextIndex] != -1 || maze.IsWall(nextIndex)) return;
+			_dist[nextIndex] = nextDist;
+			next.push_back(nextIndex);
+			enqueuedNodes++;
+		};
+
+		expandedNodes += static_cast<long long>(frontier.size());
+		for (int cellIndex : frontier)
+		{
+			int x = cellIndex % _width;
+			if (x > 0) visit(cellIndex - 1);
+			if (x < _width - 1) visit(cellIndex + 1);
+
+			// Up / down may cross into the neighbouring strip, its owner checks walls and visited
+			// 上／下は隣の帯に入るかもしれない、壁と訪問済みは持ち主が確かめる
+			int up = cellIndex - _width;
+			if (up >= beginIndex) visit(up);
+			else if (sendUp != nullptr) send(sendUp, up);
+			int down = cellIndex + _width;
+			if (down < endCell) visit(down);
+			else if (sendDown != nullptr) send(sendDown, down);
+		}
+		pthread_barrier_wait(&header->barrier);
+#ifdef MAZE_FAULT_INJECTION
+		if (worker == _failingWorker) raise(SIGKILL);
+#endif
+
+		for (ShardRing* ring : { receiveFromAbove, receiveFromBelow })
+		{
+			if (ring == nullptr) continue;
+			uint32_t head = ring->head.load(std::memory_order_relaxed);
+			uint32_t tail = ring->tail.load(std::memory_order_acquire);
+			for (; head != tail; head++) visit(static_cast<int>(getCells(ring)[head & ringMask]));
+			ring->head.store(head, std::memory_order_release);
+		}
+		header->isActive[parity][worker] = !next.empty();
+		header->isFound[parity][worker] = isEndOwned && _dist[endIndex] != -1;
+		pthread_barrier_wait(&header->barrier);
+
+		// Every worker reads the same flags, so they all stop on the same level
+		// 全てのワーカーが同じフラグを読むので、同じレベルで止まる
+		bool isAnyActive = false;
+		bool isAnyFound = false;
+		for (int other = 0; other < processCount; other++)
+		{
+			isAnyActive |= header->isActive[parity][other] != 0;
+			isAnyFound |= header->isFound[parity][other] != 0;
+		}
+		if (isAnyFound || !isAnyActive)
+		{
+			if (worker == 0) header->levelCount = nextDist;
+			break;
+		}
+		frontier.swap(next);
+		next.clear();
+		peakFrontier = std::max(peakFrontier, static_cast<long long>(frontier.size()));
+	}
+	header->cellsSent[worker] = cellsSent;
+	header->expandedNodes[worker] = expandedNodes;
+	header->enqueuedNodes[worker] = enqueuedNodes;
+	header->peakFrontier[worker] = peakFrontier;
+#else
+	(void)maze;
+	(void)worker;
+	(void)startIndex;
+	(void)endIndex;
+#endif
+}
+
+void ShardedSolver::Release()
+{
+#ifdef __linux__
+	if (_shared != nullptr) munmap(_shared, _sharedBytes);
+#endif
+	_shared = nullptr;
+	_sharedBytes = 0;
+	_dist = nullptr;
+}
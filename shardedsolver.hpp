@@ -0,0 +1,81 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "telemetry.hpp"
+
+class Maze;
+
+/*
+	Sharded multi-process BFS (Linux only, one host, no network)
+	The grid is cut into horizontal strips, one forked worker process owns each strip and only ever
+	writes the distances of its own cells. The BFS runs level by level: a cell whose neighbour sits
+	in the strip above / below is pushed into a single-producer ring buffer in shared memory, and the
+	owner picks it up after the level barrier. The coordinator (the calling process) waits for the
+	workers and walks the shared distance field back from the goal to assemble the path
+	マルチプロセスBFS（Linuxだけ、１台、ネットワークなし）
+	グリッドを横の帯に切って、フォークしたワーカープロセスが１つずつ持つ
+	帯の境界を越える隣のセルは共有メモリのリングバッファで持ち主に渡す
+	呼んだプロセスがコーディネーターで、共有の距離からパスを組み立てる
+*/
+
+class ShardedSolver
+{
+public:
+	static constexpr int kMaxProcesses = 64;
+
+	ShardedSolver(void);
+	~ShardedSolver(void);
+
+	// Clamped to 1 .. kMaxProcesses and to the grid height (every strip needs a row)
+	// 1 .. kMaxProcessesとグリッドの高さに収める（帯は最低１行）
+	void SetProcessCount(int processCount);
+
+#ifdef MAZE_FAULT_INJECTION
+	// Test hook, only in builds with MAZE_FAULT_INJECTION (mazebench): that worker kills itself with
+	// SIGKILL after its first level, -1 (default) for none
+	// テスト用（MAZE_FAULT_INJECTIONのビルドだけ）：そのワーカーが最初のレベルの後にSIGKILLで死ぬ
+	void SetFailingWorker(int worker);
+#endif
+
+	// Shortest path by steps like Maze::SolveBFS, endIndex -1 fills the whole distance field
+	// Returns false if unreachable, on bad input, if the workers can't be started or if one of them dies
+	// (the others are killed then, they would wait at the level barrier forever)
+	// Maze::SolveBFSと同じ最短経路、endIndex -1は全てのセルの距離を出す
+	bool Solve(const Maze& maze, int startIndex, int endIndex, std::vector<int>& path);
+
+	// Distance of a cell from the last Solve, -1 if not reached
+	// 前回のSolveでのセルの距離、届いていなければ-1
+	int GetDist(int index) const;
+
+	int GetProcessCount(void) const;
+	int GetLevelCount(void) const;
+	long long GetCellsExchanged(void) const;
+	size_t GetSharedBytes(void) const;
+
+private:
+	// Body of a forked worker process, which exits as soon as this returns
+	// フォークしたワーカープロセスの中身、終わったらすぐプロセスを終える
+	void RunWorker(const Maze& maze, int worker, int startIndex, int endIndex);
+	void Release(void);
+
+	int _processCount = 1;
+#ifdef MAZE_FAULT_INJECTION
+	int _failingWorker = -1;
+#endif
+	int _width = 0;
+	int _height = 0;
+
+	// One anonymous shared mapping: header, distance field and the boundary rings,
+	// kept until the next Solve so GetDist can read it
+	// 匿名の共有メモリ１つ：ヘッダー、距離、境界のリング、次のSolveまで残す
+	void* _shared = nullptr;
+	size_t _sharedBytes = 0;
+	int* _dist = nullptr;
+	unsigned int _ringCapacity = 0;
+
+	int _levelCount = 0;
+	long long _cellsExchanged = 0;
+	SearchCounters _counters;		// summed over the workers, peakQueue is the largest strip frontier
+};
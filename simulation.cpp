@@ -0,0 +1,299 @@
+﻿#include "simulation.hpp"
+#include "jobsystem.hpp"
+#include "maze.hpp"
+#include "profiler.hpp"
+#include "searchworkspace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+
+// ======= Public ==========
+AgentSimulation::AgentSimulation()
+{}
+
+AgentSimulation::~AgentSimulation()
+{}
+
+void AgentSimulation::Reset(const Maze& maze, int agentCount, unsigned int seed)
+{
+	_maze = &maze;
+	_seed = seed;
+	_accumulator = 0.0;
+	_repathStart = 0;
+	_planRounds = 0;
+	_ticksToInstall = -1;
+	_tickCount = 0;
+	_agentSteps = 0;
+	_repathCount = 0;
+
+	_openCells.clear();
+	for (int i = 0; i < maze.GetCellCount(); i++)
+	{
+		if (!maze.IsWall(i)) _openCells.push_back(i);
+	}
+	if (_openCells.empty()) agentCount = 0;
+
+	_position.resize(agentCount);
+	_goal.resize(agentCount);
+	_pathCursor.assign(agentCount, 0);
+	_needsRepath.assign(agentCount, 1);
+	_paths.resize(agentCount);
+
+	// Start cells come from the same hash as the goals, with a salt no tick uses
+	// スタートもゴールと同じハッシュから、ティックが使わないソルトで
+	for (int agent = 0; agent < agentCount; agent++)
+	{
+		_position[agent] = PickCell(agent, -1);
+		_goal[agent] = PickCell(agent, _tickCount);
+		_paths[agent].clear();
+	}
+}
+
+int AgentSimulation::Advance(JobSystem& jobs, double elapsedSeconds)
+{
+	_accumulator += elapsedSeconds;
+
+	int ticks = 0;
+	while (_accumulator >= _tickSeconds && ticks < _maxTicksPerAdvance)
+	{
+		Tick(jobs);
+		_accumulator -= _tickSeconds;
+		ticks++;
+	}
+
+	// Too far behind (breakpoint, hitch), drop the backlog instead of spiralling
+	// 遅れすぎた時は溜まった時間を捨てる
+	if (ticks == _maxTicksPerAdvance) _accumulator = std::min(_accumulator, _tickSeconds);
+	return ticks;
+}
+
+void AgentSimulation::Tick(JobSystem& jobs)
+{
+	PROFILE_SCOPE("AgentSimulation::Tick");
+	if (_maze == nullptr || _position.empty()) return;
+
+	if (_isCooperative) ReplanCooperative();
+	else RepathBatch(jobs);
+	MoveAgents(jobs);
+	_tickCount++;
+}
+
+bool AgentSimulation::GetIsCooperative() const
+{
+	return _isCooperative;
+}
+
+void AgentSimulation::SetIsCooperative(bool isCooperative)
+{
+	_isCooperative = isCooperative;
+	std::fill(_needsRepath.begin(), _needsRepath.end(), 1);
+	_planRounds = 0;
+	_ticksToInstall = -1;
+}
+
+CooperativePlanner& AgentSimulation::GetPlanner(void)
+{
+	return _planner;
+}
+
+void AgentSimulation::SetGoal(int agent, int goalIndex)
+{
+	_goal[agent] = goalIndex;
+	_needsRepath[agent] = 1;
+}
+
+int AgentSimulation::GetAgentCount() const
+{
+	return static_cast<int>(_position.size());
+}
+
+int AgentSimulation::GetPosition(int agent) const
+{
+	return _position[agent];
+}
+
+int AgentSimulation::GetGoal(int agent) const
+{
+	return _goal[agent];
+}
+
+long long AgentSimulation::GetTickCount() const
+{
+	return _tickCount;
+}
+
+long long AgentSimulation::GetAgentSteps() const
+{
+	return _agentSteps;
+}
+
+long long AgentSimulation::GetRepathCount() const
+{
+	return _repathCount;
+}
+
+double AgentSimulation::GetTickSeconds() const
+{
+	return _tickSeconds;
+}
+
+void AgentSimulation::SetTickSeconds(double tickSeconds)
+{
+	_tickSeconds = std::max(tickSeconds, 1e-6);
+}
+
+int AgentSimulation::GetRepathBudget() const
+{
+	return _repathBudget;
+}
+
+void AgentSimulation::SetRepathBudget(int repathBudget)
+{
+	_repathBudget = std::max(1, repathBudget);
+}
+// =======================================
+
+// ====== Private ======
+int AgentSimulation::PickCell(int agent, long long salt) const
+{
+	// SplitMix64 on (seed, agent, salt)
+	// (seed, agent, salt) の SplitMix64
+	uint64_t hash = (static_cast<uint64_t>(_seed) << 32) ^ (static_cast<uint64_t>(agent) << 20) ^ static_cast<uint64_t>(salt + 1);
+	hash += 0x9E3779B97F4A7C15ull;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+	hash ^= hash >> 31;
+	return _openCells[hash % _openCells.size()];
+}
+
+void AgentSimulation::RepathBatch(JobSystem& jobs)
+{
+	PROFILE_SCOPE("RepathBatch");
+
+	// Round-robin scan of the flags from where the last batch stopped, so no agent starves
+	// (the scan is cheap next to the searches)
+	// 前のバッチが止まった所からフラグをスキャンする、飢えるエージェントがないように
+	int agentCount = GetAgentCount();
+	_repathBatch.clear();
+	for (int n = 0; n < agentCount && static_cast<int>(_repathBatch.size()) < _repathBudget; n++)
+	{
+		int agent = (_repathStart + n) % agentCount;
+		if (_needsRepath[agent]) _repathBatch.push_back(agent);
+	}
+	if (_repathBatch.empty()) return;
+	_repathStart = (_repathBatch.back() + 1) % agentCount;
+
+	jobs.ParallelFor(static_cast<int>(_repathBatch.size()), 16, [this](int begin, int end)
+	{
+		thread_local SearchWorkspace workspace;
+		for (int b = begin; b < end; b++)
+		{
+			int agent = _repathBatch[b];
+			_pathCursor[agent] = 0;
+			if (_maze->SolveBFS(_position[agent], _goal[agent], workspace, _paths[agent]))
+			{
+				_needsRepath[agent] = 0;
+			}
+			else
+			{
+				// Unreachable goal, try another one next tick
+				// 届かないゴール、次のティックで別のゴールを試す
+				_goal[agent] = PickCell(agent, _tickCount);
+			}
+		}
+	});
+	_repathCount += static_cast<long long>(_repathBatch.size());
+}
+
+void AgentSimulation::ReplanCooperative(void)
+{
+	PROFILE_SCOPE("ReplanCooperative");
+
+	// Paths cover the whole window, replanning halfway keeps everyone ahead of the horizon
+	// パスは窓の全体、半分で計画し直すと地平線より先にいられる
+	int interval = std::max(1, _planner.GetWindow() / 2);
+	int agentCount = GetAgentCount();
+
+	// The round planned over the last interval ticks takes over, its slices have normally finished it
+	// 前のinterval ティックで計画した回に入れ替える、普通はスライスで終わっている
+	if (_ticksToInstall == 0)
+	{
+		_planner.PlanAgents(_pendingPaths, agentCount);
+		_paths.swap(_pendingPaths);
+		std::fill(_pathCursor.begin(), _pathCursor.end(), 0);
+		std::fill(_needsRepath.begin(), _needsRepath.end(), 0);
+		_repathCount += agentCount;
+		_planRounds++;
+		_ticksToInstall = -1;
+	}
+
+	// The next round starts where everyone stands interval ticks from now: that far along the current
+	// paths, or still in place before the first round
+	// 次の回はinterval ティック後に立つ場所から：今のパスのその先、最初の回の前はその場
+	if (_ticksToInstall < 0)
+	{
+		_pendingStarts.resize(agentCount);
+		_priorityOrder.resize(agentCount);
+		for (int agent = 0; agent < agentCount; agent++)
+		{
+			const std::vector<int>& path = _paths[agent];
+			_pendingStarts[agent] = (_planRounds == 0) ? _position[agent] :
+				path[std::min(_pathCursor[agent] + interval, static_cast<int>(path.size()) - 1)];
+			_priorityOrder[agent] = static_cast<int>((agent + _planRounds) % agentCount);
+		}
+		_planner.BeginWindow(*_maze, _priorityOrder, _pendingStarts, _goal);
+		_ticksToInstall = interval;
+	}
+
+	// Priority slice: an even share of the agents left over the ticks left, the same on every run
+	// 優先順のスライス：残りのエージェントを残りのティックで均等に、毎回同じ
+	int slice = (_planner.GetRemainingAgents() + _ticksToInstall - 1) / _ticksToInstall;
+	_planner.PlanAgents(_pendingPaths, slice);
+	_ticksToInstall--;
+}
+
+void AgentSimulation::MoveAgents(JobSystem& jobs)
+{
+	PROFILE_SCOPE("MoveAgents");
+
+	// One cell per tick along the path, arriving agents pick the next goal
+	// ティックごとにパスを１セル進む、着いたエージェントは次のゴールを選ぶ
+	std::atomic<long long> steps = 0;
+	jobs.ParallelFor(GetAgentCount(), 4096, [this, &steps](int begin, int end)
+	{
+		long long chunkSteps = 0;
+		// Cooperative paths are reserved for the whole window, so everyone keeps following theirs
+		// (the next round was planned from there) even after a new goal was picked
+		// 協調パスは窓の全体で予約済み、新しいゴールを選んでも全員そのまま進む（次の回はそこから計画した）
+		bool isFollowingPlan = _isCooperative && _planRounds > 0;
+		for (int agent = begin; agent < end; agent++)
+		{
+			if (_needsRepath[agent] && !isFollowingPlan) continue;
+
+			const std::vector<int>& path = _paths[agent];
+			int cursor = _pathCursor[agent];
+			if (cursor + 1 < static_cast<int>(path.size()))
+			{
+				_pathCursor[agent] = ++cursor;
+				chunkSteps += (path[cursor] != _position[agent]);
+				_position[agent] = path[cursor];
+			}
+
+			// Cooperative paths stop at the window, not at the goal
+			// 協調パスはゴールではなく窓で終わる
+			if (_position[agent] == _goal[agent])
+			{
+				_goal[agent] = PickCell(agent, _tickCount);
+				_needsRepath[agent] = 1;
+			}
+			else if (cursor + 1 >= static_cast<int>(path.size()))
+			{
+				_needsRepath[agent] = 1;
+			}
+		}
+		steps += chunkSteps;
+	});
+	_agentSteps += steps;
+}
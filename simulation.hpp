@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "cooperativeplanner.hpp"
+
+class Maze;
+class JobSystem;
+
+/*
+	Multi-agent simulation on top of a Maze (headless, no DirectX / SDL)
+	Agents are stored as structure-of-arrays and advance one cell per fixed tick along their path.
+	Agents that reach their goal get a new one and are repathed in batches on the job system.
+	Maze上のマルチエージェントシミュレーション（ヘッドレス）
+	エージェントはSoAで、固定ティックごとにパスを１セル進む
+*/
+
+class AgentSimulation 
+{
+public:
+	AgentSimulation(void);
+	~AgentSimulation(void);
+
+	// Places agentCount agents on random open cells, every agent needs a path on the first tick
+	// The maze must outlive the simulation (or Reset again after it changes)
+	// エージェントをランダムな空きセルに置く、メイズが変わったらもう一度Resetする
+	void Reset(const Maze& maze, int agentCount, unsigned int seed);
+
+	// Runs as many fixed ticks as fit in the elapsed time (at most _maxTicksPerAdvance), returns the tick count
+	// 経過時間に入るだけの固定ティックを実行する
+	int Advance(JobSystem& jobs, double elapsedSeconds);
+	void Tick(JobSystem& jobs);
+
+	// Cooperative mode plans everyone with windowed cooperative A* every window / 2 ticks,
+	// so agents wait for each other instead of walking through one another
+	// Each round is planned in slices over the window / 2 ticks before it starts, from where
+	// every agent will stand by then, so no single tick pays for the whole round
+	// 協調モードは window / 2 ティックごとに全員を窓付き協調A*で計画する
+	// 各回はその前の window / 2 ティックに分けて、その時に立つ場所から計画する
+	bool GetIsCooperative(void) const;
+	void SetIsCooperative(bool isCooperative);
+	CooperativePlanner& GetPlanner(void);
+
+	// Sends one agent somewhere else, it gets repathed on the next tick
+	// エージェントのゴールを変える、次のティックでパスを作り直す
+	void SetGoal(int agent, int goalIndex);
+
+	int GetAgentCount(void) const;
+	int GetPosition(int agent) const;
+	int GetGoal(int agent) const;
+	long long GetTickCount(void) const;
+	long long GetAgentSteps(void) const;
+	long long GetRepathCount(void) const;
+	double GetTickSeconds(void) const;
+	void SetTickSeconds(double tickSeconds);
+	int GetRepathBudget(void) const;
+	void SetRepathBudget(int repathBudget);
+
+private:
+	// Deterministic open cell for (agent, salt), goals use the tick as the salt
+	// (agent, salt)から決まる空きセル、ゴールはティックをソルトにする
+	int PickCell(int agent, long long salt) const;
+	void RepathBatch(JobSystem& jobs);
+	void ReplanCooperative(void);
+	void MoveAgents(JobSystem& jobs);
+
+	const Maze* _maze = nullptr;
+	std::vector<int> _openCells;
+	unsigned int _seed = 1;
+
+	// ========== Agents (SoA) ==========
+	std::vector<int> _position;				// cell index
+	std::vector<int> _goal;					// cell index
+	std::vector<int> _pathCursor;			// index into _paths[agent] of the current cell
+	std::vector<char> _needsRepath;
+	std::vector<std::vector<int>> _paths;	// cell indices, start -> goal
+	// ==================================
+
+	std::vector<int> _repathBatch;
+	int _repathStart = 0;
+
+	// Priority order rotates every round, so no agent always plans last
+	// 優先順は毎回回す、いつも最後に計画されるエージェントがないように
+	bool _isCooperative = false;
+	CooperativePlanner _planner;
+	std::vector<int> _priorityOrder;
+	long long _planRounds = 0;
+	// Next round being planned, -1 when none is, installed when this reaches 0
+	// 計画中の次の回、なければ-1、0になったら入れ替える
+	std::vector<std::vector<int>> _pendingPaths;
+	std::vector<int> _pendingStarts;
+	int _ticksToInstall = -1;
+
+	// Fixed timestep, leftover time carries over to the next Advance
+	// 固定タイムステップ、余った時間は次のAdvanceに持ち越す
+	double _tickSeconds = 1.0 / 30.0;
+	double _accumulator = 0.0;
+	int _maxTicksPerAdvance = 8;
+
+	// Repaths per tick, the rest wait (standing still) for a later tick
+	// １ティックのパス作り直しの数、残りは後のティックまで待つ
+	int _repathBudget = 4096;
+
+	long long _tickCount = 0;
+	long long _agentSteps = 0;
+	long long _repathCount = 0;
+};
@@ -0,0 +1,199 @@
+#include "telemetry.hpp"
+
+#include <cstdio>
+#include <ostream>
+
+
+// ======= Public ==========
+Telemetry& Telemetry::GetInstance(void)
+{
+	static Telemetry* instance = new Telemetry();
+	return *instance;
+}
+
+void Telemetry::RecordSearch(TelemetrySolver solver, long long expandedNodes, long long enqueuedNodes, long long peakQueue, long long pathLength)
+{
+	SolverCounters& counters = _solvers[solver];
+	counters.queries.fetch_add(1, std::memory_order_relaxed);
+	if (pathLength == 0) counters.emptyPaths.fetch_add(1, std::memory_order_relaxed);
+	counters.expandedNodes.fetch_add(expandedNodes, std::memory_order_relaxed);
+	counters.enqueuedNodes.fetch_add(enqueuedNodes, std::memory_order_relaxed);
+	counters.pathCells.fetch_add(pathLength, std::memory_order_relaxed);
+	StoreMax(counters.peakQueue, peakQueue);
+	StoreMax(counters.longestPath, pathLength);
+}
+
+void Telemetry::RecordFindPath(FindPathResult result)
+{
+	_findPathResults[result].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Telemetry::RecordAllocation(TelemetryMemory subsystem, size_t bytes)
+{
+	MemoryCounters& counters = _memory[subsystem];
+	long long size = static_cast<long long>(bytes);
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	counters.bytesAllocated.fetch_add(size, std::memory_order_relaxed);
+	StoreMax(counters.peakBytes, counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size);
+}
+
+void Telemetry::RecordFree(TelemetryMemory subsystem, size_t bytes)
+{
+	_memory[subsystem].liveBytes.fetch_sub(static_cast<long long>(bytes), std::memory_order_relaxed);
+}
+
+void Telemetry::GetSearchStats(TelemetrySolver solver, SearchStats& stats) const
+{
+	const SolverCounters& counters = _solvers[solver];
+	stats.queries = counters.queries.load(std::memory_order_relaxed);
+	stats.emptyPaths = counters.emptyPaths.load(std::memory_order_relaxed);
+	stats.expandedNodes = counters.expandedNodes.load(std::memory_order_relaxed);
+	stats.enqueuedNodes = counters.enqueuedNodes.load(std::memory_order_relaxed);
+	stats.peakQueue = counters.peakQueue.load(std::memory_order_relaxed);
+	stats.pathCells = counters.pathCells.load(std::memory_order_relaxed);
+	stats.longestPath = counters.longestPath.load(std::memory_order_relaxed);
+}
+
+void Telemetry::GetMemoryStats(TelemetryMemory subsystem, MemoryStats& stats) const
+{
+	const MemoryCounters& counters = _memory[subsystem];
+	stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+	stats.bytesAllocated = counters.bytesAllocated.load(std::memory_order_relaxed);
+	stats.liveBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+}
+
+long long Telemetry::GetFindPathCount(FindPathResult result) const
+{
+	return _findPathResults[result].load(std::memory_order_relaxed);
+}
+
+const char* Telemetry::GetSolverName(TelemetrySolver solver)
+{
+	static const char* const kNames[TelemetrySolverCount] =
+	{
+		"find_path", "bfs", "multi_source_bfs", "nearest_goal", "bfs_parallel", "dijkstra", "dijkstra_heap",
+		"astar", "astar_alt", "layout_bfs", "layout_astar", "padded_bfs", "padded_dijkstra", "junction_graph",
+		"external_bfs", "sharded", "cooperative"
+	};
+	return kNames[solver];
+}
+
+const char* Telemetry::GetMemoryName(TelemetryMemory subsystem)
+{
+	static const char* const kNames[TelemetryMemoryCount] = { "maze", "tile", "search", "storage", "frame" };
+	return kNames[subsystem];
+}
+
+const char* Telemetry::GetFindPathResultName(FindPathResult result)
+{
+	static const char* const kNames[FindPathResultCount] = { "found", "cached", "out_of_bounds", "wall_goal", "unreachable" };
+	return kNames[result];
+}
+
+void Telemetry::Reset()
+{
+	for (SolverCounters& counters : _solvers)
+	{
+		counters.queries = 0;
+		counters.emptyPaths = 0;
+		counters.expandedNodes = 0;
+		counters.enqueuedNodes = 0;
+		counters.peakQueue = 0;
+		counters.pathCells = 0;
+		counters.longestPath = 0;
+	}
+	for (MemoryCounters& counters : _memory)
+	{
+		counters.peakBytes = counters.liveBytes.load(std::memory_order_relaxed);
+	}
+	for (auto& count : _findPathResults) count = 0;
+}
+
+void Telemetry::Dump(std::ostream& out) const
+{
+	char line[192];
+	out << "Telemetry: searches\n";
+	snprintf(line, sizeof(line), "  %-18s %10s %10s %14s %14s %10s %12s %10s\n",
+		"solver", "queries", "no path", "expanded", "enqueued", "peak queue", "path mean", "path max");
+	out << line;
+	for (int s = 0; s < TelemetrySolverCount; s++)
+	{
+		SearchStats stats;
+		GetSearchStats(static_cast<TelemetrySolver>(s), stats);
+		if (stats.queries == 0) continue;
+
+		long long found = stats.queries - stats.emptyPaths;
+		snprintf(line, sizeof(line), "  %-18s %10lld %10lld %14lld %14lld %10lld %12.1f %10lld\n",
+			GetSolverName(static_cast<TelemetrySolver>(s)), stats.queries, stats.emptyPaths, stats.expandedNodes, stats.enqueuedNodes,
+			stats.peakQueue, found > 0 ? static_cast<double>(stats.pathCells) / found : 0.0, stats.longestPath);
+		out << line;
+	}
+
+	out << "Telemetry: FindPath results";
+	for (int r = 0; r < FindPathResultCount; r++)
+	{
+		out << (r == 0 ? " " : ", ") << GetFindPathResultName(static_cast<FindPathResult>(r)) << " " << GetFindPathCount(static_cast<FindPathResult>(r));
+	}
+	out << "\n";
+
+	out << "Telemetry: memory\n";
+	snprintf(line, sizeof(line), "  %-18s %12s %16s %14s %14s\n", "subsystem", "allocations", "bytes allocated", "live bytes", "peak bytes");
+	out << line;
+	for (int m = 0; m < TelemetryMemoryCount; m++)
+	{
+		MemoryStats stats;
+		GetMemoryStats(static_cast<TelemetryMemory>(m), stats);
+		snprintf(line, sizeof(line), "  %-18s %12lld %16lld %14lld %14lld\n",
+			GetMemoryName(static_cast<TelemetryMemory>(m)), stats.allocations, stats.bytesAllocated, stats.liveBytes, stats.peakBytes);
+		out << line;
+	}
+}
+
+void Telemetry::WriteJson(std::ostream& out) const
+{
+	out << "{\"searches\": {";
+	bool isFirst = true;
+	for (int s = 0; s < TelemetrySolverCount; s++)
+	{
+		SearchStats stats;
+		GetSearchStats(static_cast<TelemetrySolver>(s), stats);
+		if (stats.queries == 0) continue;
+
+		out << (isFirst ? "" : ", ") << "\"" << GetSolverName(static_cast<TelemetrySolver>(s)) << "\": {\"queries\": " << stats.queries
+			<< ", \"no_path\": " << stats.emptyPaths << ", \"expanded\": " << stats.expandedNodes << ", \"enqueued\": " << stats.enqueuedNodes
+			<< ", \"peak_queue\": " << stats.peakQueue << ", \"path_cells\": " << stats.pathCells << ", \"longest_path\": " << stats.longestPath << "}";
+		isFirst = false;
+	}
+
+	out << "}, \"find_path\": {";
+	for (int r = 0; r < FindPathResultCount; r++)
+	{
+		out << (r == 0 ? "" : ", ") << "\"" << GetFindPathResultName(static_cast<FindPathResult>(r)) << "\": " << GetFindPathCount(static_cast<FindPathResult>(r));
+	}
+
+	out << "}, \"memory\": {";
+	for (int m = 0; m < TelemetryMemoryCount; m++)
+	{
+		MemoryStats stats;
+		GetMemoryStats(static_cast<TelemetryMemory>(m), stats);
+		out << (m == 0 ? "" : ", ") << "\"" << GetMemoryName(static_cast<TelemetryMemory>(m)) << "\": {\"allocations\": " << stats.allocations
+			<< ", \"bytes_allocated\": " << stats.bytesAllocated << ", \"live_bytes\": " << stats.liveBytes << ", \"peak_bytes\": " << stats.peakBytes << "}";
+	}
+	out << "}}";
+}
+// =======================================
+
+
+// ====== Private ======
+Telemetry::Telemetry()
+{}
+
+Telemetry::~Telemetry()
+{}
+
+void Telemetry::StoreMax(std::atomic<long long>& target, long long value)
+{
+	long long current = target.load(std::memory_order_relaxed);
+	while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+}
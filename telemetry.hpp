@@ -0,0 +1,224 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
+/*
+	Search and allocation telemetry
+	Every solver adds its per-query counters (expanded, enqueued, peak open list, path length) here
+	when it returns, and the containers of the grid, the tiles, the search scratch and the grid stores
+	allocate through TrackedAllocator so their bytes are attributed to a subsystem.
+	Counters are relaxed atomics, any thread can poll them while solvers run
+	検索とアロケーションのテレメトリ
+	ソルバーは戻る時にクエリのカウンターをここに足す、コンテナはTrackedAllocatorでサブシステムごとにバイトを数える
+	カウンターはrelaxedのアトミック、ソルバーの実行中にどのスレッドからでも読める
+*/
+
+typedef enum TelemetrySolver
+{
+	TelemetrySolverFindPath,			// Maze::FindPath / FindPathSliced
+	TelemetrySolverBFS,
+	TelemetrySolverMultiSourceBFS,
+	TelemetrySolverNearestGoal,
+	TelemetrySolverBFSParallel,
+	TelemetrySolverDijkstra,
+	TelemetrySolverDijkstraHeap,
+	TelemetrySolverAStar,
+	TelemetrySolverAStarALT,
+	TelemetrySolverLayoutBFS,
+	TelemetrySolverLayoutAStar,
+	TelemetrySolverPaddedBFS,
+	TelemetrySolverPaddedDijkstra,
+	TelemetrySolverJunctionGraph,
+	TelemetrySolverExternalBFS,
+	TelemetrySolverSharded,
+	TelemetrySolverCooperative,		// CooperativePlanner space-time A*, one query per agent and window
+	TelemetrySolverCount
+};
+
+typedef enum TelemetryMemory
+{
+	TelemetryMemoryMaze,		// Maze grid and path
+	TelemetryMemoryTile,		// Maze tiles
+	TelemetryMemorySearch,		// SearchWorkspace / FrontierWorkspace scratch and the FindPath query arena
+	TelemetryMemoryStorage,		// PaddedGrid, LayoutGrid and the PagedGrid chunk cache
+	TelemetryMemoryFrame,		// Canvas per-frame arena (render temporaries)
+	TelemetryMemoryCount
+};
+
+// How a FindPath call ended, the failures used to only go to the console
+// FindPathの終わり方、前は失敗がコンソールに出るだけだった
+typedef enum FindPathResult
+{
+	FindPathFound,
+	FindPathCached,				// Answered from the path cache (found or cached unreachable)
+	FindPathOutOfBounds,
+	FindPathWallGoal,
+	FindPathUnreachable,
+	FindPathResultCount
+};
+
+// One solver's totals, polled with Telemetry::GetSearchStats
+// ソルバー１つの合計
+typedef struct SearchStats
+{
+	long long queries = 0;
+	long long emptyPaths = 0;		// No path returned: bad input, unreachable, or a flood fill (endIndex -1)
+	long long expandedNodes = 0;
+	long long enqueuedNodes = 0;
+	long long peakQueue = 0;		// Largest open list / frontier seen by any single query
+	long long pathCells = 0;		// Sum of the returned path lengths
+	long long longestPath = 0;
+};
+
+// One subsystem's allocations through TrackedAllocator
+// サブシステム１つのアロケーション
+typedef struct MemoryStats
+{
+	long long allocations = 0;
+	long long bytesAllocated = 0;	// Everything ever handed out
+	long long liveBytes = 0;
+	long long peakBytes = 0;
+};
+
+// Per-query counters for solvers that don't run on a workspace (the workspaces carry the same fields)
+// ワークスペースを使わないソルバー用のクエリのカウンター
+typedef struct SearchCounters
+{
+	long long expandedNodes = 0;
+	long long enqueuedNodes = 0;
+	long long peakQueue = 0;
+};
+
+class Telemetry
+{
+public:
+	Telemetry(const Telemetry&) = delete;
+	Telemetry& operator=(const Telemetry&) = delete;
+
+	// Never destroyed: the Maze singleton and other statics still free into it after main returns
+	// 破棄しない：Mazeのシングルトンなどはmainの後でもここに解放する
+	static Telemetry& GetInstance(void);
+
+	void RecordSearch(TelemetrySolver solver, long long expandedNodes, long long enqueuedNodes, long long peakQueue, long long pathLength);
+	void RecordFindPath(FindPathResult result);
+	void RecordAllocation(TelemetryMemory subsystem, size_t bytes);
+	void RecordFree(TelemetryMemory subsystem, size_t bytes);
+
+	// Polling, a query that is still being added may show up half counted
+	// ポーリング、足している途中のクエリは半分だけ見えるかもしれない
+	void GetSearchStats(TelemetrySolver solver, SearchStats& stats) const;
+	void GetMemoryStats(TelemetryMemory subsystem, MemoryStats& stats) const;
+	long long GetFindPathCount(FindPathResult result) const;
+
+	static const char* GetSolverName(TelemetrySolver solver);
+	static const char* GetMemoryName(TelemetryMemory subsystem);
+	static const char* GetFindPathResultName(FindPathResult result);
+
+	// Zeroes the search counters and restarts the memory peaks from the live bytes
+	// 検索カウンターをゼロにして、メモリのピークを今の使用量からやり直す
+	void Reset(void);
+
+	// Table of the solvers that ran and every subsystem, for the exit dump
+	// 実行したソルバーと全てのサブシステムの表、終了時のダンプ用
+	void Dump(std::ostream& out) const;
+	// One JSON object (no trailing newline) for the batch report
+	// バッチのレポート用のJSONオブジェクト１つ
+	void WriteJson(std::ostream& out) const;
+
+private:
+	Telemetry(void);
+	~Telemetry(void);
+
+	static void StoreMax(std::atomic<long long>& target, long long value);
+
+	struct SolverCounters
+	{
+		std::atomic<long long> queries = 0;
+		std::atomic<long long> emptyPaths = 0;
+		std::atomic<long long> expandedNodes = 0;
+		std::atomic<long long> enqueuedNodes = 0;
+		std::atomic<long long> peakQueue = 0;
+		std::atomic<long long> pathCells = 0;
+		std::atomic<long long> longestPath = 0;
+	};
+
+	struct MemoryCounters
+	{
+		std::atomic<long long> allocations = 0;
+		std::atomic<long long> bytesAllocated = 0;
+		std::atomic<long long> liveBytes = 0;
+		std::atomic<long long> peakBytes = 0;
+	};
+
+	SolverCounters _solvers[TelemetrySolverCount];
+	MemoryCounters _memory[TelemetryMemoryCount];
+	std::atomic<long long> _findPathResults[FindPathResultCount] = {};
+};
+
+// Adds the counters and path length to the solver's totals when the search returns
+// Counters is a workspace or SearchCounters, read at the end so Prepare can reset them in between
+// 検索が戻る時にカウンターとパスの長さを足す、カウンターは最後に読むのでPrepareでリセットしてもいい
+template <typename Counters, typename Path>
+class SearchTelemetryScope
+{
+public:
+	SearchTelemetryScope(TelemetrySolver solver, const Counters& counters, const Path& path)
+		: _solver(solver), _counters(counters), _path(path)
+	{}
+
+	~SearchTelemetryScope(void)
+	{
+		Telemetry::GetInstance().RecordSearch(_solver, _counters.expandedNodes, _counters.enqueuedNodes,
+			_counters.peakQueue, static_cast<long long>(_path.size()));
+	}
+
+	SearchTelemetryScope(const SearchTelemetryScope&) = delete;
+	SearchTelemetryScope& operator=(const SearchTelemetryScope&) = delete;
+
+private:
+	TelemetrySolver _solver;
+	const Counters& _counters;
+	const Path& _path;
+};
+
+// std::allocator that reports every block to Telemetry under Subsystem
+// 全てのブロックをSubsystemとしてTelemetryに報告するstd::allocator
+template <typename T, TelemetryMemory Subsystem>
+class TrackedAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = TrackedAllocator<U, Subsystem>;
+	};
+
+	TrackedAllocator(void) noexcept {}
+	template <typename U>
+	TrackedAllocator(const TrackedAllocator<U, Subsystem>&) noexcept {}
+
+	T* allocate(size_t count)
+	{
+		T* block = std::allocator<T>().allocate(count);
+		Telemetry::GetInstance().RecordAllocation(Subsystem, count * sizeof(T));
+		return block;
+	}
+
+	void deallocate(T* block, size_t count) noexcept
+	{
+		Telemetry::GetInstance().RecordFree(Subsystem, count * sizeof(T));
+		std::allocator<T>().deallocate(block, count);
+	}
+
+	template <typename U>
+	bool operator==(const TrackedAllocator<U, Subsystem>&) const noexcept { return true; }
+};
+
+template <typename T, TelemetryMemory Subsystem>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Subsystem>>;
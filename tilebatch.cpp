@@ -0,0 +1,127 @@
+﻿#include "tilebatch.hpp"
+#include "canvas.hpp"
+#include "errorchecker.hpp"
+
+#include <d3dcompiler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+// ======= Public ================
+TileBatch::TileBatch()
+{}
+
+TileBatch::~TileBatch()
+{
+	_vertexBuffer.Reset();
+	_vertexLayout.Reset();
+	_vertexShader.Reset();
+	_pixelShader.Reset();
+}
+
+bool TileBatch::Initialize(Canvas* canvas)
+{
+	if (_isInit) return true;
+
+	ID3D11Device* device = canvas->GetDevice();
+	ErrorChecker errChecker = {};
+
+	ComPtr<ID3DBlob> vertexShaderBlob = nullptr;
+	ComPtr<ID3DBlob> pixelShaderBlob = nullptr;
+	if (!CompileShader(L"assets\\shaders\\tile_vs.hlsl", "vs_5_0", vertexShaderBlob)) return false;
+	if (!CompileShader(L"assets\\shaders\\tile_ps.hlsl", "ps_5_0", pixelShaderBlob)) return false;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(device->CreateVertexShader(vertexShaderBlob->GetBufferPointer(),
+		vertexShaderBlob->GetBufferSize(), nullptr, &_vertexShader), ErrorCheckShader)) return false;
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(device->CreatePixelShader(pixelShaderBlob->GetBufferPointer(),
+		pixelShaderBlob->GetBufferSize(), nullptr, &_pixelShader), ErrorCheckShader)) return false;
+
+	// Same layout as TileVertex
+	// TileVertexと同じレイアウト
+	constexpr D3D11_INPUT_ELEMENT_DESC vertexInputLayoutInfo[] =
+	{
+		{ "POSITION", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(TileVertex, pos), D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "COLOR", 0, DXGI_FORMAT::DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(TileVertex, col), D3D11_INPUT_CLASSIFICATION::D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(device->CreateInputLayout(vertexInputLayoutInfo, _countof(vertexInputLayoutInfo),
+		vertexShaderBlob->GetBufferPointer(), vertexShaderBlob->GetBufferSize(), &_vertexLayout), ErrorCheckInputLayout)) return false;
+
+	_isInit = true;
+	return true;
+}
+
+void TileBatch::Render(Canvas* canvas, const std::vector<TileVertex>& vertices)
+{
+	if (!_isInit || vertices.empty()) return;
+	if (!ReserveVertices(canvas, vertices.size())) return;
+
+	ID3D11DeviceContext* deviceContext = canvas->GetDeviceContext();
+
+	// Rewrite the whole buffer, the GPU keeps reading last frame's copy until it is done with it
+	// バッファ全体を書き直す、GPUは終わるまで前のフレームのコピーを読む
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	ErrorChecker errChecker = {};
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(deviceContext->Map(_vertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped),
+		ErrorCheckVertexBuffer)) return;
+	memcpy(mapped.pData, vertices.data(), vertices.size() * sizeof(TileVertex));
+	deviceContext->Unmap(_vertexBuffer.Get(), 0);
+
+	// Set shaders, input layout and vertex buffer
+	// シェーダー、インプットレイアウト、バーテックスバッファを設定する
+	deviceContext->VSSetShader(_vertexShader.Get(), nullptr, 0);
+	deviceContext->PSSetShader(_pixelShader.Get(), nullptr, 0);
+	deviceContext->IASetInputLayout(_vertexLayout.Get());
+	UINT stride = sizeof(TileVertex);
+	UINT offset = 0;
+	deviceContext->IASetVertexBuffers(0, 1, _vertexBuffer.GetAddressOf(), &stride, &offset);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	// Draw
+	// 描く
+	deviceContext->Draw(static_cast<UINT>(vertices.size()), 0);
+}
+// =============================================
+
+
+// ======== Private =======
+bool TileBatch::CompileShader(const std::wstring& filename, const std::string& profile, ComPtr<ID3DBlob>& shaderBlob) const
+{
+	ComPtr<ID3DBlob> errorBlob = nullptr;
+	ErrorChecker errChecker = {};
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(D3DCompileFromFile(filename.data(), nullptr, D3D_COMPILE_STANDARD_FILE_INCLUDE,
+		"main", profile.data(), D3DCOMPILE_ENABLE_STRICTNESS, 0, &shaderBlob, &errorBlob), ErrorCheckShader))
+	{
+		if (errorBlob != nullptr)
+		{
+			std::cerr << "D3D11: With message: " << static_cast<const char*>(errorBlob->GetBufferPointer()) << std::endl;
+		}
+		return false;
+	}
+	return true;
+}
+
+bool TileBatch::ReserveVertices(Canvas* canvas, size_t count)
+{
+	if (count <= _capacity) return true;
+
+	// Grow by half again so a slowly widening view doesn't recreate the buffer every frame
+	// 少しずつ広がる表示で毎フレーム作り直さないように1.5倍にする
+	size_t capacity = std::max(count, _capacity + _capacity / 2);
+	D3D11_BUFFER_DESC bufferInfo = {};
+	bufferInfo.ByteWidth = static_cast<UINT>(sizeof(TileVertex) * capacity);
+	bufferInfo.Usage = D3D11_USAGE::D3D11_USAGE_DYNAMIC;
+	bufferInfo.BindFlags = D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER;
+	bufferInfo.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	ErrorChecker errChecker = {};
+	_vertexBuffer.Reset();
+	if (!errChecker.CheckDX11HRESULTSUCCEEDED(canvas->GetDevice()->CreateBuffer(&bufferInfo, nullptr, &_vertexBuffer),
+		ErrorCheckVertexBuffer))
+	{
+		_capacity = 0;
+		return false;
+	}
+	_capacity = capacity;
+	return true;
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <d3d11.h>
+#include <dxgi1_6.h>
+#include <wrl.h>
+
+#include <string>
+#include <vector>
+
+#include "tilegeometry.hpp"
+
+// Forward declaration of other classes
+// 前のクラス表明
+class Canvas;
+
+/*
+	Every visible tile quad in one dynamic vertex buffer and one draw call, tile_vs / tile_ps shaders
+	The buffer is rewritten (map-discard) every frame and only grows, so its size follows the screen
+	見える全てのタイルを１つのダイナミック頂点バッファと１回のドローで描く、シェーダーはtile_vs / tile_ps
+*/
+
+class TileBatch
+{
+	template<typename T>
+	using ComPtr = Microsoft::WRL::ComPtr<T>;
+public:
+	TileBatch(void);
+	~TileBatch(void);
+
+	bool Initialize(Canvas* canvas);
+	void Render(Canvas* canvas, const std::vector<TileVertex>& vertices);
+
+private:
+	bool CompileShader(const std::wstring& filename, const std::string& profile, ComPtr<ID3DBlob>& shaderBlob) const;
+	bool ReserveVertices(Canvas* canvas, size_t count);
+
+	ComPtr<ID3D11Buffer> _vertexBuffer = nullptr;
+	ComPtr<ID3D11InputLayout> _vertexLayout = nullptr;
+	ComPtr<ID3D11VertexShader> _vertexShader = nullptr;
+	ComPtr<ID3D11PixelShader> _pixelShader = nullptr;
+	size_t _capacity = 0;
+
+	bool _isInit = false;
+};
@@ -0,0 +1,41 @@
+﻿#include "tilegeometry.hpp"
+
+void BuildTileVertices(int x, int y, float cellWidth, float cellHeight, int scrnW, int scrnH,
+	bool isWall, bool isPath, TileVertex* vertices)
+{
+	// Change to world coordinates
+	// ワールド座標に変更する
+	float worldX = static_cast<float>(x) * cellWidth;
+	float worldY = static_cast<float>(y) * cellHeight;
+
+	// Determine tile colour based on Maze
+	// タイルの色をメイズのデータによって定める
+	float r = 1.0f, g = 1.0f, b = 1.0f;
+	if (isWall)			{ r = 1.0f; g = 0.0f; b = 0.0f; }
+	else if (isPath)	{ r = 0.0f; g = 1.0f; b = 0.0f; }
+
+	BuildQuadVertices(worldX, worldY, cellWidth, cellHeight, scrnW, scrnH, r, g, b, vertices);
+}
+
+void BuildQuadVertices(float left, float top, float width, float height, int scrnW, int scrnH,
+	float r, float g, float b, TileVertex* vertices)
+{
+	// Change to Dx11 Normal Device Coordinates
+	// Dx11 の NDC座標に変更する
+	float normX = (left / (scrnW / 2.0f)) - 1.0f;
+	float normY = 1.0f - ((top + height) / (scrnH / 2.0f));
+	float normW = width / (scrnW / 2.0f);
+	float normH = height / (scrnH / 2.0f);
+
+	// First triangle (top-left, top-right, bottom-left)
+	// 1目様
+	vertices[0] = { { normX,		 normY,			0.0f }, { r, g, b } };
+	vertices[1] = { { normX + normW, normY,			0.0f }, { r, g, b } };
+	vertices[2] = { { normX,		 normY + normH, 0.0f }, { r, g, b } };
+
+	// Second triangle (bottom-left, top-right, bottom-right)
+	// 2目様
+	vertices[3] = { { normX,		 normY + normH, 0.0f }, { r, g, b } };
+	vertices[4] = { { normX + normW, normY,			0.0f }, { r, g, b } };
+	vertices[5] = { { normX + normW, normY + normH, 0.0f }, { r, g, b } };
+}
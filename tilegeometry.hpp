@@ -0,0 +1,25 @@
+﻿#pragma once
+
+/*
+	CPU side of the tile geometry, no DirectX needed
+	TileBatch uploads these vertices, the benchmarks build them headless
+	タイルのジオメトリ（CPU側）、DirectXは要らない
+*/
+
+typedef struct TileVertex 
+{
+	float pos[3];
+	float col[3];
+};
+
+constexpr int kTileVertexCount = 6;
+
+// Builds the 2 triangles of one cell in Dx11 Normal Device Coordinates
+// １つのセルの２つの三角形をNDC座標で作る
+void BuildTileVertices(int x, int y, float cellWidth, float cellHeight, int scrnW, int scrnH,
+	bool isWall, bool isPath, TileVertex* vertices);
+
+// Same 2 triangles for any rectangle in screen pixels (top-left origin) and colour
+// 画面のピクセル（左上が原点）の任意の四角形と色で同じ２つの三角形を作る
+void BuildQuadVertices(float left, float top, float width, float height, int scrnW, int scrnH,
+	float r, float g, float b, TileVertex* vertices);
@@ -0,0 +1,52 @@
+﻿#pragma once
+
+/*
+	Compile-time neighbour topologies for the padded-grid solvers (see paddedgrid.hpp)
+	Offsets are (dx, dy) per row parity, only the hex layout differs between even and odd rows
+	パディング付きグリッドのソルバー用、コンパイル時の隣接トポロジー
+*/
+
+typedef enum MazeTopology 
+{
+	MazeTopology4,				// Left, right, up, down
+	MazeTopology8,				// + diagonals, only when both side cells are open (no corner cutting)
+	MazeTopology8CornerCut,		// + diagonals, one open side cell is enough
+	MazeTopologyHex				// Odd rows shifted right by half a cell ("odd-r")
+};
+
+// Rule for stepping diagonally past the two side cells
+// 斜めに進む時の横のセルのルール
+typedef enum CornerRule 
+{
+	CornerRuleNone,				// Not a square diagonal move, nothing to check
+	CornerRuleBothOpen,
+	CornerRuleOneOpen
+};
+
+struct Topology4 
+{
+	static constexpr int kNeighborCount = 4;
+	static constexpr bool kHasRowParity = false;
+	static constexpr CornerRule kCornerRule = CornerRuleNone;
+	static constexpr int kDx[2][4] = { { -1, 1, 0, 0 }, { -1, 1, 0, 0 } };
+	static constexpr int kDy[2][4] = { { 0, 0, -1, 1 }, { 0, 0, -1, 1 } };
+};
+
+template <bool kAllowCornerCut>
+struct Topology8 
+{
+	static constexpr int kNeighborCount = 8;
+	static constexpr bool kHasRowParity = false;
+	static constexpr CornerRule kCornerRule = kAllowCornerCut ? CornerRuleOneOpen : CornerRuleBothOpen;
+	static constexpr int kDx[2][8] = { { -1, 1, 0, 0, -1, 1, -1, 1 }, { -1, 1, 0, 0, -1, 1, -1, 1 } };
+	static constexpr int kDy[2][8] = { { 0, 0, -1, 1, -1, -1, 1, 1 }, { 0, 0, -1, 1, -1, -1, 1, 1 } };
+};
+
+struct TopologyHex 
+{
+	static constexpr int kNeighborCount = 6;
+	static constexpr bool kHasRowParity = true;
+	static constexpr CornerRule kCornerRule = CornerRuleNone;
+	static constexpr int kDx[2][6] = { { -1, 1, -1, 0, -1, 0 }, { -1, 1, 0, 1, 0, 1 } };
+	static constexpr int kDy[2][6] = { { 0, 0, -1, -1, 1, 1 }, { 0, 0, -1, -1, 1, 1 } };
+};